@@ -1,9 +1,19 @@
 //--- World in Motion ---\\
 
 #include "libraries/glew-2.1.0/include/GL/glew.h"
+#include "gl_dispatch.cpp"
+#include "profiler.cpp"
+#include "logger.cpp"
 #include "libraries/glfw-master/include/GLFW/glfw3.h"
 #include "libraries/glm-master/glm/glm.hpp"
 #include "libraries/glm-master/glm/ext.hpp"
+#include "primitives.h"
+#include "frame_scheduler.cpp"
+#include "frame_pacer.cpp"
+#include "render_backend.cpp"
+#include "frame_histogram.cpp"
+#include "input_log.cpp"
+#include "launch_options.cpp"
 #include <iostream>
 #include <vector>
 #include <random>
@@ -25,9 +35,14 @@ bool jKeyPressed = false;
 bool oKeyPressed = false;
 bool uKeyPressed = false;
 
-GLFWwindow* initializeGLFW() {
+// Decides when the render loop redraws
+FrameScheduler g_frameScheduler;
+
+GLFWwindow* initializeGLFW(const RenderBackend& backend) {
+    backend.SetInitHints();
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        LOG_ERROR("Failed to initialize GLFW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 
@@ -37,12 +52,16 @@ GLFWwindow* initializeGLFW() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
+    // Headless backends create an invisible window on GLFW's null platform
+    backend.SetWindowHints();
+
     // Create a windowed mode window and its OpenGL context
-    GLFWwindow* window = glfwCreateWindow(static_cast<int>(WINDOW_WIDTH), static_cast<int>(WINDOW_HEIGHT),
+    GLFWwindow* window = glfwCreateWindow(backend.GetWidth(WINDOW_WIDTH), backend.GetHeight(WINDOW_HEIGHT),
                                           "Getting the hang...", nullptr, nullptr);
 
     if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
+        Logger::Get().Flush();
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
@@ -61,8 +80,11 @@ GLFWwindow* initializeGLFW() {
 void initializeGLEW() {
     glewExperimental = GL_TRUE;
 
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW" << std::endl;
+    // A headless EGL context has no GLX display, but the GL functions are loaded regardless
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
+        LOG_ERROR("Failed to initialize GLEW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 };
@@ -129,9 +151,16 @@ public:
     GLuint unitPlaneVAO{}, unitCubeVAO{}, unitCylinderVAO1{}, unitCylinderVAO2{}, unitConeVAO{};
     GLuint unitPlaneEBO{}, unitCubeEBO{}, unitCylinderEBOTriFan1{}, unitCylinderEBOTriFan2{}, unitCylinderEBOTriStrip{},
     unitConeEBOTriFan1{}, unitConeEBOTriFan2{};
-    std::vector<GLuint> unitPlaneVertexIndicesTri, unitCubeVertexIndicesTri, unitCylinderVertexIndicesTriFan1,
-    unitCylinderVertexIndicesTriFan2, unitCylinderVertexIndicesTriStrip, unitConeVertexIndicesTriFan1,
-    unitConeVertexIndicesTriFan2;
+    std::vector<GLuint> unitPlaneVertexIndicesTri;
+
+    // Index tables are generated at compile time, see primitives.h.
+    static constexpr int g_iUnitPrimitiveSegments = 30;
+    static constexpr auto unitCubeVertexIndicesTri = primitives::UnitCubeIndices();
+    static constexpr auto unitCylinderVertexIndicesTriFan1 = primitives::UnitCylinderTriFan1<g_iUnitPrimitiveSegments>();
+    static constexpr auto unitCylinderVertexIndicesTriFan2 = primitives::UnitCylinderTriFan2<g_iUnitPrimitiveSegments>();
+    static constexpr auto unitCylinderVertexIndicesTriStrip = primitives::UnitCylinderTriStrip<g_iUnitPrimitiveSegments>();
+    static constexpr auto unitConeVertexIndicesTriFan1 = primitives::UnitConeTriFan1<g_iUnitPrimitiveSegments>();
+    static constexpr auto unitConeVertexIndicesTriFan2 = primitives::UnitConeTriFan2<g_iUnitPrimitiveSegments>();
     glm::mat4 modelMatrix{};
     GLint viewMatrixLocation{}, modelMatrixLocation{}, projectionMatrixLocation{};
     static bool g_boolDrawLookatPoint;
@@ -186,35 +215,8 @@ public:
     // Unit cube
     void createUnitCube() {
         // Vertex data for the unit cube
-        std::vector<GLfloat> unitCubeVertexData = {
-                // Face (front)
-                -0.5f, -0.5f, 0.5f, 0.9608f, 0.9569f, 0.9569f,   // Bottom-left
-                0.5f, -0.5f, 0.5f, 0.9608f, 0.9569f, 0.9569f,    // Bottom-right
-                0.5f, 0.5f, 0.5f, 0.7255f, 0.7059f, 0.6941f,    // Top-right
-                -0.5f, 0.5f, 0.5f, 0.7255f, 0.7059f, 0.6941f,   // Top-left
-
-                // Face (back)
-                -0.5f, -0.5f, -0.5f, 0.9608f, 0.9569f, 0.9569f, // Bottom-left
-                0.5f, -0.5f, -0.5f, 0.9608f, 0.9569f, 0.9569f,   // Bottom-right
-                0.5f, 0.5f, -0.5f, 0.7255f, 0.7059f, 0.6941f,   // Top-right
-                -0.5f, 0.5f, -0.5f, 0.7255f, 0.7059f, 0.6941f   // Top-left
-        };
-
-        unitCubeVertexIndicesTri = {
-                // prism1 indices
-                0, 1, 2, // front
-                2, 3, 0, // front
-                4, 5, 6, // back
-                6, 7, 4, // back
-                4, 0, 2, // left
-                2, 7, 4, // left
-                1, 5, 6, // right
-                6, 2, 1, // right
-                3, 2, 6, // top
-                6, 7, 3, // top
-                0, 1, 5, // bottom
-                5, 4, 0,  // bottom
-        };
+        static constexpr auto unitCubeVertexData = primitives::UnitCubeVertices<primitives::PositionColour>(
+                {0.9608f, 0.9569f, 0.9569f}, {0.7255f, 0.7059f, 0.6941f});
 
         glGenVertexArrays(1, &unitCubeVAO);
         glGenBuffers(1, &unitCubeVBO);
@@ -242,152 +244,14 @@ public:
 
     void createUnitCylinder() {
         // Brown cylinder
-        std::vector<GLfloat> unitCylinderVertexDataColour1{
-                0.0f, 0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.5f, 0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.5f, -0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.48907381875731f, 0.5f, 0.1039557588888f, 0.4f, 0.286f, 0.227f,
-                0.48907381875731f, -0.5f, 0.1039557588888f, 0.4f, 0.286f, 0.227f,
-                0.45677280077542f, 0.5f, 0.20336815992623f, 0.4f, 0.286f, 0.227f,
-                0.45677280077542f, -0.5f, 0.20336815992623f, 0.4f, 0.286f, 0.227f,
-                0.40450865316151f, 0.5f, 0.29389241146627f, 0.4f, 0.286f, 0.227f,
-                0.40450865316151f, -0.5f, 0.29389241146627f, 0.4f, 0.286f, 0.227f,
-                0.33456556611288f, 0.5f, 0.37157217599218f, 0.4f, 0.286f, 0.227f,
-                0.33456556611288f, -0.5f, 0.37157217599218f, 0.4f, 0.286f, 0.227f,
-                0.2500003830126f, 0.5f, 0.43301248075957f, 0.4f, 0.286f, 0.227f,
-                0.2500003830126f, -0.5f, 0.43301248075957f, 0.4f, 0.286f, 0.227f,
-                0.15450900193016f, 0.5f, 0.47552809414644f, 0.4f, 0.286f, 0.227f,
-                0.15450900193016f, -0.5f, 0.47552809414644f, 0.4f, 0.286f, 0.227f,
-                0.052264847412855f, 0.5f, 0.49726088296277f, 0.4f, 0.286f, 0.227f,
-                0.052264847412855f, -0.5f, 0.49726088296277f, 0.4f, 0.286f, 0.227f,
-                -0.052263527886268f, 0.5f, 0.49726102165048f, 0.4f, 0.286f, 0.227f,
-                -0.052263527886268f, -0.5f, 0.49726102165048f, 0.4f, 0.286f, 0.227f,
-                -0.15450774007312f, 0.5f, 0.47552850414828f, 0.4f, 0.286f, 0.227f,
-                -0.15450774007312f, -0.5f, 0.47552850414828f, 0.4f, 0.286f, 0.227f,
-                -0.24999923397422f, 0.5f, 0.43301314415651f, 0.4f, 0.286f, 0.227f,
-                -0.24999923397422f, -0.5f, 0.43301314415651f, 0.4f, 0.286f, 0.227f,
-                -0.33456458011157f, 0.5f, 0.37157306379065f, 0.4f, 0.286f, 0.227f,
-                -0.33456458011157f, -0.5f, 0.37157306379065f, 0.4f, 0.286f, 0.227f,
-                -0.40450787329018f, 0.5f, 0.29389348486527f, 0.4f, 0.286f, 0.227f,
-                -0.40450787329018f, -0.5f, 0.29389348486527f, 0.4f, 0.286f, 0.227f,
-                -0.45677226111814f, 0.5f, 0.20336937201315f, 0.4f, 0.286f, 0.227f,
-                -0.45677226111814f, -0.5f, 0.20336937201315f, 0.4f, 0.286f, 0.227f,
-                -0.48907354289964f, 0.5f, 0.10395705668972f, 0.4f, 0.286f, 0.227f,
-                -0.48907354289964f, -0.5f, 0.10395705668972f, 0.4f, 0.286f, 0.227f,
-                -0.49999999999824f, 0.5f, 1.3267948966764e-006f, 0.4f, 0.286f, 0.227f,
-                -0.49999999999824f, -0.5f, 1.3267948966764e-006f, 0.4f, 0.286f, 0.227f,
-                -0.48907409461153f, 0.5f, -0.10395446108714f, 0.4f, 0.286f, 0.227f,
-                -0.48907409461153f, -0.5f, -0.10395446108714f, 0.4f, 0.286f, 0.227f,
-                -0.45677334042948f, 0.5f, -0.20336694783787f, 0.4f, 0.286f, 0.227f,
-                -0.45677334042948f, -0.5f, -0.20336694783787f, 0.4f, 0.286f, 0.227f,
-                -0.40450943302999f, 0.5f, -0.2938913380652f, 0.4f, 0.286f, 0.227f,
-                -0.40450943302999f, -0.5f, -0.2938913380652f, 0.4f, 0.286f, 0.227f,
-                -0.33456655211184f, 0.5f, -0.3715712881911f, 0.4f, 0.286f, 0.227f,
-                -0.33456655211184f, -0.5f, -0.3715712881911f, 0.4f, 0.286f, 0.227f,
-                -0.25000153204922f, 0.5f, -0.43301181735958f, 0.4f, 0.286f, 0.227f,
-                -0.25000153204922f, -0.5f, -0.43301181735958f, 0.4f, 0.286f, 0.227f,
-                -0.15451026378611f, 0.5f, -0.47552768414126f, 0.4f, 0.286f, 0.227f,
-                -0.15451026378611f, -0.5f, -0.47552768414126f, 0.4f, 0.286f, 0.227f,
-                -0.052266166939075f, 0.5f, -0.49726074427155f, 0.4f, 0.286f, 0.227f,
-                -0.052266166939075f, -0.5f, -0.49726074427155f, 0.4f, 0.286f, 0.227f,
-                0.052262208359312f, 0.5f, -0.4972611603347f, 0.4f, 0.286f, 0.227f,
-                0.052262208359312f, -0.5f, -0.4972611603347f, 0.4f, 0.286f, 0.227f,
-                0.15450647821499f, 0.5f, -0.47552891414676f, 0.4f, 0.286f, 0.227f,
-                0.15450647821499f, -0.5f, -0.47552891414676f, 0.4f, 0.286f, 0.227f,
-                0.24999808493408f, 0.5f, -0.4330138075504f, 0.4f, 0.286f, 0.227f,
-                0.24999808493408f, -0.5f, -0.4330138075504f, 0.4f, 0.286f, 0.227f,
-                0.3345635941079f, 0.5f, -0.37157395158649f, 0.4f, 0.286f, 0.227f,
-                0.3345635941079f, -0.5f, -0.37157395158649f, 0.4f, 0.286f, 0.227f,
-                0.40450709341601f, 0.5f, -0.2938945582622f, 0.4f, 0.286f, 0.227f,
-                0.40450709341601f, -0.5f, -0.2938945582622f, 0.4f, 0.286f, 0.227f,
-                0.45677172145764f, 0.5f, -0.20337058409865f, 0.4f, 0.286f, 0.227f,
-                0.45677172145764f, -0.5f, -0.20337058409865f, 0.4f, 0.286f, 0.227f,
-                0.48907326703854f, 0.5f, -0.10395835448992f, 0.4f, 0.286f, 0.227f,
-                0.48907326703854f, -0.5f, -0.10395835448992f, 0.4f, 0.286f, 0.227f,
-                0.0f, -0.5f, 0.0f, 0.4f, 0.286f, 0.227f
-        };
+        static constexpr auto unitCylinderVertexDataColour1 =
+                primitives::UnitCylinderVertices<primitives::PositionColour, g_iUnitPrimitiveSegments>(
+                        {0.4f, 0.286f, 0.227f});
 
         // Marble cylinder
-        std::vector<GLfloat> unitCylinderVertexDataColour2{
-                0.0f, 0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.5f, 0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.5f, -0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907381875731f, 0.5f, 0.1039557588888f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907381875731f, -0.5f, 0.1039557588888f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677280077542f, 0.5f, 0.20336815992623f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677280077542f, -0.5f, 0.20336815992623f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450865316151f, 0.5f, 0.29389241146627f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450865316151f, -0.5f, 0.29389241146627f, 0.9608f, 0.9569f, 0.9569f,
-                0.33456556611288f, 0.5f, 0.37157217599218f, 0.9608f, 0.9569f, 0.9569f,
-                0.33456556611288f, -0.5f, 0.37157217599218f, 0.9608f, 0.9569f, 0.9569f,
-                0.2500003830126f, 0.5f, 0.43301248075957f, 0.9608f, 0.9569f, 0.9569f,
-                0.2500003830126f, -0.5f, 0.43301248075957f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450900193016f, 0.5f, 0.47552809414644f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450900193016f, -0.5f, 0.47552809414644f, 0.9608f, 0.9569f, 0.9569f,
-                0.052264847412855f, 0.5f, 0.49726088296277f, 0.9608f, 0.9569f, 0.9569f,
-                0.052264847412855f, -0.5f, 0.49726088296277f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052263527886268f, 0.5f, 0.49726102165048f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052263527886268f, -0.5f, 0.49726102165048f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15450774007312f, 0.5f, 0.47552850414828f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15450774007312f, -0.5f, 0.47552850414828f, 0.9608f, 0.9569f, 0.9569f,
-                -0.24999923397422f, 0.5f, 0.43301314415651f, 0.9608f, 0.9569f, 0.9569f,
-                -0.24999923397422f, -0.5f, 0.43301314415651f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456458011157f, 0.5f, 0.37157306379065f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456458011157f, -0.5f, 0.37157306379065f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450787329018f, 0.5f, 0.29389348486527f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450787329018f, -0.5f, 0.29389348486527f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677226111814f, 0.5f, 0.20336937201315f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677226111814f, -0.5f, 0.20336937201315f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907354289964f, 0.5f, 0.10395705668972f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907354289964f, -0.5f, 0.10395705668972f, 0.9608f, 0.9569f, 0.9569f,
-                -0.49999999999824f, 0.5f, 1.3267948966764e-006f, 0.9608f, 0.9569f, 0.9569f,
-                -0.49999999999824f, -0.5f, 1.3267948966764e-006f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907409461153f, 0.5f, -0.10395446108714f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907409461153f, -0.5f, -0.10395446108714f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677334042948f, 0.5f, -0.20336694783787f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677334042948f, -0.5f, -0.20336694783787f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450943302999f, 0.5f, -0.2938913380652f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450943302999f, -0.5f, -0.2938913380652f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456655211184f, 0.5f, -0.3715712881911f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456655211184f, -0.5f, -0.3715712881911f, 0.9608f, 0.9569f, 0.9569f,
-                -0.25000153204922f, 0.5f, -0.43301181735958f, 0.9608f, 0.9569f, 0.9569f,
-                -0.25000153204922f, -0.5f, -0.43301181735958f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15451026378611f, 0.5f, -0.47552768414126f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15451026378611f, -0.5f, -0.47552768414126f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052266166939075f, 0.5f, -0.49726074427155f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052266166939075f, -0.5f, -0.49726074427155f, 0.9608f, 0.9569f, 0.9569f,
-                0.052262208359312f, 0.5f, -0.4972611603347f, 0.9608f, 0.9569f, 0.9569f,
-                0.052262208359312f, -0.5f, -0.4972611603347f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450647821499f, 0.5f, -0.47552891414676f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450647821499f, -0.5f, -0.47552891414676f, 0.9608f, 0.9569f, 0.9569f,
-                0.24999808493408f, 0.5f, -0.4330138075504f, 0.9608f, 0.9569f, 0.9569f,
-                0.24999808493408f, -0.5f, -0.4330138075504f, 0.9608f, 0.9569f, 0.9569f,
-                0.3345635941079f, 0.5f, -0.37157395158649f, 0.9608f, 0.9569f, 0.9569f,
-                0.3345635941079f, -0.5f, -0.37157395158649f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450709341601f, 0.5f, -0.2938945582622f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450709341601f, -0.5f, -0.2938945582622f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677172145764f, 0.5f, -0.20337058409865f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677172145764f, -0.5f, -0.20337058409865f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907326703854f, 0.5f, -0.10395835448992f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907326703854f, -0.5f, -0.10395835448992f, 0.9608f, 0.9569f, 0.9569f,
-                0.0f, -0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f
-        };
-
-        unitCylinderVertexIndicesTriFan1 = {
-                0, 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51,
-                53, 55, 57, 59, 1
-        };
-
-        unitCylinderVertexIndicesTriFan2 = {
-                61, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22, 20, 18, 16, 14, 12,
-                10, 8, 6, 4, 2, 60
-        };
-
-        unitCylinderVertexIndicesTriStrip = {
-                1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28,
-                29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54,
-                55, 56, 57, 58, 59, 60, 1, 2
-        };
+        static constexpr auto unitCylinderVertexDataColour2 =
+                primitives::UnitCylinderVertices<primitives::PositionColour, g_iUnitPrimitiveSegments>(
+                        {0.9608f, 0.9569f, 0.9569f});
 
         glGenVertexArrays(1, &unitCylinderVAO1);
         glGenVertexArrays(1, &unitCylinderVAO2);
@@ -436,50 +300,9 @@ public:
     }
 
     void createUnitCone() {
-        std::vector<GLfloat> unitConeVertexData {
-                0.0f, 0.866f, 0.0f, 0.094f, 0.369f, 0.247f,
-                0.5f, 0.0f, 0.0f, 0.094f, 0.369f, 0.247f,
-                0.48907381875731f, 0.0f, 0.1039557588888f, 0.094f, 0.369f, 0.247f,
-                0.45677280077542f, 0.0f, 0.20336815992623f, 0.094f, 0.369f, 0.247f,
-                0.40450865316151f, 0.0f, 0.29389241146627f, 0.094f, 0.369f, 0.247f,
-                0.33456556611288f, 0.0f, 0.37157217599218f, 0.094f, 0.369f, 0.247f,
-                0.2500003830126f, 0.0f, 0.43301248075957f, 0.094f, 0.369f, 0.247f,
-                0.15450900193016f, 0.0f, 0.47552809414644f, 0.094f, 0.369f, 0.247f,
-                0.052264847412855f, 0.0f, 0.49726088296277f, 0.094f, 0.369f, 0.247f,
-                -0.052263527886268f, 0.0f, 0.49726102165048f, 0.094f, 0.369f, 0.247f,
-                -0.15450774007312f, 0.0f, 0.47552850414828f, 0.094f, 0.369f, 0.247f,
-                -0.24999923397422f, 0.0f, 0.43301314415651f, 0.094f, 0.369f, 0.247f,
-                -0.33456458011157f, 0.0f, 0.37157306379065f, 0.094f, 0.369f, 0.247f,
-                -0.40450787329018f, 0.0f, 0.29389348486527f, 0.094f, 0.369f, 0.247f,
-                -0.45677226111814f, 0.0f, 0.20336937201315f, 0.094f, 0.369f, 0.247f,
-                -0.48907354289964f, 0.0f, 0.10395705668972f, 0.094f, 0.369f, 0.247f,
-                -0.49999999999824f, 0.0f, 1.3267948966764e-006f, 0.094f, 0.369f, 0.247f,
-                -0.48907409461153f, 0.0f, -0.10395446108714f, 0.094f, 0.369f, 0.247f,
-                -0.45677334042948f, 0.0f, -0.20336694783787f, 0.094f, 0.369f, 0.247f,
-                -0.40450943302999f, 0.0f, -0.2938913380652f, 0.094f, 0.369f, 0.247f,
-                -0.33456655211184f, 0.0f, -0.3715712881911f, 0.094f, 0.369f, 0.247f,
-                -0.25000153204922f, 0.0f, -0.43301181735958f, 0.094f, 0.369f, 0.247f,
-                -0.15451026378611f, 0.0f, -0.47552768414126f, 0.094f, 0.369f, 0.247f,
-                -0.052266166939075f, 0.0f, -0.49726074427155f, 0.094f, 0.369f, 0.247f,
-                0.052262208359312f, 0.0f, -0.4972611603347f, 0.094f, 0.369f, 0.247f,
-                0.15450647821499f, 0.0f, -0.47552891414676f, 0.094f, 0.369f, 0.247f,
-                0.24999808493408f, 0.0f, -0.4330138075504f, 0.094f, 0.369f, 0.247f,
-                0.3345635941079f, 0.0f, -0.37157395158649f, 0.094f, 0.369f, 0.247f,
-                0.40450709341601f, 0.0f, -0.2938945582622f, 0.094f, 0.369f, 0.247f,
-                0.45677172145764f, 0.0f, -0.20337058409865f, 0.094f, 0.369f, 0.247f,
-                0.48907326703854f, 0.0f, -0.10395835448992f, 0.094f, 0.369f, 0.247f,
-                0.0f, 0.0f, 0.0f, 0.094f, 0.369f, 0.247f,
-        };
-
-        unitConeVertexIndicesTriFan1 = {
-                0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
-                28, 29, 30, 1
-        };
-
-        unitConeVertexIndicesTriFan2 = {
-                31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10,
-                9, 8, 7, 6, 5, 4, 3, 2, 1, 30
-        };
+        static constexpr auto unitConeVertexData =
+                primitives::UnitConeVertices<primitives::PositionColour, g_iUnitPrimitiveSegments>(
+                        {0.094f, 0.369f, 0.247f});
 
         glGenVertexArrays(1, &unitConeVAO);
         glGenBuffers(1, &unitConeVBO);
@@ -510,7 +333,6 @@ public:
         glBindVertexArray(0);
     }
 
-    bool resizeFlag = false;
     void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
         // Update viewport dimensions on window resize
         glUseProgram(shaderProgram);
@@ -519,7 +341,6 @@ public:
         glViewport(0, 0, width, height);
         glUniform1i(windowWidthLocation, width);
         glUniform1i(windowHeightLocation, height);
-        resizeFlag = true;
     }
 
     void set_shader_sources() {
@@ -586,7 +407,7 @@ public:
 
             // Output or log the error information
             std::string shader_name = get_shader_label(shader);
-            std::cerr << shader_name << " compilation error; deleting shader...:\n" << infoLog << std::endl;
+            LOG_ERROR("{} compilation error; deleting shader...:\n{}", shader_name, infoLog);
 
             delete[] infoLog;
 
@@ -600,6 +421,7 @@ public:
     }
 
     void compile_and_link_shaders() {
+        PROFILE_FUNCTION();
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glObjectLabel(GL_SHADER, vertexShader, -1, "Vertex Shader");
         glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
@@ -624,12 +446,13 @@ public:
 
             auto* strInfoLog = new GLchar[infoLogLength + 1];
             glGetProgramInfoLog(shaderProgram, infoLogLength, nullptr, strInfoLog);
-            std::cerr << "Linker failure: \n" << strInfoLog;
+            LOG_ERROR("Linker failure: \n{}", strInfoLog);
             delete[] strInfoLog;
         }
     }
 
     void create_and_link_program() {
+        PROFILE_FUNCTION();
         shaderProgram = glCreateProgram();
 
         for (GLuint shader : shaders) {
@@ -681,6 +504,7 @@ public:
     }
 
     void perform_render_sequence(GLFWwindow* window) {
+        PROFILE_FUNCTION();
         // Clear the color and depth buffers
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -1086,6 +910,12 @@ public:
 
     // GLFW key callback function
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        g_frameScheduler.MarkDirty();
+
+        // Dump the profiler trace
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+            Profiler::Get().WriteChromeTrace();
+
         if (action == GLFW_PRESS) {
             // Check if the Shift key is pressed
             bool shift_pressed = (mods & GLFW_MOD_SHIFT) != 0;
@@ -1165,9 +995,9 @@ public:
                 }
                 case GLFW_KEY_SPACE: {
                     g_boolDrawLookatPoint = !g_boolDrawLookatPoint;
-                    printf("Target: %f, %f, %f\n", g_cameraTarget.x, g_cameraTarget.y, g_cameraTarget.z);
-                    printf("Position: %f, %f, %f\n", g_sphereCameraRelativePosition.x,
-                           g_sphereCameraRelativePosition.y, g_sphereCameraRelativePosition.z);
+                    LOG_INFO("Target: {:f}, {:f}, {:f}", g_cameraTarget.x, g_cameraTarget.y, g_cameraTarget.z);
+                    LOG_INFO("Position: {:f}, {:f}, {:f}", g_sphereCameraRelativePosition.x,
+                             g_sphereCameraRelativePosition.y, g_sphereCameraRelativePosition.z);
                     break;
                 }
                 default:
@@ -1204,6 +1034,8 @@ glm::vec3 Renderer::g_sphereCameraRelativePosition{67.5f, -46.0f, 150.0f};
 
 // GLFW requires a static or non-member function for the framebuffer size callback
 void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    g_frameScheduler.MarkDirty();
+
     // Retrieve the Renderer instance associated with the window
     auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
 
@@ -1214,9 +1046,26 @@ void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 }
 
 
-int main() {
-    GLFWwindow* window = initializeGLFW();
+int main(int argc, char* argv[]) {
+    LaunchOptions options = parseLaunchOptions(argc, argv);
+    Profiler::Get().SetThreadName("Main");
+    if (!options.tracePath.empty())
+        Profiler::Get().SetTracePath(options.tracePath);
+
+    // Record this session's input, or replay a recorded one
+    if (!options.recordInputPath.empty() && !g_inputLog.StartRecording(options.recordInputPath))
+        return 1;
+    if (!options.replayInputPath.empty()) {
+        if (!g_inputLog.StartReplay(options.replayInputPath))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = g_inputLog.GetReplayFrameCount();
+    }
+
+    RenderBackend backend(options);
+    GLFWwindow* window = initializeGLFW(backend);
     initializeGLEW();
+    backend.Create(window);
 
     Renderer renderer = Renderer();
     renderer.set_shader_sources();
@@ -1248,30 +1097,61 @@ int main() {
     // Set the resize callback
     glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
+    // Log or replay input through the callbacks just set
+    g_inputLog.Attach(window);
+
+    // Start from the framebuffer actually created, which need not be the default window size
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glfw_framebuffer_size_callback(window, framebufferWidth, framebufferHeight);
+
+    // Only redraw when something changed, unless asked to render continuously
+    g_frameScheduler.SetMode(options.bContinuousRendering ? FrameScheduler::Mode::CONTINUOUS
+                                                          : FrameScheduler::Mode::ON_DEMAND);
+    g_frameScheduler.Attach(window);
+
+    // Pace presentation with vsync, a frame-rate cap, or not at all
+    FramePacer framePacer(options.framePacing, options.fTargetFps);
+    framePacer.Apply();
+
+    // Every frame time of a continuous run, for the percentile report and the baseline gate
+    FrameTimeHistogram frameTimes;
+
     // Render loop
     while (!glfwWindowShouldClose(window)) {
+        // Process events, sleeping until a frame is needed
+        if (!g_frameScheduler.WaitForFrame())
+            continue;
+        PROFILE_SCOPE("Frame");
+
+        // Feed back recorded input and step the session clock
+        g_inputLog.BeginFrame(window);
+
         // Process input
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
 
-        // Check if re-render is needed
-        if (renderer.resizeFlag) {
-            renderer.perform_render_sequence(window);
-            renderer.resizeFlag = false; // Reset the flag
-        }
-
+        backend.BeginFrame();
         renderer.perform_render_sequence(window);
 
-        // Swap front and back buffers
-        glfwSwapBuffers(window);
+        // Swap front and back buffers (or finish the offscreen frame)
+        framePacer.WaitForNextFrame();
+        backend.PresentFrame(window);
 
-        // Poll for and process events
-        glfwPollEvents();
+        // On-demand frames are spaced by input rather than by rendering, so only time continuous runs
+        if (g_frameScheduler.GetMode() == FrameScheduler::Mode::CONTINUOUS)
+            frameTimes.RecordFrame();
     }
 
+    g_inputLog.Finish();
+    int exitCode = finishFrameTimeReport(frameTimes, options);
+
+    if (!options.tracePath.empty())
+        Profiler::Get().WriteChromeTrace();
+
     // Terminate GLFW
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
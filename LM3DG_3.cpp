@@ -1,12 +1,30 @@
 //--- World in Motion: Shared Uniforms ---\\
 
 #include "libraries/glew-2.1.0/include/GL/glew.h"
+#include "gl_dispatch.cpp"
+#include "profiler.cpp"
+#include "logger.cpp"
+#include "gpu_timer.cpp"
+#include "render_stats.cpp"
 #include "libraries/glfw-master/include/GLFW/glfw3.h"
 #include "libraries/glm-master/glm/glm.hpp"
 #include "libraries/glm-master/glm/ext.hpp"
+#include "primitives.h"
+#include "occlusion.cpp"
+#include "lod.cpp"
+#include "impostor.cpp"
+#include "frame_scheduler.cpp"
+#include "frame_pacer.cpp"
+#include "render_backend.cpp"
+#include "frame_histogram.cpp"
+#include "input_log.cpp"
+#include "camera_path.cpp"
+#include "scene_generator.cpp"
+#include "launch_options.cpp"
 #include <iostream>
 #include <vector>
 #include <random>
+#include <algorithm>
 
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 600;
@@ -16,6 +34,7 @@ struct ProgramData
     GLuint shaderProgram;
     GLint globalUniformBlockIndex;
     GLint modelMatrixLocation;
+    GLint impostorFadeLocation;
     // GLuint baseColorUnif;
     // GLuint thing;
 };
@@ -37,9 +56,14 @@ bool uKeyPressed = false;
 GLuint g_GlobalMatricesUBO;
 static const int g_iGlobalMatricesBindingIndex = 0;
 
-GLFWwindow* initializeGLFW() {
+// Decides when the render loop redraws
+FrameScheduler g_frameScheduler;
+
+GLFWwindow* initializeGLFW(const RenderBackend& backend) {
+    backend.SetInitHints();
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        LOG_ERROR("Failed to initialize GLFW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 
@@ -49,12 +73,16 @@ GLFWwindow* initializeGLFW() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
+    // Headless backends create an invisible window on GLFW's null platform
+    backend.SetWindowHints();
+
     // Create a windowed mode window and its OpenGL context
-    GLFWwindow* window = glfwCreateWindow(static_cast<int>(WINDOW_WIDTH), static_cast<int>(WINDOW_HEIGHT),
+    GLFWwindow* window = glfwCreateWindow(backend.GetWidth(WINDOW_WIDTH), backend.GetHeight(WINDOW_HEIGHT),
                                           "Getting the hang...", nullptr, nullptr);
 
     if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
+        Logger::Get().Flush();
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
@@ -73,8 +101,11 @@ GLFWwindow* initializeGLFW() {
 void initializeGLEW() {
     glewExperimental = GL_TRUE;
 
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW" << std::endl;
+    // A headless EGL context has no GLX display, but the GL functions are loaded regardless
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
+        LOG_ERROR("Failed to initialize GLEW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 }
@@ -137,32 +168,141 @@ private:
 class Renderer {
 public:
     ProgramData data{};
-    GLuint unitPlaneVBO{}, unitCubeVBO{}, unitCylinderVBO1{}, unitCylinderVBO2{}, unitConeVBO{};
-    GLuint unitPlaneVAO{}, unitCubeVAO{}, unitCylinderVAO1{}, unitCylinderVAO2{}, unitConeVAO{};
-    GLuint unitPlaneEBO{}, unitCubeEBO{}, unitCylinderEBOTriFan1{}, unitCylinderEBOTriFan2{}, unitCylinderEBOTriStrip{},
-    unitConeEBOTriFan1{}, unitConeEBOTriFan2{};
-    std::vector<GLuint> unitPlaneVertexIndicesTri, unitCubeVertexIndicesTri, unitCylinderVertexIndicesTriFan1,
-    unitCylinderVertexIndicesTriFan2, unitCylinderVertexIndicesTriStrip, unitConeVertexIndicesTriFan1,
-    unitConeVertexIndicesTriFan2;
+    // Depth-only program for the optional pre-pass. It reads the position stream only.
+    ProgramData depthData{};
+    // Meshes keep positions and colours in separate buffers: each main VAO reads both streams,
+    // each depth VAO only the positions, so the depth pre-pass never fetches colour.
+    GLuint unitPlaneVBO{}, unitCubeVBO{};
+    GLuint unitPlaneColourVBO{}, unitCubeColourVBO{};
+    GLuint unitPlaneVAO{}, unitCubeVAO{};
+    GLuint unitPlaneDepthVAO{}, unitCubeDepthVAO{};
+    GLuint unitPlaneEBO{}, unitCubeEBO{};
+    std::vector<GLuint> unitPlaneVertexIndicesTri;
+
+    // Index tables are generated at compile time, see primitives.h.
+    static constexpr int g_iUnitPrimitiveSegments = 30;
+    static constexpr auto unitCubeVertexIndicesTri = primitives::UnitCubeIndices();
     glm::mat4 modelMatrix{};
     GLint viewMatrixLocation{}, projectionMatrixLocation{};
 
     static bool g_boolDrawLookatPoint;
+    static bool g_bOcclusionCulling;
+    static bool g_bDepthPrePass;
     static glm::vec3 g_cameraTarget;
     static glm::vec3 g_sphereCameraRelativePosition;
 
+    // True while the scene is drawn into the depth buffer only.
+    bool bDepthPass = false;
+
+    // Parthenon dimensions, shared by drawParthenon and the occluder proxies.
+    static constexpr float g_fParthenonWidth = 14.0f;
+    static constexpr float g_fParthenonLength = 20.0f;
+    static constexpr float g_fParthenonColumnHeight = 5.0f;
+    static constexpr float g_fParthenonBaseHeight = 1.0f;
+    static constexpr float g_fParthenonTopHeight = 2.0f;
+
+    // Where the Parthenons stand, and the side of the square terrain; replaced by a generated
+    // stress scene when one is asked for.
+    std::vector<glm::vec3> parthenonPositions{{20.0f, 0.0f, -10.0f}};
+    float fTerrainSize = 100.0f;
+
+    // Low resolution CPU depth buffer used to skip trees and columns hidden behind the Parthenon.
+    OcclusionCuller occlusionCuller;
+
+    // One tessellation level of a unit primitive. Cylinders are drawn as two fans and a strip,
+    // cones as two fans (triStripCount stays 0).
+    struct PrimitiveLod {
+        GLuint VAO{}, depthVAO{};
+        GLuint positionVBO{};
+        GLuint EBOTriFan1{}, EBOTriFan2{}, EBOTriStrip{};
+        GLsizei triFan1Count{}, triFan2Count{}, triStripCount{};
+    };
+
+    // Segment counts of the coarser levels; level 0 uses g_iUnitPrimitiveSegments.
+    static constexpr int g_iLodSegments1 = 12;
+    static constexpr int g_iLodSegments2 = 6;
+    static constexpr float g_fFovYDegrees = 45.0f;
+
+    std::vector<PrimitiveLod> unitCylinderLods1, unitCylinderLods2, unitConeLods;
+    std::vector<int> forestLods;
+    // One list of column levels per Parthenon.
+    std::vector<std::vector<int>> parthenonColumnLods;
+    LodSelector primitiveLodSelector{{60.0f, 15.0f}};
+    glm::vec3 lodCameraPosition{};
+    int viewportHeight = WINDOW_HEIGHT;
+    static bool g_bPrimitiveLod;
+
+    // Trees beyond fImpostorDistance are drawn as billboards from a sprite atlas. Over the last
+    // g_fImpostorFadeWidth units before it, geometry and billboard are dithered into each other.
+    ImpostorAtlas treeImpostors;
+    std::vector<int> forestImpostorVariants;
+    float fImpostorDistance = 90.0f;
+    static constexpr float g_fImpostorFadeWidth = 10.0f;
+    static bool g_bTreeImpostors;
+
+    // Per pass GPU timings, when enabled with --gpu-timers
+    GpuTimer gpuTimer;
+
     Renderer() {
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
     }
 
+    // Uniform locations of the program bound for the current pass.
+    [[nodiscard]] const ProgramData& activeProgram() const {
+        return bDepthPass ? depthData : data;
+    }
+
+    [[nodiscard]] GLuint selectVAO(GLuint VAO, GLuint depthVAO) const {
+        return bDepthPass ? depthVAO : VAO;
+    }
+
+    static GLuint createArrayBuffer(const GLfloat* vertexData, size_t floatCount) {
+        GLuint VBO;
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(floatCount * sizeof(GLfloat)), vertexData,
+                     GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return VBO;
+    }
+
+    // Attribute 0 reads 3 floats per vertex from positionVBO, attribute 1 (when colourVBO isn't 0)
+    // 3 floats per vertex from colourVBO.
+    static GLuint createVertexArray(GLuint positionVBO, GLuint colourVBO) {
+        GLuint VAO;
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)nullptr);
+        glEnableVertexAttribArray(0);
+
+        if (colourVBO != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, colourVBO);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)nullptr);
+            glEnableVertexAttribArray(1);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        return VAO;
+    }
+
     void createUnitPlane() {
         // Vertex data for the plan
-        std::vector<GLfloat> unitPlaneVertexData = {
-                0.5f, 0.0f, -0.5f, 0.0f, 0.65098f, 0.09804f,
-                0.5f, 0.0f, 0.5f, 0.0f, 0.65098f, 0.09804f,
-                -0.5f, 0.0f, 0.5f, 0.0f, 0.65098f, 0.09804f,
-                -0.5f, 0.0f, -0.5f, 0.0f, 0.65098f, 0.09804f
+        std::vector<GLfloat> unitPlaneVertexPositions = {
+                0.5f, 0.0f, -0.5f,
+                0.5f, 0.0f, 0.5f,
+                -0.5f, 0.0f, 0.5f,
+                -0.5f, 0.0f, -0.5f
+        };
+
+        std::vector<GLfloat> unitPlaneVertexColours = {
+                0.0f, 0.65098f, 0.09804f,
+                0.0f, 0.65098f, 0.09804f,
+                0.0f, 0.65098f, 0.09804f,
+                0.0f, 0.65098f, 0.09804f
         };
 
         unitPlaneVertexIndicesTri = {
@@ -172,358 +312,154 @@ public:
                 2, 0, 3
         };
 
-        glGenVertexArrays(1, &unitPlaneVAO);
-        glGenBuffers(1, &unitPlaneVBO);
-        glGenBuffers(1, &unitPlaneEBO);
+        unitPlaneVBO = createArrayBuffer(unitPlaneVertexPositions.data(), unitPlaneVertexPositions.size());
+        unitPlaneColourVBO = createArrayBuffer(unitPlaneVertexColours.data(), unitPlaneVertexColours.size());
+        unitPlaneVAO = createVertexArray(unitPlaneVBO, unitPlaneColourVBO);
+        unitPlaneDepthVAO = createVertexArray(unitPlaneVBO, 0);
 
-        glBindVertexArray(unitPlaneVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, unitPlaneVBO);
+        // Add data to EBO
+        glGenBuffers(1, &unitPlaneEBO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitPlaneEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-
-        // Add data to VBO and EBO
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitPlaneVertexData.size() * sizeof(GLfloat)),
-        unitPlaneVertexData.data(), GL_STATIC_DRAW);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitPlaneVertexIndicesTri.size() * sizeof(GLint)),
         unitPlaneVertexIndicesTri.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
     };
 
     // Unit cube
     void createUnitCube() {
         // Vertex data for the unit cube
-        std::vector<GLfloat> unitCubeVertexData = {
-                // Face (front)
-                -0.5f, -0.5f, 0.5f, 0.9608f, 0.9569f, 0.9569f,   // Bottom-left
-                0.5f, -0.5f, 0.5f, 0.9608f, 0.9569f, 0.9569f,    // Bottom-right
-                0.5f, 0.5f, 0.5f, 0.7255f, 0.7059f, 0.6941f,    // Top-right
-                -0.5f, 0.5f, 0.5f, 0.7255f, 0.7059f, 0.6941f,   // Top-left
-
-                // Face (back)
-                -0.5f, -0.5f, -0.5f, 0.9608f, 0.9569f, 0.9569f, // Bottom-left
-                0.5f, -0.5f, -0.5f, 0.9608f, 0.9569f, 0.9569f,   // Bottom-right
-                0.5f, 0.5f, -0.5f, 0.7255f, 0.7059f, 0.6941f,   // Top-right
-                -0.5f, 0.5f, -0.5f, 0.7255f, 0.7059f, 0.6941f   // Top-left
-        };
+        static constexpr auto unitCubeVertexPositions = primitives::UnitCubeVertices<primitives::PositionOnly>({}, {});
+        static constexpr auto unitCubeVertexColours = primitives::UnitCubeVertices<primitives::ColourOnly>(
+                {0.9608f, 0.9569f, 0.9569f}, {0.7255f, 0.7059f, 0.6941f});
 
-        unitCubeVertexIndicesTri = {
-                // prism1 indices
-                0, 1, 2, // front
-                2, 3, 0, // front
-                4, 5, 6, // back
-                6, 7, 4, // back
-                4, 0, 2, // left
-                2, 7, 4, // left
-                1, 5, 6, // right
-                6, 2, 1, // right
-                3, 2, 6, // top
-                6, 7, 3, // top
-                0, 1, 5, // bottom
-                5, 4, 0,  // bottom
-        };
+        unitCubeVBO = createArrayBuffer(unitCubeVertexPositions.data(), unitCubeVertexPositions.size());
+        unitCubeColourVBO = createArrayBuffer(unitCubeVertexColours.data(), unitCubeVertexColours.size());
+        unitCubeVAO = createVertexArray(unitCubeVBO, unitCubeColourVBO);
+        unitCubeDepthVAO = createVertexArray(unitCubeVBO, 0);
 
-        glGenVertexArrays(1, &unitCubeVAO);
-        glGenBuffers(1, &unitCubeVBO);
+        // Add data to EBO
         glGenBuffers(1, &unitCubeEBO);
-
-        glBindVertexArray(unitCubeVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, unitCubeVBO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-
-        // Add data to VBO and EBO
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCubeVertexData.size() * sizeof(GLfloat)),
-                     unitCubeVertexData.data(), GL_STATIC_DRAW);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCubeVertexIndicesTri.size() * sizeof(GLint)),
                      unitCubeVertexIndicesTri.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
     }
 
+    // Brown (trunk) and marble (column) cylinders, one entry per level of detail.
     void createUnitCylinder() {
-        // Brown cylinder
-        std::vector<GLfloat> unitCylinderVertexDataColour1{
-                0.0f, 0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.5f, 0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.5f, -0.5f, 0.0f, 0.4f, 0.286f, 0.227f,
-                0.48907381875731f, 0.5f, 0.1039557588888f, 0.4f, 0.286f, 0.227f,
-                0.48907381875731f, -0.5f, 0.1039557588888f, 0.4f, 0.286f, 0.227f,
-                0.45677280077542f, 0.5f, 0.20336815992623f, 0.4f, 0.286f, 0.227f,
-                0.45677280077542f, -0.5f, 0.20336815992623f, 0.4f, 0.286f, 0.227f,
-                0.40450865316151f, 0.5f, 0.29389241146627f, 0.4f, 0.286f, 0.227f,
-                0.40450865316151f, -0.5f, 0.29389241146627f, 0.4f, 0.286f, 0.227f,
-                0.33456556611288f, 0.5f, 0.37157217599218f, 0.4f, 0.286f, 0.227f,
-                0.33456556611288f, -0.5f, 0.37157217599218f, 0.4f, 0.286f, 0.227f,
-                0.2500003830126f, 0.5f, 0.43301248075957f, 0.4f, 0.286f, 0.227f,
-                0.2500003830126f, -0.5f, 0.43301248075957f, 0.4f, 0.286f, 0.227f,
-                0.15450900193016f, 0.5f, 0.47552809414644f, 0.4f, 0.286f, 0.227f,
-                0.15450900193016f, -0.5f, 0.47552809414644f, 0.4f, 0.286f, 0.227f,
-                0.052264847412855f, 0.5f, 0.49726088296277f, 0.4f, 0.286f, 0.227f,
-                0.052264847412855f, -0.5f, 0.49726088296277f, 0.4f, 0.286f, 0.227f,
-                -0.052263527886268f, 0.5f, 0.49726102165048f, 0.4f, 0.286f, 0.227f,
-                -0.052263527886268f, -0.5f, 0.49726102165048f, 0.4f, 0.286f, 0.227f,
-                -0.15450774007312f, 0.5f, 0.47552850414828f, 0.4f, 0.286f, 0.227f,
-                -0.15450774007312f, -0.5f, 0.47552850414828f, 0.4f, 0.286f, 0.227f,
-                -0.24999923397422f, 0.5f, 0.43301314415651f, 0.4f, 0.286f, 0.227f,
-                -0.24999923397422f, -0.5f, 0.43301314415651f, 0.4f, 0.286f, 0.227f,
-                -0.33456458011157f, 0.5f, 0.37157306379065f, 0.4f, 0.286f, 0.227f,
-                -0.33456458011157f, -0.5f, 0.37157306379065f, 0.4f, 0.286f, 0.227f,
-                -0.40450787329018f, 0.5f, 0.29389348486527f, 0.4f, 0.286f, 0.227f,
-                -0.40450787329018f, -0.5f, 0.29389348486527f, 0.4f, 0.286f, 0.227f,
-                -0.45677226111814f, 0.5f, 0.20336937201315f, 0.4f, 0.286f, 0.227f,
-                -0.45677226111814f, -0.5f, 0.20336937201315f, 0.4f, 0.286f, 0.227f,
-                -0.48907354289964f, 0.5f, 0.10395705668972f, 0.4f, 0.286f, 0.227f,
-                -0.48907354289964f, -0.5f, 0.10395705668972f, 0.4f, 0.286f, 0.227f,
-                -0.49999999999824f, 0.5f, 1.3267948966764e-006f, 0.4f, 0.286f, 0.227f,
-                -0.49999999999824f, -0.5f, 1.3267948966764e-006f, 0.4f, 0.286f, 0.227f,
-                -0.48907409461153f, 0.5f, -0.10395446108714f, 0.4f, 0.286f, 0.227f,
-                -0.48907409461153f, -0.5f, -0.10395446108714f, 0.4f, 0.286f, 0.227f,
-                -0.45677334042948f, 0.5f, -0.20336694783787f, 0.4f, 0.286f, 0.227f,
-                -0.45677334042948f, -0.5f, -0.20336694783787f, 0.4f, 0.286f, 0.227f,
-                -0.40450943302999f, 0.5f, -0.2938913380652f, 0.4f, 0.286f, 0.227f,
-                -0.40450943302999f, -0.5f, -0.2938913380652f, 0.4f, 0.286f, 0.227f,
-                -0.33456655211184f, 0.5f, -0.3715712881911f, 0.4f, 0.286f, 0.227f,
-                -0.33456655211184f, -0.5f, -0.3715712881911f, 0.4f, 0.286f, 0.227f,
-                -0.25000153204922f, 0.5f, -0.43301181735958f, 0.4f, 0.286f, 0.227f,
-                -0.25000153204922f, -0.5f, -0.43301181735958f, 0.4f, 0.286f, 0.227f,
-                -0.15451026378611f, 0.5f, -0.47552768414126f, 0.4f, 0.286f, 0.227f,
-                -0.15451026378611f, -0.5f, -0.47552768414126f, 0.4f, 0.286f, 0.227f,
-                -0.052266166939075f, 0.5f, -0.49726074427155f, 0.4f, 0.286f, 0.227f,
-                -0.052266166939075f, -0.5f, -0.49726074427155f, 0.4f, 0.286f, 0.227f,
-                0.052262208359312f, 0.5f, -0.4972611603347f, 0.4f, 0.286f, 0.227f,
-                0.052262208359312f, -0.5f, -0.4972611603347f, 0.4f, 0.286f, 0.227f,
-                0.15450647821499f, 0.5f, -0.47552891414676f, 0.4f, 0.286f, 0.227f,
-                0.15450647821499f, -0.5f, -0.47552891414676f, 0.4f, 0.286f, 0.227f,
-                0.24999808493408f, 0.5f, -0.4330138075504f, 0.4f, 0.286f, 0.227f,
-                0.24999808493408f, -0.5f, -0.4330138075504f, 0.4f, 0.286f, 0.227f,
-                0.3345635941079f, 0.5f, -0.37157395158649f, 0.4f, 0.286f, 0.227f,
-                0.3345635941079f, -0.5f, -0.37157395158649f, 0.4f, 0.286f, 0.227f,
-                0.40450709341601f, 0.5f, -0.2938945582622f, 0.4f, 0.286f, 0.227f,
-                0.40450709341601f, -0.5f, -0.2938945582622f, 0.4f, 0.286f, 0.227f,
-                0.45677172145764f, 0.5f, -0.20337058409865f, 0.4f, 0.286f, 0.227f,
-                0.45677172145764f, -0.5f, -0.20337058409865f, 0.4f, 0.286f, 0.227f,
-                0.48907326703854f, 0.5f, -0.10395835448992f, 0.4f, 0.286f, 0.227f,
-                0.48907326703854f, -0.5f, -0.10395835448992f, 0.4f, 0.286f, 0.227f,
-                0.0f, -0.5f, 0.0f, 0.4f, 0.286f, 0.227f
-        };
-
-        // Marble cylinder
-        std::vector<GLfloat> unitCylinderVertexDataColour2{
-                0.0f, 0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.5f, 0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.5f, -0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907381875731f, 0.5f, 0.1039557588888f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907381875731f, -0.5f, 0.1039557588888f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677280077542f, 0.5f, 0.20336815992623f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677280077542f, -0.5f, 0.20336815992623f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450865316151f, 0.5f, 0.29389241146627f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450865316151f, -0.5f, 0.29389241146627f, 0.9608f, 0.9569f, 0.9569f,
-                0.33456556611288f, 0.5f, 0.37157217599218f, 0.9608f, 0.9569f, 0.9569f,
-                0.33456556611288f, -0.5f, 0.37157217599218f, 0.9608f, 0.9569f, 0.9569f,
-                0.2500003830126f, 0.5f, 0.43301248075957f, 0.9608f, 0.9569f, 0.9569f,
-                0.2500003830126f, -0.5f, 0.43301248075957f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450900193016f, 0.5f, 0.47552809414644f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450900193016f, -0.5f, 0.47552809414644f, 0.9608f, 0.9569f, 0.9569f,
-                0.052264847412855f, 0.5f, 0.49726088296277f, 0.9608f, 0.9569f, 0.9569f,
-                0.052264847412855f, -0.5f, 0.49726088296277f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052263527886268f, 0.5f, 0.49726102165048f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052263527886268f, -0.5f, 0.49726102165048f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15450774007312f, 0.5f, 0.47552850414828f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15450774007312f, -0.5f, 0.47552850414828f, 0.9608f, 0.9569f, 0.9569f,
-                -0.24999923397422f, 0.5f, 0.43301314415651f, 0.9608f, 0.9569f, 0.9569f,
-                -0.24999923397422f, -0.5f, 0.43301314415651f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456458011157f, 0.5f, 0.37157306379065f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456458011157f, -0.5f, 0.37157306379065f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450787329018f, 0.5f, 0.29389348486527f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450787329018f, -0.5f, 0.29389348486527f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677226111814f, 0.5f, 0.20336937201315f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677226111814f, -0.5f, 0.20336937201315f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907354289964f, 0.5f, 0.10395705668972f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907354289964f, -0.5f, 0.10395705668972f, 0.9608f, 0.9569f, 0.9569f,
-                -0.49999999999824f, 0.5f, 1.3267948966764e-006f, 0.9608f, 0.9569f, 0.9569f,
-                -0.49999999999824f, -0.5f, 1.3267948966764e-006f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907409461153f, 0.5f, -0.10395446108714f, 0.9608f, 0.9569f, 0.9569f,
-                -0.48907409461153f, -0.5f, -0.10395446108714f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677334042948f, 0.5f, -0.20336694783787f, 0.9608f, 0.9569f, 0.9569f,
-                -0.45677334042948f, -0.5f, -0.20336694783787f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450943302999f, 0.5f, -0.2938913380652f, 0.9608f, 0.9569f, 0.9569f,
-                -0.40450943302999f, -0.5f, -0.2938913380652f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456655211184f, 0.5f, -0.3715712881911f, 0.9608f, 0.9569f, 0.9569f,
-                -0.33456655211184f, -0.5f, -0.3715712881911f, 0.9608f, 0.9569f, 0.9569f,
-                -0.25000153204922f, 0.5f, -0.43301181735958f, 0.9608f, 0.9569f, 0.9569f,
-                -0.25000153204922f, -0.5f, -0.43301181735958f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15451026378611f, 0.5f, -0.47552768414126f, 0.9608f, 0.9569f, 0.9569f,
-                -0.15451026378611f, -0.5f, -0.47552768414126f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052266166939075f, 0.5f, -0.49726074427155f, 0.9608f, 0.9569f, 0.9569f,
-                -0.052266166939075f, -0.5f, -0.49726074427155f, 0.9608f, 0.9569f, 0.9569f,
-                0.052262208359312f, 0.5f, -0.4972611603347f, 0.9608f, 0.9569f, 0.9569f,
-                0.052262208359312f, -0.5f, -0.4972611603347f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450647821499f, 0.5f, -0.47552891414676f, 0.9608f, 0.9569f, 0.9569f,
-                0.15450647821499f, -0.5f, -0.47552891414676f, 0.9608f, 0.9569f, 0.9569f,
-                0.24999808493408f, 0.5f, -0.4330138075504f, 0.9608f, 0.9569f, 0.9569f,
-                0.24999808493408f, -0.5f, -0.4330138075504f, 0.9608f, 0.9569f, 0.9569f,
-                0.3345635941079f, 0.5f, -0.37157395158649f, 0.9608f, 0.9569f, 0.9569f,
-                0.3345635941079f, -0.5f, -0.37157395158649f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450709341601f, 0.5f, -0.2938945582622f, 0.9608f, 0.9569f, 0.9569f,
-                0.40450709341601f, -0.5f, -0.2938945582622f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677172145764f, 0.5f, -0.20337058409865f, 0.9608f, 0.9569f, 0.9569f,
-                0.45677172145764f, -0.5f, -0.20337058409865f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907326703854f, 0.5f, -0.10395835448992f, 0.9608f, 0.9569f, 0.9569f,
-                0.48907326703854f, -0.5f, -0.10395835448992f, 0.9608f, 0.9569f, 0.9569f,
-                0.0f, -0.5f, 0.0f, 0.9608f, 0.9569f, 0.9569f
-        };
+        addUnitCylinderLod<g_iUnitPrimitiveSegments>();
+        addUnitCylinderLod<g_iLodSegments1>();
+        addUnitCylinderLod<g_iLodSegments2>();
+    }
 
-        unitCylinderVertexIndicesTriFan1 = {
-                0, 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51,
-                53, 55, 57, 59, 1
-        };
+    template <int Segments>
+    void addUnitCylinderLod() {
+        static constexpr auto vertexPositions = primitives::UnitCylinderVertices<primitives::PositionOnly, Segments>({});
+        static constexpr auto vertexColours1 = primitives::UnitCylinderVertices<primitives::ColourOnly, Segments>(
+                {0.4f, 0.286f, 0.227f});
+        static constexpr auto vertexColours2 = primitives::UnitCylinderVertices<primitives::ColourOnly, Segments>(
+                {0.9608f, 0.9569f, 0.9569f});
+        static constexpr auto triFan1 = primitives::UnitCylinderTriFan1<Segments>();
+        static constexpr auto triFan2 = primitives::UnitCylinderTriFan2<Segments>();
+        static constexpr auto triStrip = primitives::UnitCylinderTriStrip<Segments>();
+
+        // Both colours share the position stream, index buffers and depth VAO.
+        PrimitiveLod lod = uploadPrimitiveLod(vertexPositions, triFan1, triFan2, triStrip);
+        lod.VAO = createVertexArray(lod.positionVBO, createArrayBuffer(vertexColours1.data(), vertexColours1.size()));
+        unitCylinderLods1.push_back(lod);
+        lod.VAO = createVertexArray(lod.positionVBO, createArrayBuffer(vertexColours2.data(), vertexColours2.size()));
+        unitCylinderLods2.push_back(lod);
+    }
 
-        unitCylinderVertexIndicesTriFan2 = {
-                61, 60, 58, 56, 54, 52, 50, 48, 46, 44, 42, 40, 38, 36, 34, 32, 30, 28, 26, 24, 22, 20, 18, 16, 14, 12,
-                10, 8, 6, 4, 2, 60
-        };
+    template <int Segments>
+    void addUnitConeLod() {
+        static constexpr auto vertexPositions = primitives::UnitConeVertices<primitives::PositionOnly, Segments>({});
+        static constexpr auto vertexColours = primitives::UnitConeVertices<primitives::ColourOnly, Segments>(
+                {0.094f, 0.369f, 0.247f});
+        static constexpr auto triFan1 = primitives::UnitConeTriFan1<Segments>();
+        static constexpr auto triFan2 = primitives::UnitConeTriFan2<Segments>();
+
+        PrimitiveLod lod = uploadPrimitiveLod(vertexPositions, triFan1, triFan2, std::array<GLuint, 0>{});
+        lod.VAO = createVertexArray(lod.positionVBO, createArrayBuffer(vertexColours.data(), vertexColours.size()));
+        unitConeLods.push_back(lod);
+    }
 
-        unitCylinderVertexIndicesTriStrip = {
-                1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28,
-                29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54,
-                55, 56, 57, 58, 59, 60, 1, 2
+    // Uploads the position stream and index buffers of a level; the caller adds the colour VAO.
+    template <size_t PositionFloats, size_t TriFan1Count, size_t TriFan2Count, size_t TriStripCount>
+    static PrimitiveLod uploadPrimitiveLod(const std::array<GLfloat, PositionFloats>& vertexPositions,
+                                           const std::array<GLuint, TriFan1Count>& triFan1,
+                                           const std::array<GLuint, TriFan2Count>& triFan2,
+                                           const std::array<GLuint, TriStripCount>& triStrip) {
+        PrimitiveLod lod;
+        lod.positionVBO = createArrayBuffer(vertexPositions.data(), vertexPositions.size());
+        lod.depthVAO = createVertexArray(lod.positionVBO, 0);
+
+        auto uploadIndices = [](GLuint& EBO, GLsizei& count, const GLuint* indices, size_t indexCount) {
+            count = static_cast<GLsizei>(indexCount);
+            if (indexCount == 0)
+                return;
+            glGenBuffers(1, &EBO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexCount * sizeof(GLuint)),
+                         indices, GL_STATIC_DRAW);
         };
+        uploadIndices(lod.EBOTriFan1, lod.triFan1Count, triFan1.data(), triFan1.size());
+        uploadIndices(lod.EBOTriFan2, lod.triFan2Count, triFan2.data(), triFan2.size());
+        uploadIndices(lod.EBOTriStrip, lod.triStripCount, triStrip.data(), triStrip.size());
 
-        glGenVertexArrays(1, &unitCylinderVAO1);
-        glGenVertexArrays(1, &unitCylinderVAO2);
-        glGenBuffers(1, &unitCylinderVBO1);
-        glGenBuffers(1, &unitCylinderVBO2);
-        glGenBuffers(1, &unitCylinderEBOTriStrip);
-        glGenBuffers(1, &unitCylinderEBOTriFan1);
-        glGenBuffers(1, &unitCylinderEBOTriFan2);
-
-        glBindVertexArray(unitCylinderVAO1);
-        glBindBuffer(GL_ARRAY_BUFFER, unitCylinderVBO1);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCylinderVertexDataColour1.size() * sizeof(GLfloat)),
-                     unitCylinderVertexDataColour1.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(unitCylinderVAO2);
-        glBindBuffer(GL_ARRAY_BUFFER, unitCylinderVBO2);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCylinderVertexDataColour2.size() * sizeof(GLfloat)),
-                     unitCylinderVertexDataColour2.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
-
-        // Add data to EBOs
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan1);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCylinderVertexIndicesTriFan1.size() * sizeof(GLint)),
-                     unitCylinderVertexIndicesTriFan1.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan2);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCylinderVertexIndicesTriFan2.size() * sizeof(GLint)),
-                     unitCylinderVertexIndicesTriFan2.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriStrip);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitCylinderVertexIndicesTriStrip.size() * sizeof(GLint)),
-                     unitCylinderVertexIndicesTriStrip.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        return lod;
     }
 
-    void createUnitCone() {
-        std::vector<GLfloat> unitConeVertexData {
-                0.0f, 0.866f, 0.0f, 0.094f, 0.369f, 0.247f,
-                0.5f, 0.0f, 0.0f, 0.094f, 0.369f, 0.247f,
-                0.48907381875731f, 0.0f, 0.1039557588888f, 0.094f, 0.369f, 0.247f,
-                0.45677280077542f, 0.0f, 0.20336815992623f, 0.094f, 0.369f, 0.247f,
-                0.40450865316151f, 0.0f, 0.29389241146627f, 0.094f, 0.369f, 0.247f,
-                0.33456556611288f, 0.0f, 0.37157217599218f, 0.094f, 0.369f, 0.247f,
-                0.2500003830126f, 0.0f, 0.43301248075957f, 0.094f, 0.369f, 0.247f,
-                0.15450900193016f, 0.0f, 0.47552809414644f, 0.094f, 0.369f, 0.247f,
-                0.052264847412855f, 0.0f, 0.49726088296277f, 0.094f, 0.369f, 0.247f,
-                -0.052263527886268f, 0.0f, 0.49726102165048f, 0.094f, 0.369f, 0.247f,
-                -0.15450774007312f, 0.0f, 0.47552850414828f, 0.094f, 0.369f, 0.247f,
-                -0.24999923397422f, 0.0f, 0.43301314415651f, 0.094f, 0.369f, 0.247f,
-                -0.33456458011157f, 0.0f, 0.37157306379065f, 0.094f, 0.369f, 0.247f,
-                -0.40450787329018f, 0.0f, 0.29389348486527f, 0.094f, 0.369f, 0.247f,
-                -0.45677226111814f, 0.0f, 0.20336937201315f, 0.094f, 0.369f, 0.247f,
-                -0.48907354289964f, 0.0f, 0.10395705668972f, 0.094f, 0.369f, 0.247f,
-                -0.49999999999824f, 0.0f, 1.3267948966764e-006f, 0.094f, 0.369f, 0.247f,
-                -0.48907409461153f, 0.0f, -0.10395446108714f, 0.094f, 0.369f, 0.247f,
-                -0.45677334042948f, 0.0f, -0.20336694783787f, 0.094f, 0.369f, 0.247f,
-                -0.40450943302999f, 0.0f, -0.2938913380652f, 0.094f, 0.369f, 0.247f,
-                -0.33456655211184f, 0.0f, -0.3715712881911f, 0.094f, 0.369f, 0.247f,
-                -0.25000153204922f, 0.0f, -0.43301181735958f, 0.094f, 0.369f, 0.247f,
-                -0.15451026378611f, 0.0f, -0.47552768414126f, 0.094f, 0.369f, 0.247f,
-                -0.052266166939075f, 0.0f, -0.49726074427155f, 0.094f, 0.369f, 0.247f,
-                0.052262208359312f, 0.0f, -0.4972611603347f, 0.094f, 0.369f, 0.247f,
-                0.15450647821499f, 0.0f, -0.47552891414676f, 0.094f, 0.369f, 0.247f,
-                0.24999808493408f, 0.0f, -0.4330138075504f, 0.094f, 0.369f, 0.247f,
-                0.3345635941079f, 0.0f, -0.37157395158649f, 0.094f, 0.369f, 0.247f,
-                0.40450709341601f, 0.0f, -0.2938945582622f, 0.094f, 0.369f, 0.247f,
-                0.45677172145764f, 0.0f, -0.20337058409865f, 0.094f, 0.369f, 0.247f,
-                0.48907326703854f, 0.0f, -0.10395835448992f, 0.094f, 0.369f, 0.247f,
-                0.0f, 0.0f, 0.0f, 0.094f, 0.369f, 0.247f,
-        };
-
-        unitConeVertexIndicesTriFan1 = {
-                0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
-                28, 29, 30, 1
-        };
-
-        unitConeVertexIndicesTriFan2 = {
-                31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10,
-                9, 8, 7, 6, 5, 4, 3, 2, 1, 30
-        };
-
-        glGenVertexArrays(1, &unitConeVAO);
-        glGenBuffers(1, &unitConeVBO);
-        glGenBuffers(1, &unitConeEBOTriFan1);
-        glGenBuffers(1, &unitConeEBOTriFan2);
+    void drawPrimitiveLod(const PrimitiveLod& lod) const {
+        glBindVertexArray(selectVAO(lod.VAO, lod.depthVAO));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.EBOTriFan1);
+        glDrawElements(GL_TRIANGLE_FAN, lod.triFan1Count, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.EBOTriFan2);
+        glDrawElements(GL_TRIANGLE_FAN, lod.triFan2Count, GL_UNSIGNED_INT, nullptr);
+        g_renderStats.CountStateChange(3);
+        g_renderStats.CountDraw(GL_TRIANGLE_FAN, lod.triFan1Count);
+        g_renderStats.CountDraw(GL_TRIANGLE_FAN, lod.triFan2Count);
+        if (lod.triStripCount > 0) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.EBOTriStrip);
+            glDrawElements(GL_TRIANGLE_STRIP, lod.triStripCount, GL_UNSIGNED_INT, nullptr);
+            g_renderStats.CountStateChange();
+            g_renderStats.CountDraw(GL_TRIANGLE_STRIP, lod.triStripCount);
+        }
+    }
 
-        glBindVertexArray(unitConeVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, unitConeVBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitConeEBOTriFan1);
+    void drawUnitCube() const {
+        glBindVertexArray(selectVAO(unitCubeVAO, unitCubeDepthVAO));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
+                       GL_UNSIGNED_INT, nullptr);
+        g_renderStats.CountStateChange(2);
+        g_renderStats.CountDraw(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()));
+    }
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
+    void setModelMatrix(const glm::mat4& modelToCamera) const {
+        glUniformMatrix4fv(activeProgram().modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCamera));
+        g_renderStats.CountUniformUpload();
+    }
 
-        // Add data to VBO and EBO
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitConeVertexData.size() * sizeof(GLfloat)),
-                     unitConeVertexData.data(), GL_STATIC_DRAW);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitConeVertexIndicesTriFan1.size() * sizeof(GLint)),
-                     unitConeVertexIndicesTriFan1.data(), GL_STATIC_DRAW);
+    // Projects the bounding sphere of an object and returns its new level of detail.
+    [[nodiscard]] int selectPrimitiveLod(int currentLevel, const glm::mat4& modelMatrix, const glm::vec3& localCentre,
+                                         float fRadius) const {
+        if (!g_bPrimitiveLod)
+            return 0;
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitConeEBOTriFan2);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(unitConeVertexIndicesTriFan2.size() * sizeof(GLint)),
-                     unitConeVertexIndicesTriFan2.data(), GL_STATIC_DRAW);
+        glm::vec3 centre = glm::vec3(modelMatrix * glm::vec4(localCentre, 1.0f));
+        float projectedSize = LodSelector::ProjectedSize(centre, fRadius, lodCameraPosition,
+                                                         glm::radians(g_fFovYDegrees), viewportHeight);
+        return primitiveLodSelector.Select(currentLevel, projectedSize);
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+    void createUnitCone() {
+        addUnitConeLod<g_iUnitPrimitiveSegments>();
+        addUnitConeLod<g_iLodSegments1>();
+        addUnitConeLod<g_iLodSegments2>();
     }
 
-    bool resizeFlag = false;
     void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
         // Update viewport dimensions on window resize
         glUseProgram(data.shaderProgram);
@@ -532,7 +468,7 @@ public:
         glViewport(0, 0, width, height);
         glUniform1i(windowWidthLocation, width);
         glUniform1i(windowHeightLocation, height);
-        resizeFlag = true;
+        viewportHeight = height;
     }
 
     void set_shader_sources() {
@@ -550,6 +486,8 @@ public:
                 mat4 viewMatrix;
                 mat4 projectionMatrix;
             };
+            // Must match the depth pre-pass bit for bit for the GL_EQUAL depth test.
+            invariant gl_Position;
 
             void main() {
                 gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertexPosition, 1.0f);
@@ -561,11 +499,55 @@ public:
             in vec3 vertex_colour;
             out vec4 FragColour;
             uniform float fElapsedTime;
+            uniform float fImpostorFade;
+
+            // Ordered dither threshold; the impostor pass keeps exactly the pixels discarded here.
+            float ditherThreshold() {
+                const float bayer[16] = float[16](0.0f, 8.0f, 2.0f, 10.0f, 12.0f, 4.0f, 14.0f, 6.0f,
+                                                  3.0f, 11.0f, 1.0f, 9.0f, 15.0f, 7.0f, 13.0f, 5.0f);
+                ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+                return (bayer[pixel.y * 4 + pixel.x] + 0.5f) / 16.0f;
+            }
 
             void main() {
+                if (fImpostorFade > ditherThreshold())
+                    discard;
                 FragColour = vec4(vertex_colour, 1.0f);
             }
         )";
+
+        // Depth pre-pass: same position transform, no colour. The dither discard is repeated so
+        // trees that are fading into impostors leave the same holes in the depth buffer.
+        depthVertexShaderSource = R"(
+            #version 330 core
+            layout (location = 0) in vec3 vertexPosition;
+            uniform mat4 modelMatrix;
+            layout(std140) uniform GlobalMatrices {
+                mat4 viewMatrix;
+                mat4 projectionMatrix;
+            };
+            invariant gl_Position;
+
+            void main() {
+                gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertexPosition, 1.0f);
+            }
+        )";
+        depthFragmentShaderSource = R"(
+            #version 330 core
+            uniform float fImpostorFade;
+
+            float ditherThreshold() {
+                const float bayer[16] = float[16](0.0f, 8.0f, 2.0f, 10.0f, 12.0f, 4.0f, 14.0f, 6.0f,
+                                                  3.0f, 11.0f, 1.0f, 9.0f, 15.0f, 7.0f, 13.0f, 5.0f);
+                ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+                return (bayer[pixel.y * 4 + pixel.x] + 0.5f) / 16.0f;
+            }
+
+            void main() {
+                if (fImpostorFade > ditherThreshold())
+                    discard;
+            }
+        )";
     }
 
     static std::string get_shader_label(GLuint shader) {
@@ -601,7 +583,7 @@ public:
 
             // Output or log the error information
             std::string shader_name = get_shader_label(shader);
-            std::cerr << shader_name << " compilation error; deleting shader...:\n" << infoLog << std::endl;
+            LOG_ERROR("{} compilation error; deleting shader...:\n{}", shader_name, infoLog);
 
             delete[] infoLog;
 
@@ -615,6 +597,7 @@ public:
     }
 
     void compile_and_link_shaders() {
+        PROFILE_FUNCTION();
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glObjectLabel(GL_SHADER, vertexShader, -1, "Vertex Shader");
         glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
@@ -630,21 +613,22 @@ public:
         shaders.push_back(fragmentShader);
     }
 
-    void error_check_program() const {
+    static void error_check_program(GLuint shaderProgram) {
         GLint status;
-        glGetProgramiv (data.shaderProgram, GL_LINK_STATUS, &status);
+        glGetProgramiv (shaderProgram, GL_LINK_STATUS, &status);
         if (status == GL_FALSE) {
             GLint infoLogLength;
-            glGetProgramiv(data.shaderProgram, GL_INFO_LOG_LENGTH, &infoLogLength);
+            glGetProgramiv(shaderProgram, GL_INFO_LOG_LENGTH, &infoLogLength);
 
             auto* strInfoLog = new GLchar[infoLogLength + 1];
-            glGetProgramInfoLog(data.shaderProgram, infoLogLength, nullptr, strInfoLog);
-            std::cerr << "Linker failure: \n" << strInfoLog;
+            glGetProgramInfoLog(shaderProgram, infoLogLength, nullptr, strInfoLog);
+            LOG_ERROR("Linker failure: \n{}", strInfoLog);
             delete[] strInfoLog;
         }
     }
 
     void create_and_link_program() {
+        PROFILE_FUNCTION();
         data.shaderProgram = glCreateProgram();
 
         for (GLuint shader : shaders) {
@@ -652,12 +636,44 @@ public:
         }
 
         glLinkProgram(data.shaderProgram);
-        error_check_program();
+        error_check_program(data.shaderProgram);
 
         for (GLuint shader : shaders) {
             glDetachShader(data.shaderProgram, shader);
             glDeleteShader(shader);
         }
+        shaders.clear();
+    }
+
+    void create_depth_program() {
+        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &depthVertexShaderSource, nullptr);
+        glObjectLabel(GL_SHADER, vertexShader, -1, "Depth Vertex Shader");
+        glCompileShader(vertexShader);
+        error_check_shader(vertexShader);
+
+        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &depthFragmentShaderSource, nullptr);
+        glObjectLabel(GL_SHADER, fragmentShader, -1, "Depth Fragment Shader");
+        glCompileShader(fragmentShader);
+        error_check_shader(fragmentShader);
+
+        depthData.shaderProgram = glCreateProgram();
+        glAttachShader(depthData.shaderProgram, vertexShader);
+        glAttachShader(depthData.shaderProgram, fragmentShader);
+        glLinkProgram(depthData.shaderProgram);
+        error_check_program(depthData.shaderProgram);
+
+        glDetachShader(depthData.shaderProgram, vertexShader);
+        glDetachShader(depthData.shaderProgram, fragmentShader);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        depthData.globalUniformBlockIndex = glGetUniformBlockIndex(depthData.shaderProgram, "GlobalMatrices");
+        glUniformBlockBinding(depthData.shaderProgram, depthData.globalUniformBlockIndex,
+                              g_iGlobalMatricesBindingIndex);
+        depthData.modelMatrixLocation = glGetUniformLocation(depthData.shaderProgram, "modelMatrix");
+        depthData.impostorFadeLocation = glGetUniformLocation(depthData.shaderProgram, "fImpostorFade");
     }
 
     static glm::vec3 ResolveCamPosition() {
@@ -696,6 +712,8 @@ public:
     }
 
     void perform_render_sequence(GLFWwindow* window) {
+        PROFILE_FUNCTION();
+        gpuTimer.BeginFrame();
         // Clear the color and depth buffers
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -705,43 +723,102 @@ public:
         glm::vec3 upVector = glm::vec3(0.0f, 1.0f, 0.0f);
 
         glm::mat4 viewMatrix = CalcLookAtMatrix(cameraPosition, cameraTarget, upVector);
-        glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f),
+        glm::mat4 projectionMatrix = glm::perspective(glm::radians(g_fFovYDegrees),
                                                       static_cast<GLfloat>(WINDOW_WIDTH) /
                                                       static_cast<GLfloat>(WINDOW_HEIGHT),
-                                                      0.1f, 200.0f);
+                                                      0.1f, std::max(200.0f, fTerrainSize * 1.5f));
+        lodCameraPosition = cameraPosition;
 
         data.modelMatrixLocation = glGetUniformLocation(data.shaderProgram, "modelMatrix");
         glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+        data.impostorFadeLocation = glGetUniformLocation(data.shaderProgram, "fImpostorFade");
+        g_renderStats.CountUniformUpload();
 
         glBindBuffer(GL_UNIFORM_BUFFER, g_GlobalMatricesUBO);
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(viewMatrix));
         glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projectionMatrix));
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        g_renderStats.CountStateChange(2);
+        g_renderStats.CountBufferUpload(sizeof(glm::mat4) * 2);
+
+        if (g_bOcclusionCulling) {
+            occlusionCuller.BeginFrame(projectionMatrix * viewMatrix);
+            for (const glm::vec3& parthenonPosition : parthenonPositions)
+                addParthenonOccluders(getParthenonStack(parthenonPosition));
+            occlusionCuller.RasteriseOccluders();
+        }
+
+        if (g_bDepthPrePass) {
+            // Lay down depth only, then shade each visible pixel once with an equal depth test.
+            bDepthPass = true;
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            drawScene(window);
+            bDepthPass = false;
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+            g_renderStats.CountStateChange(4);
+        }
+
+        drawScene(window);
 
-        drawTerrain(window);
-        drawForest(window);
-        // Draw the Parthenon.
+        if (g_bDepthPrePass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+            g_renderStats.CountStateChange(2);
+        }
+
+        // Impostors are alpha tested, so they stay out of the pre-pass and are drawn last.
         {
-            MatrixStack modelToCameraStack;
-            // Set Parthenon position in scene
-            modelToCameraStack.Translate(glm::vec3(20.0f, 0.0f, -10.0f));
-            drawParthenon(modelToCameraStack);
+            GpuPassScope gpuPass(gpuTimer, "Impostors");
+            treeImpostors.Draw(lodCameraPosition);
+        }
+        glUseProgram(data.shaderProgram);
+        g_renderStats.CountProgramBind();
+    }
+
+    static MatrixStack getParthenonStack(const glm::vec3& position) {
+        MatrixStack parthenonStack;
+        parthenonStack.Translate(position);
+        return parthenonStack;
+    }
+
+    void drawScene(GLFWwindow* window) {
+        PROFILE_FUNCTION();
+        {
+            GpuPassScope gpuPass(gpuTimer, bDepthPass ? "Terrain (depth)" : "Terrain");
+            drawTerrain(window);
+        }
+        {
+            GpuPassScope gpuPass(gpuTimer, bDepthPass ? "Forest (depth)" : "Forest");
+            drawForest(window);
+        }
+        {
+            // Draw the Parthenon.
+            GpuPassScope gpuPass(gpuTimer, bDepthPass ? "Parthenon (depth)" : "Parthenon");
+            parthenonColumnLods.resize(parthenonPositions.size());
+            for (size_t ixParthenon = 0; ixParthenon < parthenonPositions.size(); ixParthenon++)
+                drawParthenon(getParthenonStack(parthenonPositions[ixParthenon]), parthenonColumnLods[ixParthenon]);
         }
         if (g_boolDrawLookatPoint) drawLookAtPoint();
     }
 
     void drawTerrain(GLFWwindow* window) const {
+        PROFILE_FUNCTION();
         MatrixStack modelToCameraStack;
 
-        glUseProgram(data.shaderProgram);
-        glBindVertexArray(unitPlaneVAO);
+        glUseProgram(activeProgram().shaderProgram);
+        glBindVertexArray(selectVAO(unitPlaneVAO, unitPlaneDepthVAO));
+        g_renderStats.CountProgramBind();
 
-        glm::vec3 sceneScale = {100.0f, 0.0f, 100.0f};
+        glm::vec3 sceneScale = {fTerrainSize, 0.0f, fTerrainSize};
         modelToCameraStack.Scale(sceneScale);
-        glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
+        setModelMatrix(modelToCameraStack.Top());
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitPlaneEBO);
         glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
                        GL_UNSIGNED_INT, nullptr);
+        g_renderStats.CountStateChange(2);
+        g_renderStats.CountDraw(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()));
     }
 
     struct TreeData
@@ -752,7 +829,7 @@ public:
         float fConeHeight;
     };
 
-    const std::vector<TreeData> g_forest = {
+    std::vector<TreeData> g_forest = {
         {-45.0f, -40.0f, 2.0f, 3.0f},
         {-42.0f, -35.0f, 2.0f, 3.0f},
         {-39.0f, -29.0f, 2.0f, 4.0f},
@@ -859,33 +936,119 @@ public:
         {25.0f, 45.0f, 2.0f, 3.0f}
     };
 
+    // The treetop is a unit cone scaled by 3 in X/Z, sitting on top of the trunk.
+    static float getTreeHeight(float fTrunkHeight, float fConeHeight) {
+        return fTrunkHeight + fConeHeight * 0.866f;
+    }
+
+    static float getTreeRadius(float fTreeHeight) {
+        return glm::length(glm::vec3(1.5f, fTreeHeight * 0.5f, 0.0f));
+    }
+
+    // Swaps the hand-placed forest and Parthenon for a generated stress scene. Call before
+    // bakeTreeImpostors, which captures the tree variants the scene uses.
+    void useGeneratedScene(const SceneGenerator::Scene& scene) {
+        g_forest.clear();
+        g_forest.reserve(scene.trees.size());
+        for (const SceneGenerator::Tree& tree : scene.trees)
+            g_forest.push_back({tree.fXPos, tree.fZPos, tree.fTrunkHeight, tree.fConeHeight});
+        forestLods.clear();
+        parthenonPositions = scene.buildings;
+        parthenonColumnLods.clear();
+        fTerrainSize = scene.fTerrainSize;
+    }
+
     void drawForest(GLFWwindow* window) {
-        for(const TreeData& tree : g_forest) {
-            const TreeData& currTree = tree;
+        PROFILE_FUNCTION();
+        forestLods.resize(g_forest.size(), 0);
+        treeImpostors.ClearInstances();
+        for(size_t ixTree = 0; ixTree < g_forest.size(); ixTree++) {
+            const TreeData& currTree = g_forest[ixTree];
             MatrixStack modelToCameraStack;
             modelToCameraStack.Translate(glm::vec3(currTree.fXPos, 0.0f, currTree.fZPos));
-            drawTree(modelToCameraStack, currTree.fTrunkHeight, currTree.fConeHeight);
+
+            float fTreeHeight = getTreeHeight(currTree.fTrunkHeight, currTree.fConeHeight);
+            if (g_bOcclusionCulling &&
+                !occlusionCuller.IsVisible(modelToCameraStack.Top(), glm::vec3(-1.5f, 0.0f, -1.5f),
+                                           glm::vec3(1.5f, fTreeHeight, 1.5f)))
+                continue;
+
+            // Impostor share of the crossfade; 0 before the fade band, 1 past fImpostorDistance.
+            float fTreeRadius = getTreeRadius(fTreeHeight);
+            glm::vec3 treeCentre(currTree.fXPos, fTreeHeight * 0.5f, currTree.fZPos);
+            float fImpostorFade = 0.0f;
+            if (g_bTreeImpostors) {
+                float fDistance = glm::length(treeCentre - lodCameraPosition);
+                fImpostorFade = glm::clamp((fDistance - fImpostorDistance) / g_fImpostorFadeWidth + 1.0f, 0.0f, 1.0f);
+            }
+            if (fImpostorFade > 0.0f)
+                treeImpostors.AddInstance(treeCentre, fTreeRadius, forestImpostorVariants[ixTree], fImpostorFade);
+            if (fImpostorFade >= 1.0f)
+                continue;
+
+            forestLods[ixTree] = selectPrimitiveLod(forestLods[ixTree], modelToCameraStack.Top(),
+                                                    glm::vec3(0.0f, fTreeHeight * 0.5f, 0.0f), fTreeRadius);
+            glUniform1f(activeProgram().impostorFadeLocation, fImpostorFade);
+            g_renderStats.CountUniformUpload();
+            drawTree(modelToCameraStack, currTree.fTrunkHeight, currTree.fConeHeight, forestLods[ixTree]);
         }
+        glUniform1f(activeProgram().impostorFadeLocation, 0.0f);
+        g_renderStats.CountUniformUpload();
     };
 
-    void drawTree(MatrixStack modelToCameraStack, float fTrunkHeight = 2.0f, float fConeHeight = 3.0f) const {
+    // Captures every distinct (trunk, cone) tree into the impostor atlas, one column per variant.
+    void bakeTreeImpostors(GLFWwindow* window) {
+        PROFILE_FUNCTION();
+        std::vector<std::pair<float, float>> variants;
+        forestImpostorVariants.clear();
+        for (const TreeData& tree : g_forest) {
+            std::pair<float, float> variant(tree.fTrunkHeight, tree.fConeHeight);
+            auto itVariant = std::find(variants.begin(), variants.end(), variant);
+            forestImpostorVariants.push_back(static_cast<int>(itVariant - variants.begin()));
+            if (itVariant == variants.end())
+                variants.push_back(variant);
+        }
+        treeImpostors.Create(static_cast<int>(variants.size()), g_iGlobalMatricesBindingIndex);
+
+        glUseProgram(data.shaderProgram);
+        data.modelMatrixLocation = glGetUniformLocation(data.shaderProgram, "modelMatrix");
+        treeImpostors.BeginBake();
+        glBindBuffer(GL_UNIFORM_BUFFER, g_GlobalMatricesUBO);
+        for (size_t ixVariant = 0; ixVariant < variants.size(); ixVariant++) {
+            auto [fTrunkHeight, fConeHeight] = variants[ixVariant];
+            float fTreeHeight = getTreeHeight(fTrunkHeight, fConeHeight);
+            float fTreeRadius = getTreeRadius(fTreeHeight);
+            glm::vec3 treeCentre(0.0f, fTreeHeight * 0.5f, 0.0f);
+            glm::mat4 projectionMatrix = ImpostorAtlas::GetCellProjectionMatrix(fTreeRadius);
+
+            for (int ixElevation = 0; ixElevation < treeImpostors.GetElevationCount(); ixElevation++) {
+                glm::mat4 viewMatrix = treeImpostors.GetCellViewMatrix(ixElevation, treeCentre, fTreeRadius);
+                glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(viewMatrix));
+                glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4),
+                                glm::value_ptr(projectionMatrix));
+
+                treeImpostors.BindCell(static_cast<int>(ixVariant), ixElevation);
+                drawTree(MatrixStack(), fTrunkHeight, fConeHeight, 0);
+            }
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        treeImpostors.EndBake();
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+    }
+
+    void drawTree(MatrixStack modelToCameraStack, float fTrunkHeight = 2.0f, float fConeHeight = 3.0f,
+                  int iLodLevel = 0) const {
         // Draw trunk.
         {
             modelToCameraStack.Push();
             modelToCameraStack.Scale(glm::vec3(1.0f, fTrunkHeight, 1.0f));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCylinderVAO1);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan1);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan1.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan2);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan2.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriStrip);
-            glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(unitCylinderVertexIndicesTriStrip.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawPrimitiveLod(unitCylinderLods1[iLodLevel]);
             modelToCameraStack.Pop();
         }
 
@@ -895,34 +1058,20 @@ public:
             modelToCameraStack.Translate(glm::vec3(0.0f, fTrunkHeight, 0.0f));
             modelToCameraStack.Scale(glm::vec3(3.0f, fConeHeight, 3.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitConeVAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitConeEBOTriFan1);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitConeVertexIndicesTriFan1.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitConeEBOTriFan2);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitConeVertexIndicesTriFan2.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawPrimitiveLod(unitConeLods[iLodLevel]);
         }
     }
 
-    void drawParthenon(MatrixStack modelToCameraStack) {
-        const float g_fParthenonWidth = 14.0f;
-        const float g_fParthenonLength = 20.0f;
-        const float g_fParthenonColumnHeight = 5.0f;
-        const float g_fParthenonBaseHeight = 1.0f;
-        const float g_fParthenonTopHeight = 2.0f;
-
+    void drawParthenon(MatrixStack modelToCameraStack, std::vector<int>& columnLods) {
+        PROFILE_FUNCTION();
         // Draw base.
         {
             modelToCameraStack.Push();
             modelToCameraStack.Scale(glm::vec3(g_fParthenonWidth, g_fParthenonBaseHeight, g_fParthenonLength));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCubeVAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawUnitCube();
             modelToCameraStack.Pop();
         }
 
@@ -932,15 +1081,14 @@ public:
             modelToCameraStack.Translate(glm::vec3(0.0f, g_fParthenonColumnHeight + g_fParthenonBaseHeight, 0.0f));
             modelToCameraStack.Scale(glm::vec3(g_fParthenonWidth, g_fParthenonBaseHeight, g_fParthenonLength));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCubeVAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawUnitCube();
             modelToCameraStack.Pop();
         }
 
         //Draw columns.
+        int ixColumn = 0;
+        columnLods.resize(static_cast<size_t>(g_fParthenonWidth + g_fParthenonLength - 4.0f), 0);
         const float fFrontZVal = (g_fParthenonLength / 2.0f) - 1.0f;
         const float fRightXVal = (g_fParthenonWidth / 2.0f) - 1.0f;
 
@@ -950,7 +1098,7 @@ public:
                 modelToCameraStack.Translate(glm::vec3((2.0f * static_cast<float>(iColumnNum)) - (g_fParthenonWidth / 2.0f) + 1.0f,
                                                 g_fParthenonBaseHeight, fFrontZVal));
 
-                drawColumn(modelToCameraStack, g_fParthenonColumnHeight);
+                drawColumn(modelToCameraStack, g_fParthenonColumnHeight, columnLods[ixColumn++]);
                 modelToCameraStack.Pop();
             }
             {
@@ -958,7 +1106,7 @@ public:
                 modelToCameraStack.Translate(glm::vec3((2.0f * static_cast<float>(iColumnNum)) - (g_fParthenonWidth / 2.0f) + 1.0f,
                                                 g_fParthenonBaseHeight, -fFrontZVal));
 
-                drawColumn(modelToCameraStack, g_fParthenonColumnHeight);
+                drawColumn(modelToCameraStack, g_fParthenonColumnHeight, columnLods[ixColumn++]);
                 modelToCameraStack.Pop();
             }
         }
@@ -971,7 +1119,7 @@ public:
                                                 g_fParthenonBaseHeight,
                                                 (2.0f * static_cast<float>(iColumnNum)) - (g_fParthenonLength / 2.0f) + 1.0f));
 
-                drawColumn(modelToCameraStack, g_fParthenonColumnHeight);
+                drawColumn(modelToCameraStack, g_fParthenonColumnHeight, columnLods[ixColumn++]);
                 modelToCameraStack.Pop();
             }
             {
@@ -980,7 +1128,7 @@ public:
                                                        g_fParthenonBaseHeight,
                                                        (2.0f * static_cast<float>(iColumnNum)) - (g_fParthenonLength / 2.0f) + 1.0f));
 
-                drawColumn(modelToCameraStack, g_fParthenonColumnHeight);
+                drawColumn(modelToCameraStack, g_fParthenonColumnHeight, columnLods[ixColumn++]);
                 modelToCameraStack.Pop();
             }
         }
@@ -993,11 +1141,8 @@ public:
                                         g_fParthenonLength - 6.0f));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCubeVAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawUnitCube();
             modelToCameraStack.Pop();
         }
 
@@ -1011,36 +1156,67 @@ public:
             modelToCameraStack.RotateX(-135.0f);
             modelToCameraStack.RotateY(45.0f);
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCubeVAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawUnitCube();
+            modelToCameraStack.Pop();
+        }
+    }
+
+    // The base, top and solid interior of the Parthenon are the only large opaque boxes in the
+    // scene, so they are rasterised into the CPU depth buffer as occluders.
+    void addParthenonOccluders(MatrixStack modelToCameraStack) {
+        // Base.
+        {
+            modelToCameraStack.Push();
+            modelToCameraStack.Scale(glm::vec3(g_fParthenonWidth, g_fParthenonBaseHeight, g_fParthenonLength));
+            modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
+            occlusionCuller.AddOccluderBox(modelToCameraStack.Top());
+            modelToCameraStack.Pop();
+        }
+
+        // Top.
+        {
+            modelToCameraStack.Push();
+            modelToCameraStack.Translate(glm::vec3(0.0f, g_fParthenonColumnHeight + g_fParthenonBaseHeight, 0.0f));
+            modelToCameraStack.Scale(glm::vec3(g_fParthenonWidth, g_fParthenonBaseHeight, g_fParthenonLength));
+            modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
+            occlusionCuller.AddOccluderBox(modelToCameraStack.Top());
+            modelToCameraStack.Pop();
+        }
+
+        // Interior.
+        {
+            modelToCameraStack.Push();
+            modelToCameraStack.Translate(glm::vec3(0.0f, 1.0f, 0.0f));
+            modelToCameraStack.Scale(glm::vec3(g_fParthenonWidth - 6.0f, g_fParthenonColumnHeight,
+                                               g_fParthenonLength - 6.0f));
+            modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
+            occlusionCuller.AddOccluderBox(modelToCameraStack.Top());
             modelToCameraStack.Pop();
         }
     }
 
     // Columns are 1x1 in the X/Z, and fHeight units in the Y.
-    void drawColumn(MatrixStack modelToCameraStack, float fHeight = 5.0f) {
+    void drawColumn(MatrixStack modelToCameraStack, float fHeight, int& lodLevel) {
         const float g_fColumnBaseHeight = 0.25f;
 
+        if (g_bOcclusionCulling &&
+            !occlusionCuller.IsVisible(modelToCameraStack.Top(), glm::vec3(-0.5f, 0.0f, -0.5f),
+                                       glm::vec3(0.5f, fHeight, 0.5f)))
+            return;
+
+        lodLevel = selectPrimitiveLod(lodLevel, modelToCameraStack.Top(), glm::vec3(0.0f, fHeight * 0.5f, 0.0f),
+                                      glm::length(glm::vec3(0.5f, fHeight * 0.5f, 0.0f)));
+        const int iLodLevel = lodLevel;
+
         //Draw the bottom of the column.
         {
             modelToCameraStack.Push();
             modelToCameraStack.Scale(glm::vec3(1.0f, g_fColumnBaseHeight, 1.0f));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCylinderVAO2);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan1);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan1.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan2);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan2.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriStrip);
-            glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(unitCylinderVertexIndicesTriStrip.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawPrimitiveLod(unitCylinderLods2[iLodLevel]);
             modelToCameraStack.Pop();
         }
 
@@ -1051,17 +1227,8 @@ public:
             modelToCameraStack.Scale(glm::vec3(1.0f, g_fColumnBaseHeight, 1.0f));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCylinderVAO2);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan1);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan1.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan2);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan2.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriStrip);
-            glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(unitCylinderVertexIndicesTriStrip.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawPrimitiveLod(unitCylinderLods2[iLodLevel]);
             modelToCameraStack.Pop();
         }
 
@@ -1072,17 +1239,8 @@ public:
             modelToCameraStack.Scale(glm::vec3(0.8f, fHeight - (g_fColumnBaseHeight * 2.0f), 0.8f));
             modelToCameraStack.Translate(glm::vec3(0.0f, 0.5f, 0.0f));
 
-            glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-            glBindVertexArray(unitCylinderVAO2);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan1);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan1.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriFan2);
-            glDrawElements(GL_TRIANGLE_FAN, static_cast<GLsizei>(unitCylinderVertexIndicesTriFan2.size()),
-                           GL_UNSIGNED_INT, nullptr);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCylinderEBOTriStrip);
-            glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(unitCylinderVertexIndicesTriStrip.size()),
-                           GL_UNSIGNED_INT, nullptr);
+            setModelMatrix(modelToCameraStack.Top());
+            drawPrimitiveLod(unitCylinderLods2[iLodLevel]);
             modelToCameraStack.Pop();
         }
     }
@@ -1093,15 +1251,22 @@ public:
         modelToCameraStack.Translate(g_cameraTarget);
         modelToCameraStack.Scale(glm::vec3(1.0f, 0.1f, 1.0f));
 
-        glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelToCameraStack.Top()));
-        glBindVertexArray(unitCubeVAO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, unitCubeEBO);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(unitCubeVertexIndicesTri.size()),
-                       GL_UNSIGNED_INT, nullptr);
+        setModelMatrix(modelToCameraStack.Top());
+        drawUnitCube();
     }
 
     // GLFW key callback function
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        g_frameScheduler.MarkDirty();
+
+        // Dump the profiler trace
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+            Profiler::Get().WriteChromeTrace();
+
+        // Print the render statistics
+        if (key == GLFW_KEY_F11 && action == GLFW_PRESS)
+            g_renderStats.PrintSnapshot(std::cout);
+
         if (action == GLFW_PRESS) {
             // Check if the Shift key is pressed
             bool shift_pressed = (mods & GLFW_MOD_SHIFT) != 0;
@@ -1179,11 +1344,43 @@ public:
                     else g_sphereCameraRelativePosition.z += 5.0f;
                     break;
                 }
+                case GLFW_KEY_C: {
+                    g_bOcclusionCulling = !g_bOcclusionCulling;
+                    LOG_INFO("{}", g_bOcclusionCulling ? "Occlusion culling on" : "Occlusion culling off");
+                    break;
+                }
+                case GLFW_KEY_V: {
+                    g_bPrimitiveLod = !g_bPrimitiveLod;
+                    LOG_INFO("{}", g_bPrimitiveLod ? "Primitive LOD on" : "Primitive LOD off");
+                    break;
+                }
+                case GLFW_KEY_P: {
+                    g_bDepthPrePass = !g_bDepthPrePass;
+                    LOG_INFO("{}", g_bDepthPrePass ? "Depth pre-pass on" : "Depth pre-pass off");
+                    break;
+                }
+                case GLFW_KEY_B: {
+                    g_bTreeImpostors = !g_bTreeImpostors;
+                    LOG_INFO("{}", g_bTreeImpostors ? "Tree impostors on" : "Tree impostors off");
+                    break;
+                }
+                case GLFW_KEY_N: {
+                    auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
+                    renderer->fImpostorDistance = std::max(renderer->fImpostorDistance - 5.0f, g_fImpostorFadeWidth);
+                    LOG_INFO("Impostor distance: {:f}", renderer->fImpostorDistance);
+                    break;
+                }
+                case GLFW_KEY_M: {
+                    auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
+                    renderer->fImpostorDistance += 5.0f;
+                    LOG_INFO("Impostor distance: {:f}", renderer->fImpostorDistance);
+                    break;
+                }
                 case GLFW_KEY_SPACE: {
                     g_boolDrawLookatPoint = !g_boolDrawLookatPoint;
-                    printf("Target: %f, %f, %f\n", g_cameraTarget.x, g_cameraTarget.y, g_cameraTarget.z);
-                    printf("Position: %f, %f, %f\n", g_sphereCameraRelativePosition.x,
-                           g_sphereCameraRelativePosition.y, g_sphereCameraRelativePosition.z);
+                    LOG_INFO("Target: {:f}, {:f}, {:f}", g_cameraTarget.x, g_cameraTarget.y, g_cameraTarget.z);
+                    LOG_INFO("Position: {:f}, {:f}, {:f}", g_sphereCameraRelativePosition.x,
+                             g_sphereCameraRelativePosition.y, g_sphereCameraRelativePosition.z);
                     break;
                 }
                 default:
@@ -1212,14 +1409,22 @@ private:
     std::vector<GLuint> shaders;
     const char* vertexShaderSource{};
     const char* fragmentShaderSource{};
+    const char* depthVertexShaderSource{};
+    const char* depthFragmentShaderSource{};
 };
 
 bool Renderer::g_boolDrawLookatPoint = false;
+bool Renderer::g_bOcclusionCulling = true;
+bool Renderer::g_bDepthPrePass = false;
+bool Renderer::g_bPrimitiveLod = true;
+bool Renderer::g_bTreeImpostors = true;
 glm::vec3 Renderer::g_cameraTarget{0.0f, 0.4f, 0.0f};
 glm::vec3 Renderer::g_sphereCameraRelativePosition{67.5f, -46.0f, 150.0f};
 
 // GLFW requires a static or non-member function for the framebuffer size callback
 void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    g_frameScheduler.MarkDirty();
+
     // Retrieve the Renderer instance associated with the window
     auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
 
@@ -1230,14 +1435,46 @@ void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 }
 
 
-int main() {
-    GLFWwindow* window = initializeGLFW();
+int main(int argc, char* argv[]) {
+    LaunchOptions options = parseLaunchOptions(argc, argv);
+    Profiler::Get().SetThreadName("Main");
+    if (!options.tracePath.empty())
+        Profiler::Get().SetTracePath(options.tracePath);
+
+    // Benchmark runs take the camera from a keyframed path instead of the keyboard
+    CameraPath cameraPath;
+    if (!options.cameraPathFile.empty()) {
+        if (!cameraPath.Load(options.cameraPathFile))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = cameraPath.GetFrameCount(options.fTimestep);
+        LOG_INFO("Camera path: {} s in steps of {} s, {} frames", cameraPath.GetDuration(), options.fTimestep,
+                 options.iFrameLimit);
+    }
+    int ixPathFrame = 0;
+
+    // Record this session's input, or replay a recorded one
+    if (!options.recordInputPath.empty() && !g_inputLog.StartRecording(options.recordInputPath))
+        return 1;
+    if (!options.replayInputPath.empty()) {
+        if (!g_inputLog.StartReplay(options.replayInputPath))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = g_inputLog.GetReplayFrameCount();
+    }
+
+    RenderBackend backend(options);
+    GLFWwindow* window = initializeGLFW(backend);
     initializeGLEW();
+    backend.Create(window);
 
     Renderer renderer = Renderer();
     renderer.set_shader_sources();
     renderer.compile_and_link_shaders();
     renderer.create_and_link_program();
+    renderer.create_depth_program();
+    if (options.bGpuTimers)
+        renderer.gpuTimer.Create();
 
     // Create and bind globalMatrices buffer object to context
     glGenBuffers(1, &g_GlobalMatricesUBO);
@@ -1266,6 +1503,21 @@ int main() {
     renderer.createUnitCone();
     renderer.createUnitCylinder();
 
+    // Optionally scale the scene up for benchmarks
+    if (options.iSceneTreeCount >= 0 || options.iSceneBuildingCount >= 0) {
+        SceneGenerator generator(options.sceneSeed);
+        SceneGenerator::Scene scene = generator.Generate(
+                options.iSceneTreeCount >= 0 ? options.iSceneTreeCount : 100,
+                options.iSceneBuildingCount >= 0 ? options.iSceneBuildingCount : 1, options.fTreeDensity,
+                glm::vec2(Renderer::g_fParthenonWidth, Renderer::g_fParthenonLength));
+        renderer.useGeneratedScene(scene);
+        LOG_INFO("Generated scene: {} trees, {} Parthenons on {} x {} units (seed {})", scene.trees.size(),
+                 scene.buildings.size(), scene.fTerrainSize, scene.fTerrainSize, options.sceneSeed);
+    }
+
+    // Capture the tree sprites used for distant trees
+    renderer.bakeTreeImpostors(window);
+
     // Set initial positions
     renderer.modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
 
@@ -1278,30 +1530,75 @@ int main() {
     // Set the resize callback
     glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
+    // Log or replay input through the callbacks just set
+    g_inputLog.Attach(window);
+
+    // Start from the framebuffer actually created, which need not be the default window size
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glfw_framebuffer_size_callback(window, framebufferWidth, framebufferHeight);
+
+    // Only redraw when something changed, unless asked to render continuously
+    g_frameScheduler.SetMode(options.bContinuousRendering ? FrameScheduler::Mode::CONTINUOUS
+                                                          : FrameScheduler::Mode::ON_DEMAND);
+    g_frameScheduler.Attach(window);
+
+    // Pace presentation with vsync, a frame-rate cap, or not at all
+    FramePacer framePacer(options.framePacing, options.fTargetFps);
+    framePacer.Apply();
+
+    // Every frame time of a continuous run, for the percentile report and the baseline gate
+    FrameTimeHistogram frameTimes;
+
     // Render loop
     while (!glfwWindowShouldClose(window)) {
+        // Process events, sleeping until a frame is needed
+        if (!g_frameScheduler.WaitForFrame())
+            continue;
+        PROFILE_SCOPE("Frame");
+
+        // Feed back recorded input and step the session clock
+        g_inputLog.BeginFrame(window);
+
         // Process input
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
 
-        // Check if re-render is needed
-        if (renderer.resizeFlag) {
-            renderer.perform_render_sequence(window);
-            renderer.resizeFlag = false; // Reset the flag
-        }
+        // The path advances by a fixed timestep per frame, however long the frame took
+        if (!cameraPath.IsEmpty())
+            cameraPath.Evaluate(static_cast<double>(ixPathFrame++) * options.fTimestep, Renderer::g_cameraTarget,
+                                Renderer::g_sphereCameraRelativePosition);
 
+        g_renderStats.BeginFrame();
+        backend.BeginFrame();
         renderer.perform_render_sequence(window);
 
-        // Swap front and back buffers
-        glfwSwapBuffers(window);
+        g_renderStats.EndFrame();
 
-        // Poll for and process events
-        glfwPollEvents();
+        // Swap front and back buffers (or finish the offscreen frame)
+        framePacer.WaitForNextFrame();
+        backend.PresentFrame(window);
+
+        // On-demand frames are spaced by input rather than by rendering, so only time continuous runs
+        if (g_frameScheduler.GetMode() == FrameScheduler::Mode::CONTINUOUS)
+            frameTimes.RecordFrame();
     }
 
+    g_inputLog.Finish();
+    int exitCode = finishFrameTimeReport(frameTimes, options);
+
+    // The GPU timer report goes straight to stdout, after whatever was logged before it
+    Logger::Get().Flush();
+    if (renderer.gpuTimer.IsEnabled())
+        renderer.gpuTimer.PrintReport(std::cout);
+    if (!options.tracePath.empty())
+        Profiler::Get().WriteChromeTrace();
+    if (!options.statsPath.empty())
+        g_renderStats.WriteFile(options.statsPath);
+
     // Terminate GLFW
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
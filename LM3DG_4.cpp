@@ -1,10 +1,19 @@
 // --- Quaternions --- \\
 
 #include "libraries/glew-2.1.0/include/GL/glew.h"
+#include "gl_dispatch.cpp"
+#include "profiler.cpp"
+#include "logger.cpp"
 #include "libraries/glfw-master/include/GLFW/glfw3.h"
 #include "libraries/glm-master/glm/glm.hpp"
 #include "libraries/glm-master/glm/ext.hpp"
 #include "xmlparser.cpp"
+#include "frame_scheduler.cpp"
+#include "frame_pacer.cpp"
+#include "render_backend.cpp"
+#include "frame_histogram.cpp"
+#include "input_log.cpp"
+#include "launch_options.cpp"
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -35,9 +44,14 @@ glm::fquat g_orientation(1.0f, 0.0f, 0.0f, 0.0f);
 
 #define SMALL_ANGLE_INCREMENT 15.0f
 
-GLFWwindow* initializeGLFW() {
+// Decides when the render loop redraws
+FrameScheduler g_frameScheduler;
+
+GLFWwindow* initializeGLFW(const RenderBackend& backend) {
+    backend.SetInitHints();
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        LOG_ERROR("Failed to initialize GLFW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 
@@ -47,12 +61,16 @@ GLFWwindow* initializeGLFW() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
+    // Headless backends create an invisible window on GLFW's null platform
+    backend.SetWindowHints();
+
     // Create a windowed mode window and its OpenGL context
-    GLFWwindow* window = glfwCreateWindow(static_cast<int>(WINDOW_WIDTH), static_cast<int>(WINDOW_HEIGHT),
+    GLFWwindow* window = glfwCreateWindow(backend.GetWidth(WINDOW_WIDTH), backend.GetHeight(WINDOW_HEIGHT),
                                           "Getting the hang...", nullptr, nullptr);
 
     if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
+        Logger::Get().Flush();
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
@@ -71,8 +89,11 @@ GLFWwindow* initializeGLFW() {
 void initializeGLEW() {
     glewExperimental = GL_TRUE;
 
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW" << std::endl;
+    // A headless EGL context has no GLX display, but the GL functions are loaded regardless
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
+        LOG_ERROR("Failed to initialize GLEW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 }
@@ -178,7 +199,6 @@ public:
         glBindVertexArray(0);
     }
 
-    bool resizeFlag = false;
     void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
         // Update viewport dimensions on window resize
         glUseProgram(data.shaderProgram);
@@ -187,7 +207,6 @@ public:
         glViewport(0, 0, width, height);
         glUniform1i(windowWidthLocation, width);
         glUniform1i(windowHeightLocation, height);
-        resizeFlag = true;
     }
 
     void set_shader_sources() {
@@ -256,7 +275,7 @@ public:
 
             // Output or log the error information
             std::string shader_name = get_shader_label(shader);
-            std::cerr << shader_name << " compilation error; deleting shader...:\n" << infoLog << std::endl;
+            LOG_ERROR("{} compilation error; deleting shader...:\n{}", shader_name, infoLog);
 
             delete[] infoLog;
 
@@ -270,6 +289,7 @@ public:
     }
 
     void compile_and_link_shaders() {
+        PROFILE_FUNCTION();
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glObjectLabel(GL_SHADER, vertexShader, -1, "Vertex Shader");
         glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
@@ -294,12 +314,13 @@ public:
 
             auto* strInfoLog = new GLchar[infoLogLength + 1];
             glGetProgramInfoLog(data.shaderProgram, infoLogLength, nullptr, strInfoLog);
-            std::cerr << "Linker failure: \n" << strInfoLog;
+            LOG_ERROR("Linker failure: \n{}", strInfoLog);
             delete[] strInfoLog;
         }
     }
 
     void create_and_link_program() {
+        PROFILE_FUNCTION();
         data.shaderProgram = glCreateProgram();
 
         for (GLuint shader : shaders) {
@@ -335,6 +356,7 @@ public:
     }
 
     void perform_render_sequence(GLFWwindow* window) {
+        PROFILE_FUNCTION();
         // Clear the color and depth buffers
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -380,6 +402,12 @@ public:
 
     // GLFW key callback function
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        g_frameScheduler.MarkDirty();
+
+        // Dump the profiler trace
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+            Profiler::Get().WriteChromeTrace();
+
         if (action == GLFW_PRESS) {
 
             switch (key) {
@@ -415,7 +443,7 @@ public:
                 }
                 case GLFW_KEY_SPACE: {
                     g_bRightMultiply = !g_bRightMultiply;
-                    printf(g_bRightMultiply ? "Right-multiply\n" : "Left-multiply\n");
+                    LOG_INFO("{}", g_bRightMultiply ? "Right-multiply" : "Left-multiply");
                     break;
                 }
                 default:
@@ -443,6 +471,8 @@ bool Renderer::g_bRightMultiply = true;
 
 // GLFW requires a static or non-member function for the framebuffer size callback
 void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    g_frameScheduler.MarkDirty();
+
     // Retrieve the Renderer instance associated with the window
     auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
 
@@ -452,9 +482,26 @@ void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     }
 }
 
-int main() {
-    GLFWwindow* window = initializeGLFW();
+int main(int argc, char* argv[]) {
+    LaunchOptions options = parseLaunchOptions(argc, argv);
+    Profiler::Get().SetThreadName("Main");
+    if (!options.tracePath.empty())
+        Profiler::Get().SetTracePath(options.tracePath);
+
+    // Record this session's input, or replay a recorded one
+    if (!options.recordInputPath.empty() && !g_inputLog.StartRecording(options.recordInputPath))
+        return 1;
+    if (!options.replayInputPath.empty()) {
+        if (!g_inputLog.StartReplay(options.replayInputPath))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = g_inputLog.GetReplayFrameCount();
+    }
+
+    RenderBackend backend(options);
+    GLFWwindow* window = initializeGLFW(backend);
     initializeGLEW();
+    backend.Create(window);
 
     Renderer renderer = Renderer();
     renderer.set_shader_sources();
@@ -482,7 +529,7 @@ int main() {
     glUniform1i(windowHeightLocation, WINDOW_HEIGHT);
 
     // Create plane and gimbals
-    std::cout << "Creating ship..." << "\n";
+    LOG_INFO("Creating ship...");
     renderer.createShip();
 
     // Set initial positions
@@ -497,6 +544,23 @@ int main() {
     // Set the resize callback
     glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
+    // Log or replay input through the callbacks just set
+    g_inputLog.Attach(window);
+
+    // Start from the framebuffer actually created, which need not be the default window size
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glfw_framebuffer_size_callback(window, framebufferWidth, framebufferHeight);
+
+    // Only redraw when something changed, unless asked to render continuously
+    g_frameScheduler.SetMode(options.bContinuousRendering ? FrameScheduler::Mode::CONTINUOUS
+                                                          : FrameScheduler::Mode::ON_DEMAND);
+    g_frameScheduler.Attach(window);
+
+    // Pace presentation with vsync, a frame-rate cap, or not at all
+    FramePacer framePacer(options.framePacing, options.fTargetFps);
+    framePacer.Apply();
+
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CW);
@@ -506,30 +570,44 @@ int main() {
     glDepthFunc(GL_LEQUAL);
     glDepthRange(0.0f, 1.0f);
 
+    // Every frame time of a continuous run, for the percentile report and the baseline gate
+    FrameTimeHistogram frameTimes;
+
     // Render loop
     while (!glfwWindowShouldClose(window)) {
+        // Process events, sleeping until a frame is needed
+        if (!g_frameScheduler.WaitForFrame())
+            continue;
+        PROFILE_SCOPE("Frame");
+
+        // Feed back recorded input and step the session clock
+        g_inputLog.BeginFrame(window);
+
         // Process input
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
 
-        // Check if re-render is needed
-        if (renderer.resizeFlag) {
-            renderer.perform_render_sequence(window);
-            renderer.resizeFlag = false; // Reset the flag
-        }
-
+        backend.BeginFrame();
         renderer.perform_render_sequence(window);
 
-        // Swap front and back buffers
-        glfwSwapBuffers(window);
+        // Swap front and back buffers (or finish the offscreen frame)
+        framePacer.WaitForNextFrame();
+        backend.PresentFrame(window);
 
-        // Poll for and process events
-        glfwPollEvents();
+        // On-demand frames are spaced by input rather than by rendering, so only time continuous runs
+        if (g_frameScheduler.GetMode() == FrameScheduler::Mode::CONTINUOUS)
+            frameTimes.RecordFrame();
     }
 
+    g_inputLog.Finish();
+    int exitCode = finishFrameTimeReport(frameTimes, options);
+
+    if (!options.tracePath.empty())
+        Profiler::Get().WriteChromeTrace();
+
     // Terminate GLFW
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
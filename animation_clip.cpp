@@ -0,0 +1,241 @@
+// --- Keyframed animation clip --- \\
+
+#include "animation_clip.h"
+#include "logger.h"
+#include "quat_batch.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // quat or -quat, whichever is in the same hemisphere as reference
+    glm::fquat alignTo(const glm::fquat& reference, const glm::fquat& quat) {
+        return glm::dot(reference, quat) < 0.0f ? -quat : quat;
+    }
+
+    // Slerp without the shortest-arc flip; the keys are aligned before they get here.
+    glm::fquat slerpUnflipped(const glm::fquat& from, const glm::fquat& to, float alpha) {
+        const float cosTheta = std::clamp(glm::dot(from, to), -1.0f, 1.0f);
+        if (std::fabs(cosTheta) > 0.9995f)
+            return glm::normalize(from * (1.0f - alpha) + to * alpha);
+        const float theta = std::acos(cosTheta);
+        const float sinTheta = std::sin(theta);
+        return from * (std::sin((1.0f - alpha) * theta) / sinTheta) + to * (std::sin(alpha * theta) / sinTheta);
+    }
+
+    bool parseChannel(const std::string& text, AnimationClip::Channel& channel) {
+        if (text == "orientation")
+            channel = AnimationClip::Channel::ORIENTATION;
+        else if (text == "translation")
+            channel = AnimationClip::Channel::TRANSLATION;
+        else
+            return false;
+        return true;
+    }
+
+    bool parseInterpolation(const std::string& text, AnimationClip::Interpolation& interpolation) {
+        if (text == "step")
+            interpolation = AnimationClip::Interpolation::STEP;
+        else if (text == "lerp")
+            interpolation = AnimationClip::Interpolation::LERP;
+        else if (text == "slerp")
+            interpolation = AnimationClip::Interpolation::SLERP;
+        else if (text == "squad")
+            interpolation = AnimationClip::Interpolation::SQUAD;
+        else
+            return false;
+        return true;
+    }
+}
+
+bool AnimationClip::Load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("Failed to open animation clip: {}", path);
+        return false;
+    }
+
+    AnimationClip clip;
+    std::string line;
+    for (int iLine = 1; std::getline(file, line); iLine++) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream fields(line);
+        std::string keyword;
+        fields >> keyword;
+        if (keyword == "track") {
+            std::string channel, interpolation;
+            Track track{};
+            fields >> track.name >> channel >> interpolation;
+            if (fields.fail() || !parseChannel(channel, track.channel) ||
+                !parseInterpolation(interpolation, track.interpolation)) {
+                LOG_ERROR("{}:{}: expected track name, orientation or translation, and step, lerp, slerp or squad",
+                          path, iLine);
+                return false;
+            }
+            if (track.channel == Channel::TRANSLATION && (track.interpolation == Interpolation::SLERP ||
+                                                          track.interpolation == Interpolation::SQUAD)) {
+                LOG_ERROR("{}:{}: {} needs an orientation track", path, iLine, interpolation);
+                return false;
+            }
+            if (!clip.m_tracks.empty() && clip.m_tracks.back().keyCount == 0) {
+                LOG_ERROR("{}:{}: track {} has no keys", path, iLine, clip.m_tracks.back().name);
+                return false;
+            }
+            track.ixFirstKey = static_cast<std::uint32_t>(clip.m_keyTimes.size());
+            track.ixFirstValue = static_cast<std::uint32_t>(track.channel == Channel::ORIENTATION
+                                                            ? clip.m_orientationKeys.size()
+                                                            : clip.m_translationKeys.size());
+            clip.m_tracks.push_back(track);
+            continue;
+        }
+
+        if (clip.m_tracks.empty()) {
+            LOG_ERROR("{}:{}: keys must follow a track line", path, iLine);
+            return false;
+        }
+        Track& track = clip.m_tracks.back();
+        fields.clear();
+        fields.seekg(0);
+        float time = 0.0f;
+        glm::fquat orientation(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 translation(0.0f);
+        fields >> time;
+        if (track.channel == Channel::ORIENTATION)
+            fields >> orientation.w >> orientation.x >> orientation.y >> orientation.z;
+        else
+            fields >> translation.x >> translation.y >> translation.z;
+        if (fields.fail()) {
+            LOG_ERROR("{}:{}: expected time and {}", path, iLine,
+                      track.channel == Channel::ORIENTATION ? "w x y z" : "x y z");
+            return false;
+        }
+        if (track.keyCount > 0 && time <= clip.m_keyTimes.back()) {
+            LOG_ERROR("{}:{}: key times must increase", path, iLine);
+            return false;
+        }
+
+        clip.m_keyTimes.push_back(time);
+        if (track.channel == Channel::ORIENTATION) {
+            if (glm::dot(orientation, orientation) < 1e-12f) {
+                LOG_ERROR("{}:{}: orientation has zero length", path, iLine);
+                return false;
+            }
+            clip.m_orientationKeys.push_back(encodeQuat48(orientation));
+        }
+        else {
+            clip.m_translationKeys.push_back(translation);
+        }
+        track.keyCount++;
+        clip.m_fDuration = std::max(clip.m_fDuration, time);
+    }
+
+    if (clip.m_tracks.empty() || clip.m_tracks.back().keyCount == 0) {
+        LOG_ERROR("Animation clip has no keys: {}", path);
+        return false;
+    }
+
+    // Squad's control points, from the keys as sampling will see them; the end keys stand in for
+    // their missing neighbours.
+    clip.m_orientationControls.resize(clip.m_orientationKeys.size());
+    for (const Track& track : clip.m_tracks) {
+        if (track.channel != Channel::ORIENTATION)
+            continue;
+        const PackedQuat48* keys = &clip.m_orientationKeys[track.ixFirstValue];
+        const size_t ixLast = track.keyCount - 1;
+        for (size_t ixKey = 0; ixKey <= ixLast; ixKey++) {
+            const glm::fquat control = squadControl(decodeQuat48(keys[ixKey > 0 ? ixKey - 1 : 0]),
+                                                    decodeQuat48(keys[ixKey]),
+                                                    decodeQuat48(keys[std::min(ixKey + 1, ixLast)]));
+            clip.m_orientationControls[track.ixFirstValue + ixKey] = encodeQuat48(control);
+        }
+    }
+    *this = std::move(clip);
+    return true;
+}
+
+int AnimationClip::FindTrack(const std::string& name, Channel channel) const {
+    for (size_t ixTrack = 0; ixTrack < m_tracks.size(); ixTrack++) {
+        if (m_tracks[ixTrack].channel == channel && m_tracks[ixTrack].name == name)
+            return static_cast<int>(ixTrack);
+    }
+    return -1;
+}
+
+int AnimationClip::FindTrack(Channel channel) const {
+    for (size_t ixTrack = 0; ixTrack < m_tracks.size(); ixTrack++) {
+        if (m_tracks[ixTrack].channel == channel)
+            return static_cast<int>(ixTrack);
+    }
+    return -1;
+}
+
+size_t AnimationClip::FindKey(const Track& track, float time, Cursor& cursor) const {
+    const float* times = &m_keyTimes[track.ixFirstKey];
+    const size_t ixLastSegment = track.keyCount - 2;
+
+    // Playback stays in the cursor's segment or moves on to the next.
+    size_t ix = std::min<size_t>(cursor.ixKey, ixLastSegment);
+    if (time >= times[ix]) {
+        if (time < times[ix + 1])
+            return ix;
+        if (ix < ixLastSegment && time < times[ix + 2]) {
+            cursor.ixKey = static_cast<std::uint32_t>(ix + 1);
+            return ix + 1;
+        }
+    }
+
+    ix = static_cast<size_t>(std::upper_bound(times, times + track.keyCount, time) - times) - 1;
+    cursor.ixKey = static_cast<std::uint32_t>(ix);
+    return ix;
+}
+
+glm::fquat AnimationClip::SampleOrientation(int ixTrack, float time, Cursor& cursor) const {
+    const Track& track = m_tracks[ixTrack];
+    const float* times = &m_keyTimes[track.ixFirstKey];
+    const PackedQuat48* keys = &m_orientationKeys[track.ixFirstValue];
+    const size_t ixLast = track.keyCount - 1;
+    if (ixLast == 0 || time <= times[0])
+        return decodeQuat48(keys[0]);
+    if (time >= times[ixLast])
+        return decodeQuat48(keys[ixLast]);
+
+    const size_t ix = FindKey(track, time, cursor);
+    const float u = (time - times[ix]) / (times[ix + 1] - times[ix]);
+    const glm::fquat start = decodeQuat48(keys[ix]);
+    if (track.interpolation == Interpolation::STEP)
+        return start;
+    const glm::fquat end = alignTo(start, decodeQuat48(keys[ix + 1]));
+    switch (track.interpolation) {
+        case Interpolation::LERP:
+            return glm::normalize(start * (1.0f - u) + end * u);
+        case Interpolation::SLERP:
+            return slerpUnflipped(start, end, u);
+        case Interpolation::SQUAD: {
+            const PackedQuat48* controls = &m_orientationControls[track.ixFirstValue];
+            return squad(start, end, decodeQuat48(controls[ix]), decodeQuat48(controls[ix + 1]), u);
+        }
+        default:
+            return start;
+    }
+}
+
+glm::vec3 AnimationClip::SampleTranslation(int ixTrack, float time, Cursor& cursor) const {
+    const Track& track = m_tracks[ixTrack];
+    const float* times = &m_keyTimes[track.ixFirstKey];
+    const glm::vec3* keys = &m_translationKeys[track.ixFirstValue];
+    const size_t ixLast = track.keyCount - 1;
+    if (ixLast == 0 || time <= times[0])
+        return keys[0];
+    if (time >= times[ixLast])
+        return keys[ixLast];
+
+    const size_t ix = FindKey(track, time, cursor);
+    if (track.interpolation == Interpolation::STEP)
+        return keys[ix];
+    const float u = (time - times[ix]) / (times[ix + 1] - times[ix]);
+    return keys[ix] + (keys[ix + 1] - keys[ix]) * u;
+}
@@ -0,0 +1,87 @@
+// --- Declares the keyframed animation clip --- \\
+
+#ifndef CLIONPROJECTS_ANIMATION_CLIP_H
+#define CLIONPROJECTS_ANIMATION_CLIP_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "quat_codec.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A set of keyframed tracks, each animating one orientation or one translation, and each with its
+// own interpolation. A track holds its first and last keys outside their times.
+//
+// Keys are stored compactly: every track's key times back to back in one float array, and every
+// track's values back to back in one array per channel, with a track being just a range in each.
+// Orientations are packed into 6 bytes (PackedQuat48, within 0.009 degrees) and translations take
+// 12. Sampling decodes the keys it needs and negates any that are in the opposite hemisphere to
+// their neighbour, so that every interpolation takes the shorter way from key to key. Squad's
+// control point at each orientation key is worked out once, on loading, and packed alongside it.
+//
+// Sampling goes through a Cursor, which remembers the segment it last found: sampling at the same
+// or a slightly later time (playback, frame by frame) finds its segment in constant time, and only
+// a jump falls back to a binary search. A cursor belongs to one track of one object.
+//
+// Clip files are plain text, '#' starting a comment. Each track starts with a header line
+//     track  name  orientation|translation  step|lerp|slerp|squad
+// followed by its keys, one per line, with times in seconds and strictly increasing:
+//     time  w x y z    (orientation)
+//     time  x y z      (translation)
+// Slerp and squad apply only to orientations; lerp on an orientation track is nlerp.
+class AnimationClip {
+public:
+    enum class Channel {
+        ORIENTATION,
+        TRANSLATION
+    };
+
+    enum class Interpolation {
+        STEP, // Hold each key until the next
+        LERP,
+        SLERP,
+        SQUAD // Spherical cubic through the keys, with a continuous angular velocity at each (see batchSquad)
+    };
+
+    struct Track {
+        std::string name;
+        Channel channel;
+        Interpolation interpolation;
+        // The track's keys are m_keyTimes[ixFirstKey...] and its channel's values[ixFirstValue...]
+        std::uint32_t ixFirstKey;
+        std::uint32_t ixFirstValue;
+        std::uint32_t keyCount;
+    };
+
+    struct Cursor {
+        // Index within the track of the key starting the segment last sampled
+        std::uint32_t ixKey = 0;
+    };
+
+    bool Load(const std::string& path);
+
+    [[nodiscard]] bool IsEmpty() const {return m_tracks.empty();}
+    [[nodiscard]] const std::vector<Track>& GetTracks() const {return m_tracks;}
+    // Index of the first track with this name and channel, or -1
+    [[nodiscard]] int FindTrack(const std::string& name, Channel channel) const;
+    // Index of the first track on this channel, or -1
+    [[nodiscard]] int FindTrack(Channel channel) const;
+    // Time of the last key of any track
+    [[nodiscard]] float GetDuration() const {return m_fDuration;}
+
+    [[nodiscard]] glm::fquat SampleOrientation(int ixTrack, float time, Cursor& cursor) const;
+    [[nodiscard]] glm::vec3 SampleTranslation(int ixTrack, float time, Cursor& cursor) const;
+
+private:
+    // The key starting the segment that contains time, which must lie strictly inside the track
+    size_t FindKey(const Track& track, float time, Cursor& cursor) const;
+
+    std::vector<Track> m_tracks;
+    std::vector<float> m_keyTimes;
+    std::vector<PackedQuat48> m_orientationKeys;
+    std::vector<PackedQuat48> m_orientationControls;
+    std::vector<glm::vec3> m_translationKeys;
+    float m_fDuration = 0.0f;
+};
+
+#endif // CLIONPROJECTS_ANIMATION_CLIP_H
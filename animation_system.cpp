@@ -0,0 +1,265 @@
+// --- Batched orientation animation system --- \\
+
+#include "animation_system.h"
+#include "profiler.h"
+#include <algorithm>
+
+AnimationSystem g_animationSystem;
+
+AnimationSystem::~AnimationSystem() {
+    StopWorkers();
+}
+
+AnimationSystem::Handle AnimationSystem::Add(const glm::fquat& orientation) {
+    const size_t ix = Size();
+    for (QuatArray* quats : {&m_start, &m_target, &m_current}) {
+        quats->Resize(ix + 1);
+        quats->Set(ix, orientation);
+    }
+    m_startTime.emplace_back();
+    m_invDuration.push_back(0.0);
+    m_finishTime.emplace_back();
+    m_bAnimating.push_back(0);
+    m_alpha.push_back(0.0f);
+    m_bChanged.push_back(0);
+    MarkChanged(static_cast<Handle>(ix));
+    return static_cast<Handle>(ix);
+}
+
+void AnimationSystem::Reserve(size_t count) {
+    for (QuatArray* quats : {&m_start, &m_target, &m_current}) {
+        for (std::vector<float>* component : {&quats->w, &quats->x, &quats->y, &quats->z})
+            component->reserve(count);
+    }
+    m_startTime.reserve(count);
+    m_invDuration.reserve(count);
+    m_finishTime.reserve(count);
+    m_bAnimating.reserve(count);
+    m_alpha.reserve(count);
+    m_bChanged.reserve(count);
+}
+
+void AnimationSystem::AnimateTo(Handle handle, const glm::fquat& target, FrameClock::Duration duration,
+                                FrameClock::TimePoint startTime) {
+    const bool bWasAnimating = m_bAnimating[handle] != 0;
+    const bool bAnimating = duration > FrameClock::Duration::zero();
+
+    m_start.Set(handle, bAnimating ? GetOrientation(handle) : target);
+    m_target.Set(handle, target);
+    m_startTime[handle] = startTime;
+    m_invDuration[handle] = bAnimating ? 1.0 / static_cast<double>(duration.count()) : 0.0;
+    m_finishTime[handle] = startTime + duration;
+    m_bAnimating[handle] = bAnimating ? 1 : 0;
+    if (!bAnimating)
+        m_current.Set(handle, target);
+    else
+        m_nextFinishTime = std::min(m_nextFinishTime, m_finishTime[handle]);
+    MarkChanged(handle);
+
+    if (bAnimating && !bWasAnimating)
+        m_animatingCount++;
+    else if (!bAnimating && bWasAnimating)
+        m_animatingCount--;
+}
+
+void AnimationSystem::SetOrientations(const QuatArray& orientations) {
+    m_start = orientations;
+    m_target = orientations;
+    m_current = orientations;
+    std::fill(m_bAnimating.begin(), m_bAnimating.end(), 0);
+    std::fill(m_invDuration.begin(), m_invDuration.end(), 0.0);
+    m_animatingCount = 0;
+    m_nextFinishTime = FrameClock::TimePoint::max();
+    ClearChanged();
+    m_bAllChanged = true;
+}
+
+glm::fquat AnimationSystem::GetOrientation(Handle handle) const {
+    if (!m_bDeferInterpolation || m_bAnimating[handle] == 0)
+        return m_current.Get(handle);
+
+    // As UpdateBand() would have it, one object on its own
+    const double fProgress = static_cast<double>((m_now - m_startTime[handle]).count()) * m_invDuration[handle];
+    const auto alpha = static_cast<float>(std::clamp(fProgress, 0.0, 1.0));
+    const glm::fquat start = m_start.Get(handle);
+    const glm::fquat target = m_target.Get(handle);
+    switch (m_interpolation) {
+        case Interpolation::NLERP: {
+            const glm::fquat to = glm::dot(start, target) < 0.0f ? -target : target;
+            return glm::normalize(start * (1.0f - alpha) + to * alpha);
+        }
+        case Interpolation::SLERP:
+            return glm::slerp(start, target, alpha);
+        case Interpolation::FAST_SLERP:
+            return fastSlerp(start, target, alpha);
+    }
+    return start;
+}
+
+void AnimationSystem::SetDeferInterpolation(bool bDefer) {
+    m_bDeferInterpolation = bDefer;
+    // Retire whatever finished while the flag was off at the next Update()
+    m_nextFinishTime = FrameClock::TimePoint::min();
+}
+
+void AnimationSystem::MarkChanged(Handle handle) {
+    if (m_bChanged[handle] != 0)
+        return;
+    m_bChanged[handle] = 1;
+    m_changed.push_back(handle);
+}
+
+void AnimationSystem::ClearChanged() {
+    for (Handle handle : m_changed)
+        m_bChanged[handle] = 0;
+    m_changed.clear();
+    m_bAllChanged = false;
+}
+
+void AnimationSystem::Update(FrameClock::TimePoint now) {
+    PROFILE_FUNCTION();
+    m_now = now;
+    // Objects at rest already hold their orientation.
+    if (m_animatingCount == 0)
+        return;
+    if (m_bDeferInterpolation) {
+        RetireFinished(now);
+        return;
+    }
+
+    const size_t count = Size();
+    const int bandCount = count < g_iMinParallelCount ? 1 : m_bandCount;
+    // Whole multiples of 16 floats, so the bands do not share SIMD registers or cache lines
+    m_bandSize = ((count + bandCount - 1) / bandCount + 15) & ~static_cast<size_t>(15);
+    m_bandFinished.assign(bandCount, 0);
+
+    if (bandCount == 1) {
+        m_bandFinished[0] = UpdateBand(0);
+    }
+    else {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingBands = bandCount - 1;
+            m_generation++;
+        }
+        m_startCondition.notify_all();
+
+        // The calling thread takes the first band itself.
+        m_bandFinished[0] = UpdateBand(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] {return m_pendingBands == 0;});
+    }
+
+    for (size_t finished : m_bandFinished)
+        m_animatingCount -= finished;
+}
+
+size_t AnimationSystem::UpdateBand(int ixBand) {
+    PROFILE_FUNCTION();
+    const size_t count = Size();
+    const size_t ixBegin = std::min(static_cast<size_t>(ixBand) * m_bandSize, count);
+    const size_t ixEnd = std::min(ixBegin + m_bandSize, count);
+
+    // Progress through each animation; one that has run its length comes to rest on its target,
+    // and everything at rest interpolates with alpha 0, which leaves it at its start.
+    size_t finished = 0;
+    for (size_t ix = ixBegin; ix < ixEnd; ix++) {
+        if (m_bAnimating[ix] == 0) {
+            m_alpha[ix] = 0.0f;
+            continue;
+        }
+        const double fProgress = static_cast<double>((m_now - m_startTime[ix]).count()) * m_invDuration[ix];
+        if (fProgress >= 1.0) {
+            m_start.Set(ix, m_target.Get(ix));
+            m_invDuration[ix] = 0.0;
+            m_bAnimating[ix] = 0;
+            m_alpha[ix] = 0.0f;
+            finished++;
+        }
+        else {
+            m_alpha[ix] = static_cast<float>(std::max(fProgress, 0.0));
+        }
+    }
+
+    switch (m_interpolation) {
+        case Interpolation::NLERP:
+            batchNlerp(m_start, m_target, m_alpha.data(), m_current, ixBegin, ixEnd);
+            break;
+        case Interpolation::SLERP:
+            batchSlerp(m_start, m_target, m_alpha.data(), m_current, ixBegin, ixEnd);
+            break;
+        case Interpolation::FAST_SLERP:
+            batchFastSlerp(m_start, m_target, m_alpha.data(), m_current, ixBegin, ixEnd);
+            break;
+    }
+    return finished;
+}
+
+void AnimationSystem::RetireFinished(FrameClock::TimePoint now) {
+    if (now < m_nextFinishTime)
+        return;
+
+    m_nextFinishTime = FrameClock::TimePoint::max();
+    for (size_t ix = 0; ix < Size(); ix++) {
+        if (m_bAnimating[ix] == 0)
+            continue;
+        if (now < m_finishTime[ix]) {
+            m_nextFinishTime = std::min(m_nextFinishTime, m_finishTime[ix]);
+            continue;
+        }
+        // Whoever interpolates for us clamps at the target, so this need not reach them.
+        m_start.Set(ix, m_target.Get(ix));
+        m_current.Set(ix, m_target.Get(ix));
+        m_invDuration[ix] = 0.0;
+        m_bAnimating[ix] = 0;
+        m_animatingCount--;
+    }
+}
+
+void AnimationSystem::SetThreadCount(int threadCount) {
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1u, 4u));
+    if (threadCount == m_bandCount)
+        return;
+
+    StopWorkers();
+    m_bandCount = threadCount;
+    for (int ixWorker = 1; ixWorker < m_bandCount; ixWorker++) {
+        m_workers.emplace_back(&AnimationSystem::WorkerLoop, this, ixWorker, m_generation);
+    }
+}
+
+void AnimationSystem::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bShutdown = true;
+    }
+    m_startCondition.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_bShutdown = false;
+}
+
+void AnimationSystem::WorkerLoop(int ixWorker, unsigned long lastGeneration) {
+    Profiler::Get().SetThreadName("Animation worker");
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [&] {return m_bShutdown || m_generation != lastGeneration;});
+            if (m_bShutdown)
+                return;
+            lastGeneration = m_generation;
+        }
+
+        m_bandFinished[ixWorker] = UpdateBand(ixWorker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingBands--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,148 @@
+// --- Declares the batched orientation animation system --- \\
+
+#ifndef CLIONPROJECTS_ANIMATION_SYSTEM_H
+#define CLIONPROJECTS_ANIMATION_SYSTEM_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "frame_clock.h"
+#include "quat_batch.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Animates the orientations of any number of objects, each independently of the others: every
+// object has its own start and target orientation, start time and duration. The state is kept
+// structure-of-arrays, so Update() works out every object's progress and interpolates all of them
+// in one pass through the batched quaternion kernels, optionally split across worker threads.
+//
+// Objects are added and never removed; a handle is the object's index into the arrays.
+//
+// With interpolation deferred, Update() leaves the interpolating to whoever draws the objects (the
+// ships' vertex shader, say), which keeps its own copy of each object's animation: Update() only
+// retires finished animations, and returns at once while none is due to finish. The system lists
+// the objects whose animation has been set since the copy was last brought up to date.
+class AnimationSystem {
+public:
+    using Handle = std::uint32_t;
+
+    enum class Interpolation {
+        NLERP, // Lerp then normalise
+        SLERP,
+        FAST_SLERP // Slerp from the polynomial weights (see fastSlerp)
+    };
+
+    AnimationSystem() = default;
+    ~AnimationSystem();
+
+    AnimationSystem(const AnimationSystem&) = delete;
+    AnimationSystem& operator=(const AnimationSystem&) = delete;
+
+    // Adds an object resting at orientation.
+    Handle Add(const glm::fquat& orientation);
+    void Reserve(size_t count);
+    [[nodiscard]] size_t Size() const {return m_current.Size();}
+
+    // Turns the object from its current orientation (part way through another animation, if it
+    // is in one) to target, over duration from startTime. A zero duration jumps straight there.
+    void AnimateTo(Handle handle, const glm::fquat& target, FrameClock::Duration duration,
+                   FrameClock::TimePoint startTime);
+
+    // Jumps every object straight to its orientation in orientations, which holds one per object in
+    // handle order, ending every animation: for objects posed elsewhere all at once.
+    void SetOrientations(const QuatArray& orientations);
+
+    // Advances every animation to now; objects that reach their target come to rest on it. Call
+    // once per frame, before reading orientations.
+    void Update(FrameClock::TimePoint now);
+
+    // As of the last Update(). With interpolation deferred GetOrientation() works out the object's
+    // orientation on the spot, and GetOrientations() is only current for objects at rest.
+    [[nodiscard]] glm::fquat GetOrientation(Handle handle) const;
+    [[nodiscard]] const QuatArray& GetOrientations() const {return m_current;}
+    [[nodiscard]] bool IsAnimating(Handle handle) const {return m_bAnimating[handle] != 0;}
+    [[nodiscard]] size_t GetAnimatingCount() const {return m_animatingCount;}
+
+    void SetInterpolation(Interpolation interpolation) {m_interpolation = interpolation;}
+    [[nodiscard]] Interpolation GetInterpolation() const {return m_interpolation;}
+
+    // Skips interpolation in Update() (see above). Turning it off again interpolates from the next
+    // Update() on.
+    void SetDeferInterpolation(bool bDefer);
+    [[nodiscard]] bool IsDeferringInterpolation() const {return m_bDeferInterpolation;}
+
+    // Per object: the current animation's start and target orientations, and its start time and
+    // 1 / its length in nanoseconds, 0 for an object at rest (which sits at its start).
+    [[nodiscard]] const QuatArray& GetStartOrientations() const {return m_start;}
+    [[nodiscard]] const QuatArray& GetTargetOrientations() const {return m_target;}
+    [[nodiscard]] FrameClock::TimePoint GetStartTime(Handle handle) const {return m_startTime[handle];}
+    [[nodiscard]] double GetInvDuration(Handle handle) const {return m_invDuration[handle];}
+
+    // The objects whose animation Add() or AnimateTo() has set since the last ClearChanged(), each
+    // listed once; after SetOrientations() every object has changed and the list is left empty.
+    // An animation coming to an end on its own is not a change.
+    [[nodiscard]] const std::vector<Handle>& GetChanged() const {return m_changed;}
+    [[nodiscard]] bool IsAllChanged() const {return m_bAllChanged;}
+    void ClearChanged();
+
+    // Splits Update() across this many threads, the calling one included; 0 uses one per core, up
+    // to 4. Passes over fewer than g_iMinParallelCount objects stay on the calling thread.
+    void SetThreadCount(int threadCount);
+    [[nodiscard]] int GetThreadCount() const {return m_bandCount;}
+
+    static constexpr size_t g_iMinParallelCount = 4096;
+
+private:
+    // Updates one thread's share of the objects; returns how many finished.
+    size_t UpdateBand(int ixBand);
+    // Update() with interpolation deferred
+    void RetireFinished(FrameClock::TimePoint now);
+    void MarkChanged(Handle handle);
+    // Waits for updates after lastGeneration
+    void WorkerLoop(int ixWorker, unsigned long lastGeneration);
+    void StopWorkers();
+
+    // Per object: where the current animation starts and ends, when it started and 1 / its length
+    // in nanoseconds. Objects at rest have start = target.
+    QuatArray m_start;
+    QuatArray m_target;
+    std::vector<FrameClock::TimePoint> m_startTime;
+    std::vector<double> m_invDuration;
+    std::vector<FrameClock::TimePoint> m_finishTime;
+    std::vector<std::uint8_t> m_bAnimating;
+    // This update's interpolation parameter and result
+    std::vector<float> m_alpha;
+    QuatArray m_current;
+
+    size_t m_animatingCount = 0;
+    Interpolation m_interpolation = Interpolation::NLERP;
+
+    // Deferred interpolation: the earliest any animation can finish (possibly sooner than any
+    // actually does), and what has changed
+    bool m_bDeferInterpolation = false;
+    FrameClock::TimePoint m_nextFinishTime = FrameClock::TimePoint::max();
+    std::vector<Handle> m_changed;
+    std::vector<std::uint8_t> m_bChanged;
+    bool m_bAllChanged = false;
+
+    // The last update's time; the update in progress, for the workers
+    FrameClock::TimePoint m_now{};
+    size_t m_bandSize = 0;
+    std::vector<size_t> m_bandFinished;
+
+    // Persistent worker pool; worker 0 is the calling thread.
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    unsigned long m_generation = 0;
+    int m_pendingBands = 0;
+    int m_bandCount = 1;
+    bool m_bShutdown = false;
+};
+
+// Every animated orientation in the program.
+extern AnimationSystem g_animationSystem;
+
+#endif // CLIONPROJECTS_ANIMATION_SYSTEM_H
@@ -0,0 +1,104 @@
+// --- Scripted camera path --- \\
+
+#include "camera_path.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+bool CameraPath::Load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("Failed to open camera path: {}", path);
+        return false;
+    }
+
+    std::vector<Keyframe> keyframes;
+    std::string line;
+    for (int iLine = 1; std::getline(file, line); iLine++) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream fields(line);
+        Keyframe keyframe{};
+        fields >> keyframe.time
+               >> keyframe.target.x >> keyframe.target.y >> keyframe.target.z
+               >> keyframe.sphereRelativePosition.x >> keyframe.sphereRelativePosition.y
+               >> keyframe.sphereRelativePosition.z;
+        if (fields.fail()) {
+            LOG_ERROR("{}:{}: expected time, target and sphere position", path, iLine);
+            return false;
+        }
+        if (!keyframes.empty() && keyframe.time <= keyframes.back().time) {
+            LOG_ERROR("{}:{}: keyframe times must increase", path, iLine);
+            return false;
+        }
+        keyframes.push_back(keyframe);
+    }
+
+    if (keyframes.empty()) {
+        LOG_ERROR("Camera path has no keyframes: {}", path);
+        return false;
+    }
+    m_keyframes = std::move(keyframes);
+    return true;
+}
+
+int CameraPath::GetFrameCount(double timestep) const {
+    if (m_keyframes.empty() || timestep <= 0.0)
+        return 0;
+    return static_cast<int>(std::floor(GetDuration() / timestep + 1e-9)) + 1;
+}
+
+void CameraPath::Evaluate(double time, glm::vec3& target, glm::vec3& sphereRelativePosition) const {
+    if (m_keyframes.empty())
+        return;
+
+    if (time <= m_keyframes.front().time || m_keyframes.size() == 1) {
+        target = m_keyframes.front().target;
+        sphereRelativePosition = m_keyframes.front().sphereRelativePosition;
+        return;
+    }
+    if (time >= m_keyframes.back().time) {
+        target = m_keyframes.back().target;
+        sphereRelativePosition = m_keyframes.back().sphereRelativePosition;
+        return;
+    }
+
+    // Segment ix runs from keyframe ix to keyframe ix + 1.
+    auto itNext = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), time,
+                                   [](double t, const Keyframe& keyframe) {return t < keyframe.time;});
+    const size_t ix = static_cast<size_t>(itNext - m_keyframes.begin()) - 1;
+    const size_t ixPrev = ix > 0 ? ix - 1 : ix;
+    const size_t ixNextNext = std::min(ix + 2, m_keyframes.size() - 1);
+
+    const Keyframe& k0 = m_keyframes[ixPrev];
+    const Keyframe& k1 = m_keyframes[ix];
+    const Keyframe& k2 = m_keyframes[ix + 1];
+    const Keyframe& k3 = m_keyframes[ixNextNext];
+
+    // Cubic Hermite with Catmull-Rom tangents taken over time, so that unevenly spaced keyframes
+    // keep a continuous velocity; the end segments use one-sided differences.
+    const float fSegment = static_cast<float>(k2.time - k1.time);
+    const float u = static_cast<float>((time - k1.time) / (k2.time - k1.time));
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+    const float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+    const float h10 = u3 - 2.0f * u2 + u;
+    const float h01 = -2.0f * u3 + 3.0f * u2;
+    const float h11 = u3 - u2;
+
+    const float fTangentScale1 = fSegment / static_cast<float>(k2.time - k0.time);
+    const float fTangentScale2 = fSegment / static_cast<float>(k3.time - k1.time);
+    auto interpolate = [&](const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3) {
+        glm::vec3 m1 = (p2 - p0) * fTangentScale1;
+        glm::vec3 m2 = (p3 - p1) * fTangentScale2;
+        return h00 * p1 + h10 * m1 + h01 * p2 + h11 * m2;
+    };
+
+    target = interpolate(k0.target, k1.target, k2.target, k3.target);
+    sphereRelativePosition = interpolate(k0.sphereRelativePosition, k1.sphereRelativePosition,
+                                         k2.sphereRelativePosition, k3.sphereRelativePosition);
+}
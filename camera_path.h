@@ -0,0 +1,38 @@
+// --- Declares the scripted camera path --- \\
+
+#ifndef CLIONPROJECTS_CAMERA_PATH_H
+#define CLIONPROJECTS_CAMERA_PATH_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include <string>
+#include <vector>
+
+// A camera fly-through for benchmark runs, in the same terms as the programs' own orbit camera:
+// the point looked at, and the camera's position around it as (azimuth degrees, elevation
+// degrees, distance). Keyframes are joined by a Catmull-Rom spline, which passes through every
+// keyframe, and the path holds its first and last keyframes outside their times.
+//
+// Keyframe files are plain text, one keyframe per line, '#' starting a comment:
+//     time  targetX targetY targetZ  azimuth elevation distance
+// with times in seconds and strictly increasing.
+class CameraPath {
+public:
+    struct Keyframe {
+        double time;
+        glm::vec3 target;
+        glm::vec3 sphereRelativePosition;
+    };
+
+    bool Load(const std::string& path);
+
+    [[nodiscard]] bool IsEmpty() const {return m_keyframes.empty();}
+    [[nodiscard]] double GetDuration() const {return m_keyframes.empty() ? 0.0 : m_keyframes.back().time;}
+    // Frames needed to cover the whole path at a fixed timestep, both end keyframes included.
+    [[nodiscard]] int GetFrameCount(double timestep) const;
+
+    void Evaluate(double time, glm::vec3& target, glm::vec3& sphereRelativePosition) const;
+
+private:
+    std::vector<Keyframe> m_keyframes;
+};
+
+#endif // CLIONPROJECTS_CAMERA_PATH_H
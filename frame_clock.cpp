@@ -0,0 +1,24 @@
+// --- Per-frame animation clock --- \\
+
+#include "frame_clock.h"
+#include <algorithm>
+
+FrameClock g_frameClock;
+
+FrameClock::TimePoint FrameClock::Clock::now() {
+    return g_frameClock.Now();
+}
+
+void FrameClock::Tick(std::chrono::steady_clock::time_point realTime) {
+    // The first frame starts the clock at zero.
+    Duration step = Duration::zero();
+    if (m_bTicked && IsFixedStep())
+        step = m_fixedStep;
+    else if (m_bTicked)
+        step = std::min(std::chrono::duration_cast<Duration>(realTime - m_lastRealTime), m_maxRealStep);
+    m_lastRealTime = realTime;
+    m_bTicked = true;
+
+    m_delta = m_fTimeScale == 1.0 ? step : std::chrono::duration_cast<Duration>(step * m_fTimeScale);
+    m_now += m_delta;
+}
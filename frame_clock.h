@@ -0,0 +1,69 @@
+// --- Declares the per-frame animation clock --- \\
+
+#ifndef CLIONPROJECTS_FRAME_CLOCK_H
+#define CLIONPROJECTS_FRAME_CLOCK_H
+#include <chrono>
+
+// The time animation runs on. It is sampled once per frame by Tick(), so everything animated in a
+// frame sees the same instant however long the frame takes to build, and nothing else needs to
+// read the OS clock. Time is kept in nanoseconds since the first tick.
+//
+// Normally each tick advances the clock by the real time since the last one, times the time scale
+// (2 plays animation at double speed, 0 freezes it). A real step is capped at the maximum given
+// to the constructor, so the first frame after rendering on demand sat idle, or after a stall,
+// does not jump animation ahead. The cap applies to every frame, though: below 1 / maxRealStep
+// frames per second (10 with the default) animation runs slower than real time, as if the frame
+// rate were exactly that. With a fixed step set it becomes a virtual clock instead: each tick
+// advances it by exactly the (scaled) step, whatever the frame rate, so a benchmark animates
+// identically on any machine.
+class FrameClock {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    // The clock TimePoint is measured on, a type of its own so that clock times cannot be mixed
+    // up with steady_clock's. now() is the shared clock's current sample; it is not steady, as
+    // the time scale and the real-step cap both change its rate.
+    struct Clock {
+        using rep = Duration::rep;
+        using period = Duration::period;
+        using duration = Duration;
+        using time_point = std::chrono::time_point<Clock, Duration>;
+        static constexpr bool is_steady = false;
+
+        static time_point now();
+    };
+    using TimePoint = Clock::time_point;
+
+    static constexpr Duration g_defaultMaxRealStep = std::chrono::milliseconds(100);
+
+    explicit FrameClock(Duration maxRealStep = g_defaultMaxRealStep) : m_maxRealStep(maxRealStep) {}
+
+    // Call at the start of every frame with the real time it started at.
+    void Tick(std::chrono::steady_clock::time_point realTime);
+
+    // This frame's sample
+    [[nodiscard]] TimePoint Now() const {return m_now;}
+    // How far the clock moved on the last tick
+    [[nodiscard]] Duration GetDelta() const {return m_delta;}
+
+    void SetTimeScale(double fTimeScale) {m_fTimeScale = fTimeScale;}
+    [[nodiscard]] double GetTimeScale() const {return m_fTimeScale;}
+
+    // A zero step goes back to following real time.
+    void SetFixedStep(Duration step) {m_fixedStep = step;}
+    [[nodiscard]] bool IsFixedStep() const {return m_fixedStep > Duration::zero();}
+
+private:
+    Duration m_maxRealStep;
+    TimePoint m_now{};
+    Duration m_delta{0};
+    double m_fTimeScale = 1.0;
+    Duration m_fixedStep{0};
+    std::chrono::steady_clock::time_point m_lastRealTime;
+    bool m_bTicked = false;
+};
+
+// Shared by everything that animates.
+extern FrameClock g_frameClock;
+
+#endif // CLIONPROJECTS_FRAME_CLOCK_H
@@ -0,0 +1,204 @@
+// --- Frame time histogram and baseline gate --- \\
+
+#include "frame_histogram.h"
+#include "launch_options.h"
+#include "logger.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    double NsToMs(std::uint64_t valueNs) {
+        return static_cast<double>(valueNs) / 1.0e6;
+    }
+}
+
+FrameTimeHistogram::FrameTimeHistogram()
+        : m_buckets(g_iSubBucketCount + (g_iMaxValueBits - g_iSubBucketBits) * g_iSubBucketHalfCount, 0) {}
+
+size_t FrameTimeHistogram::GetBucketIndex(std::uint64_t valueNs) {
+    valueNs = std::min<std::uint64_t>(valueNs, (std::uint64_t(1) << g_iMaxValueBits) - 1);
+    if (valueNs < g_iSubBucketCount)
+        return static_cast<size_t>(valueNs);
+
+    // Keep the top g_iSubBucketBits - 1 significant bits below the leading one.
+    const int exponent = static_cast<int>(std::bit_width(valueNs)) - g_iSubBucketBits;
+    const std::uint64_t mantissa = valueNs >> exponent;
+    return g_iSubBucketCount + (exponent - 1) * g_iSubBucketHalfCount + (mantissa - g_iSubBucketHalfCount);
+}
+
+std::uint64_t FrameTimeHistogram::GetBucketHighestValue(size_t ixBucket) {
+    if (ixBucket < g_iSubBucketCount)
+        return ixBucket;
+
+    const size_t exponent = (ixBucket - g_iSubBucketCount) / g_iSubBucketHalfCount + 1;
+    const std::uint64_t mantissa = (ixBucket - g_iSubBucketCount) % g_iSubBucketHalfCount + g_iSubBucketHalfCount;
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void FrameTimeHistogram::RecordFrame() {
+    auto now = std::chrono::steady_clock::now();
+    if (m_bStarted)
+        Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_previousFrame).count()));
+    m_previousFrame = now;
+    m_bStarted = true;
+}
+
+void FrameTimeHistogram::Record(std::uint64_t valueNs) {
+    m_buckets[GetBucketIndex(valueNs)]++;
+    m_count++;
+    m_maxNs = std::max(m_maxNs, valueNs);
+    m_totalNs += static_cast<double>(valueNs);
+}
+
+std::uint64_t FrameTimeHistogram::GetValueAtPercentileNs(double percentile) const {
+    if (m_count == 0)
+        return 0;
+
+    const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    const std::uint64_t rank = std::max<std::uint64_t>(
+            static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_count))), 1);
+    std::uint64_t cumulative = 0;
+    for (size_t ixBucket = 0; ixBucket < m_buckets.size(); ixBucket++) {
+        cumulative += m_buckets[ixBucket];
+        if (cumulative >= rank)
+            return std::min(GetBucketHighestValue(ixBucket), m_maxNs);
+    }
+    return m_maxNs;
+}
+
+FrameTimeHistogram::Summary FrameTimeHistogram::GetSummary() const {
+    Summary summary;
+    summary.frames = m_count;
+    if (m_count == 0)
+        return summary;
+
+    summary.meanMs = m_totalNs / static_cast<double>(m_count) / 1.0e6;
+    summary.p50Ms = NsToMs(GetValueAtPercentileNs(50.0));
+    summary.p90Ms = NsToMs(GetValueAtPercentileNs(90.0));
+    summary.p99Ms = NsToMs(GetValueAtPercentileNs(99.0));
+    summary.maxMs = NsToMs(m_maxNs);
+    return summary;
+}
+
+void FrameTimeHistogram::PrintReport(std::ostream& out) const {
+    const Summary summary = GetSummary();
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "Frame times over " << summary.frames << " frames: mean " << summary.meanMs
+        << " ms, p50 " << summary.p50Ms << " ms, p90 " << summary.p90Ms << " ms, p99 " << summary.p99Ms
+        << " ms, max " << summary.maxMs << " ms\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool FrameTimeHistogram::WriteSummary(const std::string& path, const Summary& summary) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Failed to write frame time baseline: {}", path);
+        return false;
+    }
+    std::fprintf(file, "{\"frames\": %llu, \"meanMs\": %.6f, \"p50Ms\": %.6f, \"p90Ms\": %.6f, \"p99Ms\": %.6f, "
+                       "\"maxMs\": %.6f}\n", static_cast<unsigned long long>(summary.frames), summary.meanMs,
+                 summary.p50Ms, summary.p90Ms, summary.p99Ms, summary.maxMs);
+    std::fclose(file);
+    LOG_INFO("Wrote frame time baseline to {}", path);
+    return true;
+}
+
+bool FrameTimeHistogram::LoadSummary(const std::string& path, Summary& summary) {
+    std::ifstream file(path);
+    if (!file) {
+        LOG_ERROR("Failed to read frame time baseline: {}", path);
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+
+    // Only ever reads back what WriteSummary wrote, so a key search is all the parsing needed.
+    auto readNumber = [&text](const char* key, double& value) {
+        size_t ixKey = text.find(std::string("\"") + key + "\"");
+        if (ixKey == std::string::npos)
+            return false;
+        size_t ixColon = text.find(':', ixKey);
+        if (ixColon == std::string::npos)
+            return false;
+        const char* start = text.c_str() + ixColon + 1;
+        char* end = nullptr;
+        value = std::strtod(start, &end);
+        return end != start;
+    };
+
+    double frames = 0.0;
+    if (!readNumber("frames", frames) || !readNumber("meanMs", summary.meanMs) ||
+        !readNumber("p50Ms", summary.p50Ms) || !readNumber("p90Ms", summary.p90Ms) ||
+        !readNumber("p99Ms", summary.p99Ms) || !readNumber("maxMs", summary.maxMs)) {
+        LOG_ERROR("Malformed frame time baseline: {}", path);
+        return false;
+    }
+    summary.frames = static_cast<std::uint64_t>(frames);
+    return true;
+}
+
+bool FrameTimeHistogram::GetSummaryValue(const Summary& summary, const std::string& metric, double& valueMs) {
+    if (metric == "p50")
+        valueMs = summary.p50Ms;
+    else if (metric == "p90")
+        valueMs = summary.p90Ms;
+    else if (metric == "p99")
+        valueMs = summary.p99Ms;
+    else if (metric == "max")
+        valueMs = summary.maxMs;
+    else if (metric == "mean")
+        valueMs = summary.meanMs;
+    else
+        return false;
+    return true;
+}
+
+int finishFrameTimeReport(const FrameTimeHistogram& histogram, const LaunchOptions& options) {
+    if (histogram.GetCount() == 0) {
+        if (!options.baselinePath.empty()) {
+            LOG_ERROR("No frame times were recorded to compare with the baseline "
+                      "(run with --continuous, --frames N or --headless)");
+            return 1;
+        }
+        return 0;
+    }
+
+    // The report itself goes straight to stdout, after whatever was logged before it.
+    Logger::Get().Flush();
+    histogram.PrintReport(std::cout);
+    const FrameTimeHistogram::Summary summary = histogram.GetSummary();
+    if (!options.writeBaselinePath.empty())
+        FrameTimeHistogram::WriteSummary(options.writeBaselinePath, summary);
+    if (options.baselinePath.empty())
+        return 0;
+
+    FrameTimeHistogram::Summary baseline;
+    if (!FrameTimeHistogram::LoadSummary(options.baselinePath, baseline))
+        return 1;
+
+    double currentMs = 0.0, baselineMs = 0.0;
+    FrameTimeHistogram::GetSummaryValue(summary, options.gateMetric, currentMs);
+    FrameTimeHistogram::GetSummaryValue(baseline, options.gateMetric, baselineMs);
+    const double limitMs = baselineMs * (1.0 + options.fGateThresholdPercent / 100.0);
+    [[maybe_unused]] const double changePercent = baselineMs > 0.0 ? (currentMs / baselineMs - 1.0) * 100.0 : 0.0;
+    const bool bRegressed = currentMs > limitMs;
+
+    if (bRegressed)
+        LOG_ERROR("FAIL: {} {:.3f} ms against a baseline of {:.3f} ms ({:+.1f}%, limit +{}%)", options.gateMetric,
+                  currentMs, baselineMs, changePercent, options.fGateThresholdPercent);
+    else
+        LOG_INFO("PASS: {} {:.3f} ms against a baseline of {:.3f} ms ({:+.1f}%, limit +{}%)", options.gateMetric,
+                 currentMs, baselineMs, changePercent, options.fGateThresholdPercent);
+    return bRegressed ? 1 : 0;
+}
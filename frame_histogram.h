@@ -0,0 +1,70 @@
+// --- Declares the frame time histogram and baseline gate --- \\
+
+#ifndef CLIONPROJECTS_FRAME_HISTOGRAM_H
+#define CLIONPROJECTS_FRAME_HISTOGRAM_H
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct LaunchOptions;
+
+// Records every frame time, in nanoseconds, into log-linear buckets in the style of HdrHistogram:
+// values below 128 ns get a bucket each, and every power of two above that is split into 64
+// buckets, so any value is reported to within 1/64 (about 1.6%) of what was recorded while the
+// whole range up to 2^40 ns (about 18 minutes) fits in a few thousand counters. Recording is a
+// couple of shifts and an increment, so it can run on every frame of every run.
+class FrameTimeHistogram {
+public:
+    FrameTimeHistogram();
+
+    // Records the time since the previous call; the first call only starts the clock.
+    void RecordFrame();
+    void Record(std::uint64_t valueNs);
+
+    [[nodiscard]] std::uint64_t GetCount() const {return m_count;}
+    [[nodiscard]] std::uint64_t GetMaxNs() const {return m_maxNs;}
+    // percentile is in [0, 100]; reports the highest value equivalent to the bucket it lands in.
+    [[nodiscard]] std::uint64_t GetValueAtPercentileNs(double percentile) const;
+
+    struct Summary {
+        std::uint64_t frames = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+    [[nodiscard]] Summary GetSummary() const;
+    void PrintReport(std::ostream& out) const;
+
+    // Baselines are the summary as a flat JSON object.
+    static bool WriteSummary(const std::string& path, const Summary& summary);
+    static bool LoadSummary(const std::string& path, Summary& summary);
+    // Looks up "p50", "p90", "p99", "max" or "mean"; false for anything else.
+    static bool GetSummaryValue(const Summary& summary, const std::string& metric, double& valueMs);
+
+private:
+    static constexpr int g_iSubBucketBits = 7;
+    static constexpr int g_iMaxValueBits = 40;
+    static constexpr size_t g_iSubBucketCount = size_t(1) << g_iSubBucketBits;
+    static constexpr size_t g_iSubBucketHalfCount = g_iSubBucketCount / 2;
+
+    static size_t GetBucketIndex(std::uint64_t valueNs);
+    static std::uint64_t GetBucketHighestValue(size_t ixBucket);
+
+    std::vector<std::uint64_t> m_buckets;
+    std::uint64_t m_count = 0;
+    std::uint64_t m_maxNs = 0;
+    double m_totalNs = 0.0;
+    std::chrono::steady_clock::time_point m_previousFrame;
+    bool m_bStarted = false;
+};
+
+// Prints the run's frame time report, writes it as a baseline if --write-baseline was given, and
+// compares it against --baseline. Returns the process exit code: non-zero when the gated
+// percentile regressed by more than the threshold or the baseline could not be read.
+int finishFrameTimeReport(const FrameTimeHistogram& histogram, const LaunchOptions& options);
+
+#endif // CLIONPROJECTS_FRAME_HISTOGRAM_H
@@ -0,0 +1,47 @@
+// --- Frame pacing controller --- \\
+
+#include "frame_pacer.h"
+#include "libraries/glfw-master/include/GLFW/glfw3.h"
+#include <algorithm>
+#include <thread>
+
+FramePacer::FramePacer(Mode mode, double fTargetFps, std::chrono::microseconds spinMargin)
+        : m_mode(mode), m_spinMargin(spinMargin) {
+    SetTargetFps(fTargetFps);
+}
+
+void FramePacer::Apply() const {
+    glfwSwapInterval(m_mode == Mode::VSYNC ? 1 : 0);
+}
+
+void FramePacer::SetMode(Mode mode) {
+    m_mode = mode;
+    m_nextFrameTime = Clock::time_point();
+    Apply();
+}
+
+void FramePacer::SetTargetFps(double fTargetFps) {
+    fTargetFps = std::max(fTargetFps, 1.0);
+    m_framePeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fTargetFps));
+    m_nextFrameTime = Clock::time_point();
+}
+
+void FramePacer::WaitForNextFrame() {
+    if (m_mode != Mode::CAPPED)
+        return;
+
+    auto now = Clock::now();
+    // After a stall (or the first frame) start a new schedule rather than rushing to catch up.
+    if (now - m_nextFrameTime > m_framePeriod) {
+        m_nextFrameTime = now + m_framePeriod;
+        return;
+    }
+
+    // Sleep while the deadline is comfortably far away, then spin out the remainder.
+    if (m_nextFrameTime - now > m_spinMargin)
+        std::this_thread::sleep_until(m_nextFrameTime - m_spinMargin);
+    while (Clock::now() < m_nextFrameTime)
+        std::this_thread::yield();
+
+    m_nextFrameTime += m_framePeriod;
+}
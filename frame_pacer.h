@@ -0,0 +1,41 @@
+// --- Declares the frame pacing controller --- \\
+
+#ifndef CLIONPROJECTS_FRAME_PACER_H
+#define CLIONPROJECTS_FRAME_PACER_H
+#include <chrono>
+
+// Controls how fast frames are presented. VSYNC leaves pacing to the swap interval, UNCAPPED
+// disables it for benchmarking, and CAPPED disables it and instead holds each frame back until
+// the target frame time has passed, sleeping for most of the wait and spinning for the rest
+// so that the coarse sleep granularity of the OS does not show up as jitter.
+class FramePacer {
+public:
+    enum class Mode {
+        VSYNC,
+        UNCAPPED,
+        CAPPED
+    };
+
+    explicit FramePacer(Mode mode = Mode::VSYNC, double fTargetFps = 60.0,
+                        std::chrono::microseconds spinMargin = std::chrono::microseconds(2000));
+
+    // Sets the swap interval for the mode; needs the window's context to be current.
+    void Apply() const;
+
+    void SetMode(Mode mode);
+    [[nodiscard]] Mode GetMode() const {return m_mode;}
+    void SetTargetFps(double fTargetFps);
+
+    // Call right before glfwSwapBuffers. Only blocks in CAPPED mode.
+    void WaitForNextFrame();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Mode m_mode;
+    Clock::duration m_framePeriod;
+    std::chrono::microseconds m_spinMargin;
+    Clock::time_point m_nextFrameTime;
+};
+
+#endif // CLIONPROJECTS_FRAME_PACER_H
@@ -0,0 +1,37 @@
+// --- Damage-driven frame scheduler --- \\
+
+#include "frame_scheduler.h"
+
+namespace {
+    // GLFW callbacks carry no user data besides the window pointer, which the renderer owns.
+    FrameScheduler* g_pAttachedScheduler = nullptr;
+}
+
+FrameScheduler::FrameScheduler(Mode mode, double fMaxWaitSeconds)
+        : m_mode(mode), m_fMaxWaitSeconds(fMaxWaitSeconds) {}
+
+void FrameScheduler::Attach(GLFWwindow* window) {
+    g_pAttachedScheduler = this;
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) {
+        if (g_pAttachedScheduler != nullptr)
+            g_pAttachedScheduler->MarkDirty();
+    });
+}
+
+void FrameScheduler::SetAnimating(bool bAnimating) {
+    if (m_bAnimating && !bAnimating)
+        m_bDirty = true;
+    m_bAnimating = bAnimating;
+}
+
+bool FrameScheduler::WaitForFrame() {
+    bool bBusy = m_mode == Mode::CONTINUOUS || m_bAnimating || m_bDirty;
+    if (bBusy)
+        glfwPollEvents();
+    else
+        glfwWaitEventsTimeout(m_fMaxWaitSeconds);
+
+    bool bDraw = m_mode == Mode::CONTINUOUS || m_bAnimating || m_bDirty;
+    m_bDirty = false;
+    return bDraw;
+}
@@ -0,0 +1,41 @@
+// --- Declares the damage-driven frame scheduler --- \\
+
+#ifndef CLIONPROJECTS_FRAME_SCHEDULER_H
+#define CLIONPROJECTS_FRAME_SCHEDULER_H
+#include "libraries/glfw-master/include/GLFW/glfw3.h"
+
+// Decides when the render loop has to draw. In ON_DEMAND mode a frame is only drawn once
+// something marked it dirty (input, a resize, an expose) or while an animation is running;
+// otherwise the loop sleeps in glfwWaitEventsTimeout.
+// CONTINUOUS mode draws every iteration, which is what benchmarks want.
+class FrameScheduler {
+public:
+    enum class Mode {
+        ON_DEMAND,
+        CONTINUOUS
+    };
+
+    explicit FrameScheduler(Mode mode = Mode::ON_DEMAND, double fMaxWaitSeconds = 0.5);
+
+    // Also marks the frame dirty whenever the window contents are damaged (expose, un-minimise).
+    void Attach(GLFWwindow* window);
+
+    void SetMode(Mode mode) {m_mode = mode; m_bDirty = true;}
+    [[nodiscard]] Mode GetMode() const {return m_mode;}
+
+    void MarkDirty() {m_bDirty = true;}
+    // Keeps frames coming while an animation runs, plus one after it stops to show its end state.
+    void SetAnimating(bool bAnimating);
+
+    // Processes window events, sleeping first if nothing needs drawing yet. Returns true if the
+    // caller should draw a frame this iteration.
+    bool WaitForFrame();
+
+private:
+    Mode m_mode;
+    double m_fMaxWaitSeconds;
+    bool m_bDirty = true;
+    bool m_bAnimating = false;
+};
+
+#endif // CLIONPROJECTS_FRAME_SCHEDULER_H
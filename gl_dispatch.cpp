@@ -0,0 +1,343 @@
+// --- Null GL dispatch: counts and records GL calls instead of issuing them --- \\
+
+#include "gl_dispatch.h"
+
+#ifdef GL_NULL_DISPATCH
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+
+namespace nullgl {
+    namespace {
+        struct State {
+            bool bRecording = true;
+            Stats stats;
+            std::vector<Command> commandLog;
+            std::vector<std::byte> payloadArena;
+            GLuint nextName = 1;
+            GLint nextUniformLocation = 0;
+            GLfloat clearColour[4] = {};
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        void Record(Op op, std::uint32_t arg0 = 0, std::uint32_t arg1 = 0) {
+            State& state = GetState();
+            state.stats.calls[static_cast<int>(op)]++;
+            state.stats.totalCalls++;
+            if (state.bRecording)
+                state.commandLog.push_back({op, arg0, arg1});
+        }
+
+        // Copies the data a driver would have to take a copy of before the call returns.
+        void RecordPayload(Op op, std::uint32_t arg0, const void* data, std::size_t size) {
+            Record(op, arg0, static_cast<std::uint32_t>(size));
+
+            State& state = GetState();
+            state.stats.payloadBytes += size;
+            if (state.bRecording && data != nullptr) {
+                std::size_t offset = state.payloadArena.size();
+                state.payloadArena.resize(offset + size);
+                std::memcpy(state.payloadArena.data() + offset, data, size);
+            }
+        }
+
+        void RecordDraw(Op op, std::uint32_t mode, std::uint32_t count) {
+            Record(op, mode, count);
+            GetState().stats.drawCalls++;
+        }
+
+        void GenerateNames(Op op, GLsizei n, GLuint* names) {
+            Record(op, static_cast<std::uint32_t>(n));
+            for (GLsizei i = 0; i < n; i++)
+                names[i] = GetState().nextName++;
+        }
+
+        constexpr const char* g_opNames[] = {
+#define NULLGL_OP_NAME(op, function) #function,
+                NULLGL_OPS(NULLGL_OP_NAME)
+#undef NULLGL_OP_NAME
+        };
+    }
+
+    void SetRecording(bool bRecording) {
+        GetState().bRecording = bRecording;
+    }
+
+    void BeginFrame() {
+        // clear() keeps the capacity, so a steady state frame does not allocate.
+        GetState().commandLog.clear();
+        GetState().payloadArena.clear();
+    }
+
+    void ResetStats() {
+        GetState().stats = Stats();
+    }
+
+    const Stats& GetStats() {
+        return GetState().stats;
+    }
+
+    const std::vector<Command>& GetCommandLog() {
+        return GetState().commandLog;
+    }
+
+    const char* GetOpName(Op op) {
+        return g_opNames[static_cast<int>(op)];
+    }
+
+    void PrintReport(std::ostream& out, int frameCount, std::chrono::nanoseconds submissionTime) {
+        const Stats& stats = GetState().stats;
+        double frames = std::max(frameCount, 1);
+        double nanoseconds = static_cast<double>(submissionTime.count());
+
+        out << std::fixed << std::setprecision(1)
+            << "Null GL: " << frameCount << " frames, "
+            << nanoseconds / frames / 1000.0 << " us/frame, "
+            << static_cast<double>(stats.drawCalls) / frames << " draws/frame, "
+            << (stats.drawCalls > 0 ? nanoseconds / static_cast<double>(stats.drawCalls) : 0.0) << " ns/draw, "
+            << static_cast<double>(stats.totalCalls) / frames << " GL calls/frame, "
+            << static_cast<double>(stats.payloadBytes) / frames / 1024.0 << " KiB uploaded/frame\n";
+
+        std::vector<int> ops;
+        for (int ixOp = 0; ixOp < static_cast<int>(Op::COUNT); ixOp++) {
+            if (stats.calls[ixOp] > 0)
+                ops.push_back(ixOp);
+        }
+        std::sort(ops.begin(), ops.end(), [&stats](int a, int b) {return stats.calls[a] > stats.calls[b];});
+
+        const std::size_t maxRows = 10;
+        for (std::size_t ixRow = 0; ixRow < std::min(ops.size(), maxRows); ixRow++) {
+            int ixOp = ops[ixRow];
+            out << "  " << std::left << std::setw(28) << g_opNames[ixOp] << std::right
+                << static_cast<double>(stats.calls[ixOp]) / frames << " /frame\n";
+        }
+    }
+
+    GLenum Init() {
+        return GLEW_OK;
+    }
+
+    void ActiveTexture(GLenum texture) {Record(Op::ACTIVE_TEXTURE, texture);}
+    void AttachShader(GLuint program, GLuint shader) {Record(Op::ATTACH_SHADER, program, shader);}
+    void BindBuffer(GLenum target, GLuint buffer) {Record(Op::BIND_BUFFER, target, buffer);}
+
+    void BindBufferRange(GLenum, GLuint index, GLuint buffer, GLintptr, GLsizeiptr) {
+        Record(Op::BIND_BUFFER_RANGE, index, buffer);
+    }
+
+    void BindFramebuffer(GLenum target, GLuint framebuffer) {Record(Op::BIND_FRAMEBUFFER, target, framebuffer);}
+    void BindRenderbuffer(GLenum target, GLuint renderbuffer) {Record(Op::BIND_RENDERBUFFER, target, renderbuffer);}
+    void BindTexture(GLenum target, GLuint texture) {Record(Op::BIND_TEXTURE, target, texture);}
+    void BindVertexArray(GLuint array) {Record(Op::BIND_VERTEX_ARRAY, array);}
+
+    void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) {
+        RecordPayload(Op::BUFFER_DATA, target, data, static_cast<std::size_t>(size));
+    }
+
+    void BufferSubData(GLenum target, GLintptr, GLsizeiptr size, const void* data) {
+        RecordPayload(Op::BUFFER_SUB_DATA, target, data, static_cast<std::size_t>(size));
+    }
+
+    GLenum CheckFramebufferStatus(GLenum target) {
+        Record(Op::CHECK_FRAMEBUFFER_STATUS, target);
+        return GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    void Clear(GLbitfield mask) {Record(Op::CLEAR, mask);}
+
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+        Record(Op::CLEAR_COLOR);
+        GLfloat* clearColour = GetState().clearColour;
+        clearColour[0] = red;
+        clearColour[1] = green;
+        clearColour[2] = blue;
+        clearColour[3] = alpha;
+    }
+
+    void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+        Record(Op::COLOR_MASK, red | green << 1 | blue << 2 | alpha << 3);
+    }
+
+    void CompileShader(GLuint shader) {Record(Op::COMPILE_SHADER, shader);}
+
+    GLuint CreateProgram() {
+        Record(Op::CREATE_PROGRAM);
+        return GetState().nextName++;
+    }
+
+    GLuint CreateShader(GLenum type) {
+        Record(Op::CREATE_SHADER, type);
+        return GetState().nextName++;
+    }
+
+    void CullFace(GLenum mode) {Record(Op::CULL_FACE, mode);}
+    void DeleteBuffers(GLsizei n, const GLuint*) {Record(Op::DELETE_BUFFERS, n);}
+    void DeleteFramebuffers(GLsizei n, const GLuint*) {Record(Op::DELETE_FRAMEBUFFERS, n);}
+    void DeleteProgram(GLuint program) {Record(Op::DELETE_PROGRAM, program);}
+    void DeleteQueries(GLsizei n, const GLuint*) {Record(Op::DELETE_QUERIES, n);}
+    void DeleteRenderbuffers(GLsizei n, const GLuint*) {Record(Op::DELETE_RENDERBUFFERS, n);}
+    void DeleteShader(GLuint shader) {Record(Op::DELETE_SHADER, shader);}
+    void DeleteTextures(GLsizei n, const GLuint*) {Record(Op::DELETE_TEXTURES, n);}
+    void DeleteVertexArrays(GLsizei n, const GLuint*) {Record(Op::DELETE_VERTEX_ARRAYS, n);}
+    void DepthFunc(GLenum func) {Record(Op::DEPTH_FUNC, func);}
+    void DepthMask(GLboolean flag) {Record(Op::DEPTH_MASK, flag);}
+    void DepthRange(GLclampd, GLclampd) {Record(Op::DEPTH_RANGE);}
+    void DetachShader(GLuint program, GLuint shader) {Record(Op::DETACH_SHADER, program, shader);}
+    void Disable(GLenum cap) {Record(Op::DISABLE, cap);}
+
+    void DrawArrays(GLenum mode, GLint, GLsizei count) {RecordDraw(Op::DRAW_ARRAYS, mode, count);}
+
+    void DrawArraysInstanced(GLenum mode, GLint, GLsizei count, GLsizei instanceCount) {
+        RecordDraw(Op::DRAW_ARRAYS_INSTANCED, mode, count * instanceCount);
+    }
+
+    void DrawElements(GLenum mode, GLsizei count, GLenum, const void*) {RecordDraw(Op::DRAW_ELEMENTS, mode, count);}
+    void Enable(GLenum cap) {Record(Op::ENABLE, cap);}
+    void EnableVertexAttribArray(GLuint index) {Record(Op::ENABLE_VERTEX_ATTRIB_ARRAY, index);}
+    void Flush() {Record(Op::FLUSH);}
+
+    void FramebufferRenderbuffer(GLenum, GLenum attachment, GLenum, GLuint renderbuffer) {
+        Record(Op::FRAMEBUFFER_RENDERBUFFER, attachment, renderbuffer);
+    }
+
+    void FramebufferTexture2D(GLenum, GLenum attachment, GLenum, GLuint texture, GLint) {
+        Record(Op::FRAMEBUFFER_TEXTURE_2D, attachment, texture);
+    }
+
+    void FrontFace(GLenum mode) {Record(Op::FRONT_FACE, mode);}
+    void GenBuffers(GLsizei n, GLuint* buffers) {GenerateNames(Op::GEN_BUFFERS, n, buffers);}
+    void GenFramebuffers(GLsizei n, GLuint* framebuffers) {GenerateNames(Op::GEN_FRAMEBUFFERS, n, framebuffers);}
+    void GenQueries(GLsizei n, GLuint* ids) {GenerateNames(Op::GEN_QUERIES, n, ids);}
+
+    void GenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+        GenerateNames(Op::GEN_RENDERBUFFERS, n, renderbuffers);
+    }
+
+    void GenTextures(GLsizei n, GLuint* textures) {GenerateNames(Op::GEN_TEXTURES, n, textures);}
+    void GenVertexArrays(GLsizei n, GLuint* arrays) {GenerateNames(Op::GEN_VERTEX_ARRAYS, n, arrays);}
+    void GenerateMipmap(GLenum target) {Record(Op::GENERATE_MIPMAP, target);}
+
+    void GetFloatv(GLenum pname, GLfloat* data) {
+        Record(Op::GET_FLOATV, pname);
+        if (pname == GL_COLOR_CLEAR_VALUE)
+            std::copy(GetState().clearColour, GetState().clearColour + 4, data);
+        else
+            data[0] = 0.0f;
+    }
+
+    void GetInteger64v(GLenum pname, GLint64* data) {
+        Record(Op::GET_INTEGER64V, pname);
+        data[0] = 0;
+    }
+
+    void GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+        Record(Op::GET_PROGRAM_INFO_LOG, program);
+        if (length != nullptr)
+            *length = 0;
+        if (bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params) {
+        Record(Op::GET_PROGRAMIV, program, pname);
+        *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+    }
+
+    void GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+        Record(Op::GET_SHADER_INFO_LOG, shader);
+        if (length != nullptr)
+            *length = 0;
+        if (bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    void GetShaderiv(GLuint shader, GLenum pname, GLint* params) {
+        Record(Op::GET_SHADERIV, shader, pname);
+        *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    // Queries are always ready and every pass takes no time.
+    void GetQueryObjectiv(GLuint id, GLenum pname, GLint* params) {
+        Record(Op::GET_QUERY_OBJECTIV, id, pname);
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+        Record(Op::GET_QUERY_OBJECTUI64V, id, pname);
+        *params = 0;
+    }
+
+    GLuint GetUniformBlockIndex(GLuint program, const GLchar*) {
+        Record(Op::GET_UNIFORM_BLOCK_INDEX, program);
+        return 0;
+    }
+
+    // A real driver hashes the name; the null one only needs distinct, valid locations.
+    GLint GetUniformLocation(GLuint program, const GLchar* name) {
+        Record(Op::GET_UNIFORM_LOCATION, program, static_cast<std::uint32_t>(std::strlen(name)));
+        return GetState().nextUniformLocation++;
+    }
+
+    void LinkProgram(GLuint program) {Record(Op::LINK_PROGRAM, program);}
+    void ObjectLabel(GLenum identifier, GLuint name, GLsizei, const GLchar*) {Record(Op::OBJECT_LABEL, identifier, name);}
+    void PixelStorei(GLenum pname, GLint param) {Record(Op::PIXEL_STOREI, pname, param);}
+    void QueryCounter(GLuint id, GLenum target) {Record(Op::QUERY_COUNTER, id, target);}
+
+    void ReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, void*) {
+        Record(Op::READ_PIXELS, width, height);
+    }
+
+    void RenderbufferStorage(GLenum, GLenum internalFormat, GLsizei width, GLsizei height) {
+        Record(Op::RENDERBUFFER_STORAGE, internalFormat, width * height);
+    }
+
+    void ShaderSource(GLuint shader, GLsizei count, const GLchar* const*, const GLint*) {
+        Record(Op::SHADER_SOURCE, shader, count);
+    }
+
+    void TexImage2D(GLenum, GLint level, GLint, GLsizei width, GLsizei height, GLint, GLenum, GLenum, const void*) {
+        Record(Op::TEX_IMAGE_2D, level, width * height);
+    }
+
+    void TexParameteri(GLenum, GLenum pname, GLint param) {Record(Op::TEX_PARAMETERI, pname, param);}
+
+    void Uniform1f(GLint location, GLfloat v0) {
+        RecordPayload(Op::UNIFORM_1F, location, &v0, sizeof(v0));
+    }
+
+    void Uniform1i(GLint location, GLint v0) {
+        RecordPayload(Op::UNIFORM_1I, location, &v0, sizeof(v0));
+    }
+
+    void Uniform2f(GLint location, GLfloat v0, GLfloat v1) {
+        GLfloat value[2] = {v0, v1};
+        RecordPayload(Op::UNIFORM_2F, location, value, sizeof(value));
+    }
+
+    void Uniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+        RecordPayload(Op::UNIFORM_3FV, location, value, sizeof(GLfloat) * 3 * count);
+    }
+
+    void UniformBlockBinding(GLuint program, GLuint, GLuint uniformBlockBinding) {
+        Record(Op::UNIFORM_BLOCK_BINDING, program, uniformBlockBinding);
+    }
+
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean, const GLfloat* value) {
+        RecordPayload(Op::UNIFORM_MATRIX_4FV, location, value, sizeof(GLfloat) * 16 * count);
+    }
+
+    void UseProgram(GLuint program) {Record(Op::USE_PROGRAM, program);}
+    void VertexAttribDivisor(GLuint index, GLuint divisor) {Record(Op::VERTEX_ATTRIB_DIVISOR, index, divisor);}
+
+    void VertexAttribPointer(GLuint index, GLint size, GLenum, GLboolean, GLsizei, const void*) {
+        Record(Op::VERTEX_ATTRIB_POINTER, index, size);
+    }
+
+    void Viewport(GLint, GLint, GLsizei width, GLsizei height) {Record(Op::VIEWPORT, width, height);}
+}
+#endif // GL_NULL_DISPATCH
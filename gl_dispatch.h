@@ -0,0 +1,374 @@
+// --- Declares the replaceable GL dispatch layer --- \\
+
+#ifndef CLIONPROJECTS_GL_DISPATCH_H
+#define CLIONPROJECTS_GL_DISPATCH_H
+#include "libraries/glew-2.1.0/include/GL/glew.h"
+
+// Include after glew.h. Normally this adds nothing and GL calls go straight to the driver.
+// Building with GL_NULL_DISPATCH defined (the GL_NULL_DISPATCH CMake option) redirects every
+// GL entry point the programs use to a null implementation that never reaches a driver: calls
+// are counted and appended to a compact per-frame command log, uniform and buffer uploads are
+// copied like a driver would, and objects get names so set-up code runs unchanged. What is left
+// to measure is the CPU cost of building a frame, without a GPU or a display.
+#ifdef GL_NULL_DISPATCH
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace nullgl {
+    // Operation name, GL function
+#define NULLGL_OPS(X) \
+    X(ACTIVE_TEXTURE, glActiveTexture) \
+    X(ATTACH_SHADER, glAttachShader) \
+    X(BIND_BUFFER, glBindBuffer) \
+    X(BIND_BUFFER_RANGE, glBindBufferRange) \
+    X(BIND_FRAMEBUFFER, glBindFramebuffer) \
+    X(BIND_RENDERBUFFER, glBindRenderbuffer) \
+    X(BIND_TEXTURE, glBindTexture) \
+    X(BIND_VERTEX_ARRAY, glBindVertexArray) \
+    X(BUFFER_DATA, glBufferData) \
+    X(BUFFER_SUB_DATA, glBufferSubData) \
+    X(CHECK_FRAMEBUFFER_STATUS, glCheckFramebufferStatus) \
+    X(CLEAR, glClear) \
+    X(CLEAR_COLOR, glClearColor) \
+    X(COLOR_MASK, glColorMask) \
+    X(COMPILE_SHADER, glCompileShader) \
+    X(CREATE_PROGRAM, glCreateProgram) \
+    X(CREATE_SHADER, glCreateShader) \
+    X(CULL_FACE, glCullFace) \
+    X(DELETE_BUFFERS, glDeleteBuffers) \
+    X(DELETE_FRAMEBUFFERS, glDeleteFramebuffers) \
+    X(DELETE_PROGRAM, glDeleteProgram) \
+    X(DELETE_QUERIES, glDeleteQueries) \
+    X(DELETE_RENDERBUFFERS, glDeleteRenderbuffers) \
+    X(DELETE_SHADER, glDeleteShader) \
+    X(DELETE_TEXTURES, glDeleteTextures) \
+    X(DELETE_VERTEX_ARRAYS, glDeleteVertexArrays) \
+    X(DEPTH_FUNC, glDepthFunc) \
+    X(DEPTH_MASK, glDepthMask) \
+    X(DEPTH_RANGE, glDepthRange) \
+    X(DETACH_SHADER, glDetachShader) \
+    X(DISABLE, glDisable) \
+    X(DRAW_ARRAYS, glDrawArrays) \
+    X(DRAW_ARRAYS_INSTANCED, glDrawArraysInstanced) \
+    X(DRAW_ELEMENTS, glDrawElements) \
+    X(ENABLE, glEnable) \
+    X(ENABLE_VERTEX_ATTRIB_ARRAY, glEnableVertexAttribArray) \
+    X(FLUSH, glFlush) \
+    X(FRAMEBUFFER_RENDERBUFFER, glFramebufferRenderbuffer) \
+    X(FRAMEBUFFER_TEXTURE_2D, glFramebufferTexture2D) \
+    X(FRONT_FACE, glFrontFace) \
+    X(GEN_BUFFERS, glGenBuffers) \
+    X(GEN_FRAMEBUFFERS, glGenFramebuffers) \
+    X(GEN_QUERIES, glGenQueries) \
+    X(GEN_RENDERBUFFERS, glGenRenderbuffers) \
+    X(GEN_TEXTURES, glGenTextures) \
+    X(GEN_VERTEX_ARRAYS, glGenVertexArrays) \
+    X(GENERATE_MIPMAP, glGenerateMipmap) \
+    X(GET_FLOATV, glGetFloatv) \
+    X(GET_INTEGER64V, glGetInteger64v) \
+    X(GET_PROGRAM_INFO_LOG, glGetProgramInfoLog) \
+    X(GET_PROGRAMIV, glGetProgramiv) \
+    X(GET_QUERY_OBJECTIV, glGetQueryObjectiv) \
+    X(GET_QUERY_OBJECTUI64V, glGetQueryObjectui64v) \
+    X(GET_SHADER_INFO_LOG, glGetShaderInfoLog) \
+    X(GET_SHADERIV, glGetShaderiv) \
+    X(GET_UNIFORM_BLOCK_INDEX, glGetUniformBlockIndex) \
+    X(GET_UNIFORM_LOCATION, glGetUniformLocation) \
+    X(LINK_PROGRAM, glLinkProgram) \
+    X(OBJECT_LABEL, glObjectLabel) \
+    X(PIXEL_STOREI, glPixelStorei) \
+    X(QUERY_COUNTER, glQueryCounter) \
+    X(READ_PIXELS, glReadPixels) \
+    X(RENDERBUFFER_STORAGE, glRenderbufferStorage) \
+    X(SHADER_SOURCE, glShaderSource) \
+    X(TEX_IMAGE_2D, glTexImage2D) \
+    X(TEX_PARAMETERI, glTexParameteri) \
+    X(UNIFORM_1F, glUniform1f) \
+    X(UNIFORM_1I, glUniform1i) \
+    X(UNIFORM_2F, glUniform2f) \
+    X(UNIFORM_3FV, glUniform3fv) \
+    X(UNIFORM_BLOCK_BINDING, glUniformBlockBinding) \
+    X(UNIFORM_MATRIX_4FV, glUniformMatrix4fv) \
+    X(USE_PROGRAM, glUseProgram) \
+    X(VERTEX_ATTRIB_DIVISOR, glVertexAttribDivisor) \
+    X(VERTEX_ATTRIB_POINTER, glVertexAttribPointer) \
+    X(VIEWPORT, glViewport)
+
+    enum class Op : std::uint8_t {
+#define NULLGL_OP_ENUM(op, function) op,
+        NULLGL_OPS(NULLGL_OP_ENUM)
+#undef NULLGL_OP_ENUM
+        COUNT
+    };
+
+    // One logged call: the operation and its first two integer arguments. Uniform and buffer
+    // payloads go to a separate byte arena in call order.
+    struct Command {
+        Op op;
+        std::uint32_t arg0;
+        std::uint32_t arg1;
+    };
+
+    struct Stats {
+        std::uint64_t calls[static_cast<int>(Op::COUNT)] = {};
+        std::uint64_t totalCalls = 0;
+        std::uint64_t drawCalls = 0;
+        std::uint64_t payloadBytes = 0;
+    };
+
+    // Off counts calls only; on (the default) also fills the command log.
+    void SetRecording(bool bRecording);
+    // Starts a new command log; the stats keep accumulating.
+    void BeginFrame();
+    void ResetStats();
+
+    [[nodiscard]] const Stats& GetStats();
+    [[nodiscard]] const std::vector<Command>& GetCommandLog();
+    [[nodiscard]] const char* GetOpName(Op op);
+
+    // Per frame and per draw averages plus the most frequent calls.
+    void PrintReport(std::ostream& out, int frameCount, std::chrono::nanoseconds submissionTime);
+
+    GLenum Init();
+
+    void ActiveTexture(GLenum texture);
+    void AttachShader(GLuint program, GLuint shader);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+    void BindRenderbuffer(GLenum target, GLuint renderbuffer);
+    void BindTexture(GLenum target, GLuint texture);
+    void BindVertexArray(GLuint array);
+    void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+    GLenum CheckFramebufferStatus(GLenum target);
+    void Clear(GLbitfield mask);
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+    void CompileShader(GLuint shader);
+    GLuint CreateProgram();
+    GLuint CreateShader(GLenum type);
+    void CullFace(GLenum mode);
+    void DeleteBuffers(GLsizei n, const GLuint* buffers);
+    void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+    void DeleteProgram(GLuint program);
+    void DeleteQueries(GLsizei n, const GLuint* ids);
+    void DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+    void DeleteShader(GLuint shader);
+    void DeleteTextures(GLsizei n, const GLuint* textures);
+    void DeleteVertexArrays(GLsizei n, const GLuint* arrays);
+    void DepthFunc(GLenum func);
+    void DepthMask(GLboolean flag);
+    void DepthRange(GLclampd nearVal, GLclampd farVal);
+    void DetachShader(GLuint program, GLuint shader);
+    void Disable(GLenum cap);
+    void DrawArrays(GLenum mode, GLint first, GLsizei count);
+    void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+    void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+    void Enable(GLenum cap);
+    void EnableVertexAttribArray(GLuint index);
+    void Flush();
+    void FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer);
+    void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texTarget, GLuint texture, GLint level);
+    void FrontFace(GLenum mode);
+    void GenBuffers(GLsizei n, GLuint* buffers);
+    void GenFramebuffers(GLsizei n, GLuint* framebuffers);
+    void GenQueries(GLsizei n, GLuint* ids);
+    void GenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+    void GenTextures(GLsizei n, GLuint* textures);
+    void GenVertexArrays(GLsizei n, GLuint* arrays);
+    void GenerateMipmap(GLenum target);
+    void GetFloatv(GLenum pname, GLfloat* data);
+    void GetInteger64v(GLenum pname, GLint64* data);
+    void GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params);
+    void GetQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+    void GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    void GetShaderiv(GLuint shader, GLenum pname, GLint* params);
+    GLuint GetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName);
+    GLint GetUniformLocation(GLuint program, const GLchar* name);
+    void LinkProgram(GLuint program);
+    void ObjectLabel(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+    void PixelStorei(GLenum pname, GLint param);
+    void QueryCounter(GLuint id, GLenum target);
+    void ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+    void RenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height);
+    void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+    void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                    GLenum format, GLenum type, const void* data);
+    void TexParameteri(GLenum target, GLenum pname, GLint param);
+    void Uniform1f(GLint location, GLfloat v0);
+    void Uniform1i(GLint location, GLint v0);
+    void Uniform2f(GLint location, GLfloat v0, GLfloat v1);
+    void Uniform3fv(GLint location, GLsizei count, const GLfloat* value);
+    void UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void UseProgram(GLuint program);
+    void VertexAttribDivisor(GLuint index, GLuint divisor);
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                             const void* pointer);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+}
+
+// GLEW defines most entry points as macros already; GL 1.1 ones are plain functions.
+#undef glewInit
+#define glewInit nullgl::Init
+
+#undef glActiveTexture
+#define glActiveTexture nullgl::ActiveTexture
+#undef glAttachShader
+#define glAttachShader nullgl::AttachShader
+#undef glBindBuffer
+#define glBindBuffer nullgl::BindBuffer
+#undef glBindBufferRange
+#define glBindBufferRange nullgl::BindBufferRange
+#undef glBindFramebuffer
+#define glBindFramebuffer nullgl::BindFramebuffer
+#undef glBindRenderbuffer
+#define glBindRenderbuffer nullgl::BindRenderbuffer
+#undef glBindTexture
+#define glBindTexture nullgl::BindTexture
+#undef glBindVertexArray
+#define glBindVertexArray nullgl::BindVertexArray
+#undef glBufferData
+#define glBufferData nullgl::BufferData
+#undef glBufferSubData
+#define glBufferSubData nullgl::BufferSubData
+#undef glCheckFramebufferStatus
+#define glCheckFramebufferStatus nullgl::CheckFramebufferStatus
+#undef glClear
+#define glClear nullgl::Clear
+#undef glClearColor
+#define glClearColor nullgl::ClearColor
+#undef glColorMask
+#define glColorMask nullgl::ColorMask
+#undef glCompileShader
+#define glCompileShader nullgl::CompileShader
+#undef glCreateProgram
+#define glCreateProgram nullgl::CreateProgram
+#undef glCreateShader
+#define glCreateShader nullgl::CreateShader
+#undef glCullFace
+#define glCullFace nullgl::CullFace
+#undef glDeleteBuffers
+#define glDeleteBuffers nullgl::DeleteBuffers
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers nullgl::DeleteFramebuffers
+#undef glDeleteProgram
+#define glDeleteProgram nullgl::DeleteProgram
+#undef glDeleteQueries
+#define glDeleteQueries nullgl::DeleteQueries
+#undef glDeleteRenderbuffers
+#define glDeleteRenderbuffers nullgl::DeleteRenderbuffers
+#undef glDeleteShader
+#define glDeleteShader nullgl::DeleteShader
+#undef glDeleteTextures
+#define glDeleteTextures nullgl::DeleteTextures
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays nullgl::DeleteVertexArrays
+#undef glDepthFunc
+#define glDepthFunc nullgl::DepthFunc
+#undef glDepthMask
+#define glDepthMask nullgl::DepthMask
+#undef glDepthRange
+#define glDepthRange nullgl::DepthRange
+#undef glDetachShader
+#define glDetachShader nullgl::DetachShader
+#undef glDisable
+#define glDisable nullgl::Disable
+#undef glDrawArrays
+#define glDrawArrays nullgl::DrawArrays
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced nullgl::DrawArraysInstanced
+#undef glDrawElements
+#define glDrawElements nullgl::DrawElements
+#undef glEnable
+#define glEnable nullgl::Enable
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray nullgl::EnableVertexAttribArray
+#undef glFlush
+#define glFlush nullgl::Flush
+#undef glFramebufferRenderbuffer
+#define glFramebufferRenderbuffer nullgl::FramebufferRenderbuffer
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D nullgl::FramebufferTexture2D
+#undef glFrontFace
+#define glFrontFace nullgl::FrontFace
+#undef glGenBuffers
+#define glGenBuffers nullgl::GenBuffers
+#undef glGenFramebuffers
+#define glGenFramebuffers nullgl::GenFramebuffers
+#undef glGenQueries
+#define glGenQueries nullgl::GenQueries
+#undef glGenRenderbuffers
+#define glGenRenderbuffers nullgl::GenRenderbuffers
+#undef glGenTextures
+#define glGenTextures nullgl::GenTextures
+#undef glGenVertexArrays
+#define glGenVertexArrays nullgl::GenVertexArrays
+#undef glGenerateMipmap
+#define glGenerateMipmap nullgl::GenerateMipmap
+#undef glGetFloatv
+#define glGetFloatv nullgl::GetFloatv
+#undef glGetInteger64v
+#define glGetInteger64v nullgl::GetInteger64v
+#undef glGetProgramInfoLog
+#define glGetProgramInfoLog nullgl::GetProgramInfoLog
+#undef glGetProgramiv
+#define glGetProgramiv nullgl::GetProgramiv
+#undef glGetQueryObjectiv
+#define glGetQueryObjectiv nullgl::GetQueryObjectiv
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v nullgl::GetQueryObjectui64v
+#undef glGetShaderInfoLog
+#define glGetShaderInfoLog nullgl::GetShaderInfoLog
+#undef glGetShaderiv
+#define glGetShaderiv nullgl::GetShaderiv
+#undef glGetUniformBlockIndex
+#define glGetUniformBlockIndex nullgl::GetUniformBlockIndex
+#undef glGetUniformLocation
+#define glGetUniformLocation nullgl::GetUniformLocation
+#undef glLinkProgram
+#define glLinkProgram nullgl::LinkProgram
+#undef glObjectLabel
+#define glObjectLabel nullgl::ObjectLabel
+#undef glPixelStorei
+#define glPixelStorei nullgl::PixelStorei
+#undef glQueryCounter
+#define glQueryCounter nullgl::QueryCounter
+#undef glReadPixels
+#define glReadPixels nullgl::ReadPixels
+#undef glRenderbufferStorage
+#define glRenderbufferStorage nullgl::RenderbufferStorage
+#undef glShaderSource
+#define glShaderSource nullgl::ShaderSource
+#undef glTexImage2D
+#define glTexImage2D nullgl::TexImage2D
+#undef glTexParameteri
+#define glTexParameteri nullgl::TexParameteri
+#undef glUniform1f
+#define glUniform1f nullgl::Uniform1f
+#undef glUniform1i
+#define glUniform1i nullgl::Uniform1i
+#undef glUniform2f
+#define glUniform2f nullgl::Uniform2f
+#undef glUniform3fv
+#define glUniform3fv nullgl::Uniform3fv
+#undef glUniformBlockBinding
+#define glUniformBlockBinding nullgl::UniformBlockBinding
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv nullgl::UniformMatrix4fv
+#undef glUseProgram
+#define glUseProgram nullgl::UseProgram
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor nullgl::VertexAttribDivisor
+#undef glVertexAttribPointer
+#define glVertexAttribPointer nullgl::VertexAttribPointer
+#undef glViewport
+#define glViewport nullgl::Viewport
+#endif // GL_NULL_DISPATCH
+
+#endif // CLIONPROJECTS_GL_DISPATCH_H
@@ -0,0 +1,274 @@
+// --- Instanced drawing with orientations interpolated on the GPU --- \\
+
+#include "gpu_orientations.h"
+#include "logger.h"
+#include "profiler.h"
+#include "render_stats.h"
+#include "libraries/glm-master/glm/ext.hpp"
+#include <algorithm>
+
+namespace {
+    const char* g_gpuOrientationsVertexShaderSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 vertexPosition;
+        layout (location = 1) in vec3 vertexColour;
+        layout (location = 2) in vec3 instancePosition;
+        layout (location = 3) in vec4 instanceStart;
+        layout (location = 4) in vec4 instanceTarget;
+        layout (location = 5) in vec2 instanceTiming;
+        out vec3 vertex_colour;
+        uniform float fElapsedTime;
+        uniform bool bSlerp;
+        uniform float slerpThreshold;
+        uniform mat4 meshMatrix;
+        uniform mat4 parentMatrix;
+        layout(std140) uniform GlobalMatrices {
+            mat4 viewMatrix;
+            mat4 projectionMatrix;
+        };
+
+        // Quaternions are (x, y, z, w); both ways take the shorter arc.
+        vec4 interpolate(vec4 from, vec4 to, float alpha) {
+            float cosTheta = dot(from, to);
+            if (cosTheta < 0.0f) {
+                to = -to;
+                cosTheta = -cosTheta;
+            }
+            if (bSlerp && cosTheta < slerpThreshold) {
+                float theta = acos(cosTheta);
+                return (sin((1.0f - alpha) * theta) * from + sin(alpha * theta) * to) / sin(theta);
+            }
+            return normalize(mix(from, to, alpha));
+        }
+
+        vec3 rotate(vec4 quat, vec3 v) {
+            vec3 t = 2.0f * cross(quat.xyz, v);
+            return v + quat.w * t + cross(quat.xyz, t);
+        }
+
+        void main() {
+            // instanceTiming is the start time and 1 / duration; at rest it is 0 and alpha stays 0.
+            float alpha = clamp((fElapsedTime - instanceTiming.x) * instanceTiming.y, 0.0f, 1.0f);
+            vec4 orientation = interpolate(instanceStart, instanceTarget, alpha);
+            vec3 position = instancePosition + rotate(orientation, (meshMatrix * vec4(vertexPosition, 1.0f)).xyz);
+            gl_Position = projectionMatrix * viewMatrix * parentMatrix * vec4(position, 1.0f);
+            vertex_colour = vertexColour;
+        }
+    )";
+
+    const char* g_gpuOrientationsFragmentShaderSource = R"(
+        #version 330 core
+        in vec3 vertex_colour;
+        out vec4 FragColour;
+
+        void main() {
+            FragColour = vec4(vertex_colour, 1.0f);
+        }
+    )";
+
+    constexpr size_t g_iFloatsPerInstance = 10;
+
+    GLuint compileGpuOrientationsShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint compileStatus;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+        if (compileStatus == GL_FALSE) {
+            GLint infoLogLength;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+            std::vector<GLchar> infoLog(infoLogLength + 1);
+            glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+            LOG_ERROR("GPU orientation shader compilation error:\n{}", infoLog.data());
+        }
+        return shader;
+    }
+}
+
+GpuOrientations::~GpuOrientations() {
+    // Nothing was allocated if Create() never ran.
+    if (m_program == 0)
+        return;
+
+    glDeleteProgram(m_program);
+    glDeleteBuffers(1, &m_positionVBO);
+    glDeleteBuffers(1, &m_animationVBO);
+    glDeleteVertexArrays(1, &m_vao);
+}
+
+void GpuOrientations::Create(GLuint meshVBO, GLsizei vertexCount, GLuint globalMatricesBindingIndex) {
+    m_vertexCount = vertexCount;
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_positionVBO);
+    glGenBuffers(1, &m_animationVBO);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)nullptr);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    const auto stride = static_cast<GLsizei>(g_iFloatsPerInstance * sizeof(GLfloat));
+    glBindBuffer(GL_ARRAY_BUFFER, m_animationVBO);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)nullptr);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(4 * sizeof(GLfloat)));
+    glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(8 * sizeof(GLfloat)));
+    for (GLuint ixAttribute = 3; ixAttribute <= 5; ixAttribute++) {
+        glEnableVertexAttribArray(ixAttribute);
+        glVertexAttribDivisor(ixAttribute, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    CreateProgram(globalMatricesBindingIndex);
+}
+
+void GpuOrientations::CreateProgram(GLuint globalMatricesBindingIndex) {
+    GLuint vertexShader = compileGpuOrientationsShader(GL_VERTEX_SHADER, g_gpuOrientationsVertexShaderSource);
+    GLuint fragmentShader = compileGpuOrientationsShader(GL_FRAGMENT_SHADER, g_gpuOrientationsFragmentShaderSource);
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vertexShader);
+    glAttachShader(m_program, fragmentShader);
+    glLinkProgram(m_program);
+
+    GLint status;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint infoLogLength;
+        glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &infoLogLength);
+        std::vector<GLchar> infoLog(infoLogLength + 1);
+        glGetProgramInfoLog(m_program, infoLogLength, nullptr, infoLog.data());
+        LOG_ERROR("GPU orientation program linker failure: \n{}", infoLog.data());
+    }
+
+    glDetachShader(m_program, vertexShader);
+    glDetachShader(m_program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    glUniformBlockBinding(m_program, glGetUniformBlockIndex(m_program, "GlobalMatrices"), globalMatricesBindingIndex);
+    m_elapsedTimeLocation = glGetUniformLocation(m_program, "fElapsedTime");
+    m_slerpLocation = glGetUniformLocation(m_program, "bSlerp");
+    m_meshMatrixLocation = glGetUniformLocation(m_program, "meshMatrix");
+    m_parentMatrixLocation = glGetUniformLocation(m_program, "parentMatrix");
+
+    glUseProgram(m_program);
+    glUniform1f(glGetUniformLocation(m_program, "slerpThreshold"), g_fSlerpThreshold);
+    glUniformMatrix4fv(m_meshMatrixLocation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    glUseProgram(0);
+}
+
+void GpuOrientations::SetMeshMatrix(const glm::mat4& meshMatrix) {
+    glUseProgram(m_program);
+    glUniformMatrix4fv(m_meshMatrixLocation, 1, GL_FALSE, glm::value_ptr(meshMatrix));
+    glUseProgram(0);
+}
+
+void GpuOrientations::SetPositions(const std::vector<glm::vec3>& positions) {
+    const auto size = static_cast<GLsizeiptr>(positions.size() * sizeof(glm::vec3));
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionVBO);
+    if (positions.size() == m_positionCount)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, positions.data());
+    else
+        glBufferData(GL_ARRAY_BUFFER, size, positions.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_positionCount = positions.size();
+
+    g_renderStats.CountBufferUpload(static_cast<std::uint64_t>(size));
+    g_renderStats.CountStateChange(2);
+}
+
+void GpuOrientations::WriteInstance(const AnimationSystem& animations, size_t ix) {
+    const auto handle = static_cast<AnimationSystem::Handle>(ix);
+    const QuatArray& start = animations.GetStartOrientations();
+    const QuatArray& target = animations.GetTargetOrientations();
+    const double fInvDuration = animations.GetInvDuration(handle) * 1.0e9;
+    const double fStartTime = std::chrono::duration<double>(animations.GetStartTime(handle) - m_epoch).count();
+
+    GLfloat* instance = &m_instances[ix * g_iFloatsPerInstance];
+    instance[0] = start.x[ix];
+    instance[1] = start.y[ix];
+    instance[2] = start.z[ix];
+    instance[3] = start.w[ix];
+    instance[4] = target.x[ix];
+    instance[5] = target.y[ix];
+    instance[6] = target.z[ix];
+    instance[7] = target.w[ix];
+    instance[8] = fInvDuration > 0.0 ? static_cast<GLfloat>(fStartTime) : 0.0f;
+    instance[9] = static_cast<GLfloat>(fInvDuration);
+}
+
+void GpuOrientations::Update(AnimationSystem& animations, FrameClock::TimePoint now) {
+    PROFILE_FUNCTION();
+    const size_t count = animations.Size();
+    const bool bUploadAll = count != m_instanceCount || animations.IsAllChanged() ||
+                            now - m_epoch > g_maxEpochAge;
+    if (!bUploadAll && animations.GetChanged().empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_animationVBO);
+    if (bUploadAll) {
+        m_epoch = now;
+        m_instanceCount = count;
+        m_instances.resize(count * g_iFloatsPerInstance);
+        for (size_t ix = 0; ix < count; ix++)
+            WriteInstance(animations, ix);
+        const auto size = static_cast<GLsizeiptr>(m_instances.size() * sizeof(GLfloat));
+        glBufferData(GL_ARRAY_BUFFER, size, m_instances.data(), GL_DYNAMIC_DRAW);
+        g_renderStats.CountBufferUpload(static_cast<std::uint64_t>(size));
+    }
+    else {
+        m_changed = animations.GetChanged();
+        std::sort(m_changed.begin(), m_changed.end());
+        for (AnimationSystem::Handle handle : m_changed)
+            WriteInstance(animations, handle);
+
+        // One upload per run of changes, bridging short gaps
+        for (size_t ixRun = 0; ixRun < m_changed.size();) {
+            const size_t ixBegin = m_changed[ixRun];
+            size_t ixEnd = ixBegin + 1;
+            while (++ixRun < m_changed.size() && m_changed[ixRun] <= ixEnd + g_iMergeGap)
+                ixEnd = m_changed[ixRun] + 1;
+
+            const auto offset = static_cast<GLintptr>(ixBegin * g_iFloatsPerInstance * sizeof(GLfloat));
+            const auto size = static_cast<GLsizeiptr>((ixEnd - ixBegin) * g_iFloatsPerInstance * sizeof(GLfloat));
+            glBufferSubData(GL_ARRAY_BUFFER, offset, size, &m_instances[ixBegin * g_iFloatsPerInstance]);
+            g_renderStats.CountBufferUpload(static_cast<std::uint64_t>(size));
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    g_renderStats.CountStateChange(2);
+
+    animations.ClearChanged();
+}
+
+void GpuOrientations::Draw(FrameClock::TimePoint now, AnimationSystem::Interpolation interpolation,
+                           const glm::mat4& parentMatrix) {
+    PROFILE_FUNCTION();
+    const auto instanceCount = static_cast<GLsizei>(std::min(m_instanceCount, m_positionCount));
+    if (instanceCount == 0)
+        return;
+
+    glUseProgram(m_program);
+    glUniform1f(m_elapsedTimeLocation, static_cast<GLfloat>(std::chrono::duration<double>(now - m_epoch).count()));
+    glUniform1i(m_slerpLocation, interpolation != AnimationSystem::Interpolation::NLERP);
+    glUniformMatrix4fv(m_parentMatrixLocation, 1, GL_FALSE, glm::value_ptr(parentMatrix));
+    glBindVertexArray(m_vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, m_vertexCount, instanceCount);
+    glBindVertexArray(0);
+
+    g_renderStats.CountProgramBind();
+    g_renderStats.CountUniformUpload(3);
+    g_renderStats.CountStateChange(2);
+    g_renderStats.CountDraw(GL_TRIANGLES, m_vertexCount, instanceCount);
+}
@@ -0,0 +1,78 @@
+// --- Declares the instanced renderer that interpolates orientations on the GPU --- \\
+
+#ifndef CLIONPROJECTS_GPU_ORIENTATIONS_H
+#define CLIONPROJECTS_GPU_ORIENTATIONS_H
+#include "gl_dispatch.h"
+#include "libraries/glm-master/glm/glm.hpp"
+#include "animation_system.h"
+#include "frame_clock.h"
+#include <vector>
+
+// Draws a mesh once per object of an AnimationSystem in a single instanced call, with the vertex
+// shader working out each object's orientation from fElapsedTime. Every instance carries its
+// animation's start and target orientations, start time and 1 / duration, which are uploaded
+// when the animation is set and not again until it changes, so with the system deferring its
+// interpolation (AnimationSystem::SetDeferInterpolation) a frame in which no animation starts
+// costs the CPU one uniform and one draw call however many objects are turning.
+//
+// The shader takes the shorter arc, as the batched kernels do, and slerps (falling back to nlerp
+// for nearly parallel pairs) unless the system nlerps; fast slerp is drawn as exact slerp. Times
+// are float seconds since an epoch that moves up to now whenever everything is uploaded, and at
+// least every g_maxEpochAge, so they stay accurate to well under a millisecond.
+class GpuOrientations {
+public:
+    GpuOrientations() = default;
+    ~GpuOrientations();
+
+    GpuOrientations(const GpuOrientations&) = delete;
+    GpuOrientations& operator=(const GpuOrientations&) = delete;
+
+    // Sets up instanced drawing of the vertexCount vertices in meshVBO, interleaved position (3)
+    // and colour (3) floats, and builds the program, which reads the view and projection matrices
+    // from the uniform block bound at globalMatricesBindingIndex.
+    void Create(GLuint meshVBO, GLsizei vertexCount, GLuint globalMatricesBindingIndex);
+    [[nodiscard]] bool IsCreated() const {return m_program != 0;}
+
+    // Applied to the mesh before it is oriented and placed (its scale, for one)
+    void SetMeshMatrix(const glm::mat4& meshMatrix);
+    // Instance i sits at positions[i].
+    void SetPositions(const std::vector<glm::vec3>& positions);
+
+    // Uploads every animation set in animations since the last call, and clears its changes. Call
+    // before Draw() in any frame that might have set one.
+    void Update(AnimationSystem& animations, FrameClock::TimePoint now);
+    // Draws the instances as of now, each placed by parentMatrix * translate(position) *
+    // orientation * meshMatrix.
+    void Draw(FrameClock::TimePoint now, AnimationSystem::Interpolation interpolation,
+              const glm::mat4& parentMatrix = glm::mat4(1.0f));
+
+    static constexpr FrameClock::Duration g_maxEpochAge = std::chrono::hours(1);
+    // Changed instances this close together go up in one upload, unchanged ones between included.
+    static constexpr size_t g_iMergeGap = 64;
+
+private:
+    void CreateProgram(GLuint globalMatricesBindingIndex);
+    // Fills in instance ix's record from animations
+    void WriteInstance(const AnimationSystem& animations, size_t ix);
+
+    GLuint m_program = 0;
+    GLuint m_vao = 0;
+    GLuint m_positionVBO = 0;
+    GLuint m_animationVBO = 0;
+    GLsizei m_vertexCount = 0;
+    GLint m_elapsedTimeLocation = -1;
+    GLint m_slerpLocation = -1;
+    GLint m_meshMatrixLocation = -1;
+    GLint m_parentMatrixLocation = -1;
+
+    // Per instance: start and target orientations (x y z w each), start time and 1 / duration,
+    // as the buffer holds them
+    std::vector<GLfloat> m_instances;
+    size_t m_instanceCount = 0;
+    size_t m_positionCount = 0;
+    FrameClock::TimePoint m_epoch{};
+    // Scratch for Update(): the changed instances in order
+    std::vector<AnimationSystem::Handle> m_changed;
+};
+
+#endif // CLIONPROJECTS_GPU_ORIENTATIONS_H
@@ -0,0 +1,162 @@
+// --- GPU pass timer built on timestamp queries --- \\
+
+#include "gpu_timer.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <string_view>
+
+namespace {
+    // The GPU and CPU clocks drift apart slowly; re-pairing them this often keeps the trace aligned.
+    const std::uint64_t g_iClockSyncInterval = 120;
+
+    double Percentile(const std::vector<double>& sortedSamples, double fraction) {
+        size_t ix = static_cast<size_t>(std::lround(fraction * static_cast<double>(sortedSamples.size() - 1)));
+        return sortedSamples[ix];
+    }
+}
+
+GpuTimer::GpuTimer(int frameLatency, int maxPassesPerFrame, int historySize)
+        : m_frameLatency(std::max(frameLatency, 2)), m_maxPassesPerFrame(maxPassesPerFrame),
+          m_historySize(historySize) {}
+
+GpuTimer::~GpuTimer() {
+    if (!m_queries.empty())
+        glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void GpuTimer::Create() {
+    m_queries.resize(static_cast<size_t>(m_frameLatency) * m_maxPassesPerFrame * 2);
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+    m_slots.resize(m_frameLatency);
+    SynchroniseClocks();
+}
+
+void GpuTimer::SynchroniseClocks() {
+    GLint64 gpuTimeNs = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuTimeNs);
+    m_gpuClockOffsetNs = gpuTimeNs - Profiler::NowNs();
+}
+
+void GpuTimer::BeginFrame() {
+    if (!IsEnabled())
+        return;
+
+    m_ixSlot = static_cast<int>(m_frameCount % m_frameLatency);
+    CollectSlot(m_slots[m_ixSlot]);
+    m_openPasses.clear();
+
+    if (m_frameCount % g_iClockSyncInterval == 0)
+        SynchroniseClocks();
+    m_frameCount++;
+}
+
+void GpuTimer::CollectSlot(FrameSlot& slot) {
+    if (slot.passes.empty())
+        return;
+
+    // Queries complete in order, so the last one issued tells whether the whole frame is available.
+    GLint bAvailable = GL_FALSE;
+    glGetQueryObjectiv(m_queries[slot.ixLastIssuedQuery], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+
+    if (bAvailable) {
+        // By name rather than by pointer: the same literal need not have one address everywhere
+        std::map<std::string_view, double> frameTotalsMs;
+        for (const Pass& pass : slot.passes) {
+            if (pass.ixEndQuery < 0)
+                continue;
+
+            GLuint64 beginNs = 0, endNs = 0;
+            glGetQueryObjectui64v(m_queries[pass.ixBeginQuery], GL_QUERY_RESULT, &beginNs);
+            glGetQueryObjectui64v(m_queries[pass.ixEndQuery], GL_QUERY_RESULT, &endNs);
+            frameTotalsMs[pass.name] += static_cast<double>(endNs - beginNs) / 1.0e6;
+
+            Profiler::Get().RecordGpu(pass.name, static_cast<std::int64_t>(beginNs) - m_gpuClockOffsetNs,
+                                      static_cast<std::int64_t>(endNs) - m_gpuClockOffsetNs);
+        }
+
+        for (const auto& [name, totalMs] : frameTotalsMs) {
+            History& history = m_history[std::string(name)];
+            if (static_cast<int>(history.samplesMs.size()) < m_historySize)
+                history.samplesMs.push_back(totalMs);
+            else
+                history.samplesMs[history.ixNext] = totalMs;
+            history.ixNext = (history.ixNext + 1) % m_historySize;
+        }
+    }
+    else {
+        m_droppedFrames++;
+    }
+
+    slot.passes.clear();
+    slot.queryCount = 0;
+    slot.ixLastIssuedQuery = -1;
+}
+
+void GpuTimer::BeginPass(const char* name) {
+    if (!IsEnabled())
+        return;
+
+    FrameSlot& slot = m_slots[m_ixSlot];
+    if (slot.queryCount + 2 > m_maxPassesPerFrame * 2) {
+        m_openPasses.push_back(-1);
+        return;
+    }
+
+    int ixQuery = m_ixSlot * m_maxPassesPerFrame * 2 + slot.queryCount++;
+    glQueryCounter(m_queries[ixQuery], GL_TIMESTAMP);
+    slot.ixLastIssuedQuery = ixQuery;
+    m_openPasses.push_back(static_cast<int>(slot.passes.size()));
+    // Reserve the end query now so the slot never runs out between a begin and its end.
+    slot.queryCount++;
+    slot.passes.push_back({name, ixQuery, -1});
+}
+
+void GpuTimer::EndPass() {
+    if (!IsEnabled() || m_openPasses.empty())
+        return;
+
+    int ixPass = m_openPasses.back();
+    m_openPasses.pop_back();
+    if (ixPass < 0)
+        return;
+
+    FrameSlot& slot = m_slots[m_ixSlot];
+    Pass& pass = slot.passes[ixPass];
+    pass.ixEndQuery = pass.ixBeginQuery + 1;
+    glQueryCounter(m_queries[pass.ixEndQuery], GL_TIMESTAMP);
+    slot.ixLastIssuedQuery = pass.ixEndQuery;
+}
+
+GpuTimer::PassStats GpuTimer::GetPassStats(const std::string& name) const {
+    PassStats stats;
+    auto it = m_history.find(name);
+    if (it == m_history.end() || it->second.samplesMs.empty())
+        return stats;
+
+    std::vector<double> samples = it->second.samplesMs;
+    std::sort(samples.begin(), samples.end());
+    double totalMs = 0.0;
+    for (double sampleMs : samples)
+        totalMs += sampleMs;
+
+    stats.sampleCount = static_cast<int>(samples.size());
+    stats.averageMs = totalMs / static_cast<double>(samples.size());
+    stats.p50Ms = Percentile(samples, 0.50);
+    stats.p95Ms = Percentile(samples, 0.95);
+    stats.p99Ms = Percentile(samples, 0.99);
+    return stats;
+}
+
+void GpuTimer::PrintReport(std::ostream& out) const {
+    out << "GPU passes (last " << m_historySize << " frames, " << m_droppedFrames << " dropped):\n";
+    out << std::fixed << std::setprecision(3);
+    for (const auto& [name, history] : m_history) {
+        PassStats stats = GetPassStats(name);
+        out << "  " << std::left << std::setw(20) << name << std::right
+            << " avg " << stats.averageMs << " ms, p50 " << stats.p50Ms << " ms, p95 " << stats.p95Ms
+            << " ms, p99 " << stats.p99Ms << " ms\n";
+    }
+}
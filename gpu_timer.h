@@ -0,0 +1,99 @@
+// --- Declares the GPU pass timer --- \\
+
+#ifndef CLIONPROJECTS_GPU_TIMER_H
+#define CLIONPROJECTS_GPU_TIMER_H
+#include "gl_dispatch.h"
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Measures how long the GPU spends on named passes with pairs of GL_TIMESTAMP queries. Queries
+// live in a ring of frameLatency frames; a frame's results are only read back when its ring slot
+// comes round again, by which time the GPU has normally finished with them, so the CPU never
+// waits on the GPU. If a slot's results are still not available they are dropped instead.
+//
+// Each pass keeps its last historySize per-frame totals for averages and percentiles, and every
+// measured pass is also handed to the Profiler so it shows up on a GPU track of the CPU trace.
+class GpuTimer {
+public:
+    explicit GpuTimer(int frameLatency = 4, int maxPassesPerFrame = 32, int historySize = 240);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // Allocates the queries; needs a context. Until then (or when disabled) every call is a no-op.
+    void Create();
+    [[nodiscard]] bool IsEnabled() const {return !m_queries.empty();}
+
+    // Collects the results of the frame that last used this ring slot and starts a new frame.
+    void BeginFrame();
+
+    // Passes may nest. name must outlive the timer, so use string literals.
+    void BeginPass(const char* name);
+    void EndPass();
+
+    struct PassStats {
+        double averageMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        int sampleCount = 0;
+    };
+    [[nodiscard]] PassStats GetPassStats(const std::string& name) const;
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct Pass {
+        const char* name;
+        int ixBeginQuery;
+        int ixEndQuery;
+    };
+
+    struct FrameSlot {
+        std::vector<Pass> passes;
+        int queryCount = 0;
+        int ixLastIssuedQuery = -1;
+    };
+
+    struct History {
+        std::vector<double> samplesMs;
+        int ixNext = 0;
+    };
+
+    void CollectSlot(FrameSlot& slot);
+    void SynchroniseClocks();
+
+    int m_frameLatency;
+    int m_maxPassesPerFrame;
+    int m_historySize;
+
+    std::vector<GLuint> m_queries;
+    std::vector<FrameSlot> m_slots;
+    int m_ixSlot = 0;
+    std::vector<int> m_openPasses;
+    std::uint64_t m_frameCount = 0;
+    std::uint64_t m_droppedFrames = 0;
+
+    // GPU timestamp minus profiler time, both in nanoseconds.
+    std::int64_t m_gpuClockOffsetNs = 0;
+
+    std::map<std::string, History> m_history;
+};
+
+// Times the enclosing block as a GPU pass.
+class GpuPassScope {
+public:
+    GpuPassScope(GpuTimer& timer, const char* name) : m_timer(timer) {m_timer.BeginPass(name);}
+    ~GpuPassScope() {m_timer.EndPass();}
+
+    GpuPassScope(const GpuPassScope&) = delete;
+    GpuPassScope& operator=(const GpuPassScope&) = delete;
+
+private:
+    GpuTimer& m_timer;
+};
+
+#endif // CLIONPROJECTS_GPU_TIMER_H
@@ -0,0 +1,286 @@
+// --- Impostor atlas capture and instanced billboard drawing --- \\
+
+#include "impostor.h"
+#include "logger.h"
+#include "profiler.h"
+#include "render_stats.h"
+#include "libraries/glm-master/glm/ext.hpp"
+#include <cmath>
+
+namespace {
+    const char* g_impostorVertexShaderSource = R"(
+        #version 330 core
+        layout (location = 0) in vec2 quadCorner;
+        layout (location = 1) in vec4 instanceCentreRadius;
+        layout (location = 2) in vec2 instanceVariantFade;
+        out vec2 cellCoord;
+        out vec2 atlasColumnRow;
+        out float rowBlend;
+        out float fade;
+        uniform vec3 cameraPosition;
+        uniform float elevationCount;
+        uniform float maxElevation;
+        layout(std140) uniform GlobalMatrices {
+            mat4 viewMatrix;
+            mat4 projectionMatrix;
+        };
+
+        void main() {
+            vec3 centre = instanceCentreRadius.xyz;
+            vec3 toCamera = normalize(cameraPosition - centre);
+            vec3 right = cross(vec3(0.0f, 1.0f, 0.0f), toCamera);
+            right = length(right) > 1e-4f ? normalize(right) : vec3(1.0f, 0.0f, 0.0f);
+            vec3 up = cross(toCamera, right);
+
+            vec3 position = centre + (quadCorner.x * right + quadCorner.y * up) * instanceCentreRadius.w;
+            gl_Position = projectionMatrix * viewMatrix * vec4(position, 1.0f);
+
+            // Pick the two captured elevations either side of the current one.
+            float elevation = asin(clamp(toCamera.y, 0.0f, 1.0f));
+            float row = clamp(elevation / maxElevation, 0.0f, 1.0f) * (elevationCount - 1.0f);
+            atlasColumnRow = vec2(instanceVariantFade.x, min(floor(row), elevationCount - 2.0f));
+            rowBlend = row - atlasColumnRow.y;
+            cellCoord = quadCorner * 0.5f + 0.5f;
+            fade = instanceVariantFade.y;
+        }
+    )";
+
+    const char* g_impostorFragmentShaderSource = R"(
+        #version 330 core
+        in vec2 cellCoord;
+        in vec2 atlasColumnRow;
+        in float rowBlend;
+        in float fade;
+        out vec4 FragColour;
+        uniform sampler2D atlas;
+        uniform vec2 atlasCellCount;
+        uniform float cellSize;
+
+        // Ordered dither threshold; the geometry pass discards the complementary pixels.
+        float ditherThreshold() {
+            const float bayer[16] = float[16](0.0f, 8.0f, 2.0f, 10.0f, 12.0f, 4.0f, 14.0f, 6.0f,
+                                              3.0f, 11.0f, 1.0f, 9.0f, 15.0f, 7.0f, 13.0f, 5.0f);
+            ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+            return (bayer[pixel.y * 4 + pixel.x] + 0.5f) / 16.0f;
+        }
+
+        void main() {
+            if (fade <= ditherThreshold())
+                discard;
+
+            // Keep samples half a texel inside the cell so neighbours don't bleed in.
+            vec2 inset = clamp(cellCoord, vec2(0.5f / cellSize), vec2(1.0f - 0.5f / cellSize));
+            vec4 lower = texture(atlas, (atlasColumnRow + inset) / atlasCellCount);
+            vec4 upper = texture(atlas, (atlasColumnRow + vec2(0.0f, 1.0f) + inset) / atlasCellCount);
+            vec4 texel = mix(lower, upper, rowBlend);
+            if (texel.a < 0.5f)
+                discard;
+
+            FragColour = vec4(texel.rgb / texel.a, 1.0f);
+        }
+    )";
+
+    GLuint compileImpostorShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint compileStatus;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+        if (compileStatus == GL_FALSE) {
+            GLint infoLogLength;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+            std::vector<GLchar> infoLog(infoLogLength + 1);
+            glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+            LOG_ERROR("Impostor shader compilation error:\n{}", infoLog.data());
+        }
+        return shader;
+    }
+}
+
+ImpostorAtlas::ImpostorAtlas(int elevationCount, int cellSize)
+        : m_elevationCount(elevationCount < 2 ? 2 : elevationCount), m_cellSize(cellSize) {}
+
+ImpostorAtlas::~ImpostorAtlas() {
+    // Nothing was allocated if Create() never ran (or there is no context left to free it from).
+    if (m_program == 0)
+        return;
+
+    glDeleteProgram(m_program);
+    glDeleteBuffers(1, &m_quadVBO);
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteVertexArrays(1, &m_quadVAO);
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+    glDeleteTextures(1, &m_atlasTexture);
+}
+
+void ImpostorAtlas::Create(int variantCount, GLuint globalMatricesBindingIndex) {
+    m_variantCount = variantCount;
+    const int atlasWidth = m_variantCount * m_cellSize;
+    const int atlasHeight = m_elevationCount * m_cellSize;
+
+    glGenTextures(1, &m_atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasWidth, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Stop before the mips get so small that neighbouring cells blend together.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasWidth, atlasHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_atlasTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_ERROR("Impostor atlas framebuffer is incomplete");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Unit quad as a triangle strip, corners in [-1, 1].
+    const GLfloat quadCorners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+
+    glGenVertexArrays(1, &m_quadVAO);
+    glGenBuffers(1, &m_quadVBO);
+    glGenBuffers(1, &m_instanceVBO);
+
+    glBindVertexArray(m_quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadCorners), quadCorners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)nullptr);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)nullptr);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(4 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribDivisor(2, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    CreateProgram(globalMatricesBindingIndex);
+}
+
+void ImpostorAtlas::CreateProgram(GLuint globalMatricesBindingIndex) {
+    GLuint vertexShader = compileImpostorShader(GL_VERTEX_SHADER, g_impostorVertexShaderSource);
+    GLuint fragmentShader = compileImpostorShader(GL_FRAGMENT_SHADER, g_impostorFragmentShaderSource);
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vertexShader);
+    glAttachShader(m_program, fragmentShader);
+    glLinkProgram(m_program);
+
+    GLint status;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint infoLogLength;
+        glGetProgramiv(m_program, GL_INFO_LOG_LENGTH, &infoLogLength);
+        std::vector<GLchar> infoLog(infoLogLength + 1);
+        glGetProgramInfoLog(m_program, infoLogLength, nullptr, infoLog.data());
+        LOG_ERROR("Impostor program linker failure: \n{}", infoLog.data());
+    }
+
+    glDetachShader(m_program, vertexShader);
+    glDetachShader(m_program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    glUniformBlockBinding(m_program, glGetUniformBlockIndex(m_program, "GlobalMatrices"), globalMatricesBindingIndex);
+    m_cameraPositionLocation = glGetUniformLocation(m_program, "cameraPosition");
+
+    glUseProgram(m_program);
+    glUniform1i(glGetUniformLocation(m_program, "atlas"), 0);
+    glUniform2f(glGetUniformLocation(m_program, "atlasCellCount"), static_cast<float>(m_variantCount),
+                static_cast<float>(m_elevationCount));
+    glUniform1f(glGetUniformLocation(m_program, "cellSize"), static_cast<float>(m_cellSize));
+    glUniform1f(glGetUniformLocation(m_program, "elevationCount"), static_cast<float>(m_elevationCount));
+    glUniform1f(glGetUniformLocation(m_program, "maxElevation"), glm::radians(g_fMaxElevationDegrees));
+    glUseProgram(0);
+}
+
+void ImpostorAtlas::BeginBake() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_variantCount * m_cellSize, m_elevationCount * m_cellSize);
+
+    // Transparent background, the billboard shader alpha tests against it.
+    GLfloat clearColour[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColour);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(clearColour[0], clearColour[1], clearColour[2], clearColour[3]);
+}
+
+void ImpostorAtlas::BindCell(int ixVariant, int ixElevation) const {
+    glViewport(ixVariant * m_cellSize, ixElevation * m_cellSize, m_cellSize, m_cellSize);
+}
+
+float ImpostorAtlas::GetElevationRadians(int ixElevation) const {
+    return glm::radians(g_fMaxElevationDegrees) * static_cast<float>(ixElevation) /
+           static_cast<float>(m_elevationCount - 1);
+}
+
+glm::mat4 ImpostorAtlas::GetCellViewMatrix(int ixElevation, const glm::vec3& centre, float radius) const {
+    // Any azimuth will do; the billboard's right vector is cross(up, toCamera) like lookAt's.
+    float fElevation = GetElevationRadians(ixElevation);
+    glm::vec3 toCamera(0.0f, std::sin(fElevation), std::cos(fElevation));
+    return glm::lookAt(centre + toCamera * (2.0f * radius), centre, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+glm::mat4 ImpostorAtlas::GetCellProjectionMatrix(float radius) {
+    return glm::ortho(-radius, radius, -radius, radius, 0.5f * radius, 3.5f * radius);
+}
+
+void ImpostorAtlas::EndBake() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ImpostorAtlas::ClearInstances() {
+    m_instances.clear();
+}
+
+void ImpostorAtlas::AddInstance(const glm::vec3& centre, float radius, int ixVariant, float fade) {
+    m_instances.insert(m_instances.end(), {centre.x, centre.y, centre.z, radius,
+                                           static_cast<GLfloat>(ixVariant), fade});
+}
+
+void ImpostorAtlas::Draw(const glm::vec3& cameraPosition) {
+    PROFILE_SCOPE("ImpostorAtlas::Draw");
+    if (m_instances.empty())
+        return;
+
+    glUseProgram(m_program);
+    glUniform3fv(m_cameraPositionLocation, 1, glm::value_ptr(cameraPosition));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+
+    glBindVertexArray(m_quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_instances.size() * sizeof(GLfloat)),
+                 m_instances.data(), GL_STREAM_DRAW);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GetInstanceCount());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    g_renderStats.CountProgramBind();
+    g_renderStats.CountUniformUpload();
+    g_renderStats.CountBufferUpload(m_instances.size() * sizeof(GLfloat));
+    g_renderStats.CountStateChange(7);
+    g_renderStats.CountDraw(GL_TRIANGLE_STRIP, 4, GetInstanceCount());
+}
@@ -0,0 +1,67 @@
+// --- Declares the impostor atlas and billboard renderer --- \\
+
+#ifndef CLIONPROJECTS_IMPOSTOR_H
+#define CLIONPROJECTS_IMPOSTOR_H
+#include "gl_dispatch.h"
+#include "libraries/glm-master/glm/glm.hpp"
+#include <vector>
+
+// Sprites of rotationally symmetric objects (the trees) captured at start-up and drawn as
+// camera-facing quads. The atlas holds one column per object variant and one row per camera
+// elevation; since the objects look the same from every azimuth, elevation is the only view
+// dependent parameter. Each cell is an orthographic capture of the object's bounding sphere.
+class ImpostorAtlas {
+public:
+    explicit ImpostorAtlas(int elevationCount = 8, int cellSize = 128);
+    ~ImpostorAtlas();
+
+    ImpostorAtlas(const ImpostorAtlas&) = delete;
+    ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+    // Allocates the atlas texture and framebuffer, and builds the billboard program, which reads
+    // the view and projection matrices from the uniform block bound at globalMatricesBindingIndex.
+    void Create(int variantCount, GLuint globalMatricesBindingIndex);
+
+    // Binds and clears the atlas framebuffer. Cells are then filled by drawing the object with the
+    // matrices from GetCellViewMatrix/GetCellProjectionMatrix after BindCell.
+    void BeginBake();
+    void BindCell(int ixVariant, int ixElevation) const;
+    [[nodiscard]] glm::mat4 GetCellViewMatrix(int ixElevation, const glm::vec3& centre, float radius) const;
+    [[nodiscard]] static glm::mat4 GetCellProjectionMatrix(float radius);
+    // Restores the default framebuffer and builds the atlas mipmaps.
+    void EndBake();
+
+    // fade is the impostor's share of a crossfade with the real geometry, in [0, 1].
+    void ClearInstances();
+    void AddInstance(const glm::vec3& centre, float radius, int ixVariant, float fade);
+
+    // Draws every queued instance with a single instanced call.
+    void Draw(const glm::vec3& cameraPosition);
+
+    [[nodiscard]] int GetElevationCount() const {return m_elevationCount;}
+    [[nodiscard]] int GetInstanceCount() const {return static_cast<int>(m_instances.size() / 6);}
+
+    static constexpr float g_fMaxElevationDegrees = 80.0f;
+
+private:
+    [[nodiscard]] float GetElevationRadians(int ixElevation) const;
+    void CreateProgram(GLuint globalMatricesBindingIndex);
+
+    int m_elevationCount;
+    int m_cellSize;
+    int m_variantCount = 0;
+
+    GLuint m_atlasTexture = 0;
+    GLuint m_framebuffer = 0;
+    GLuint m_depthRenderbuffer = 0;
+    GLuint m_program = 0;
+    GLuint m_quadVAO = 0;
+    GLuint m_quadVBO = 0;
+    GLuint m_instanceVBO = 0;
+    GLint m_cameraPositionLocation = -1;
+
+    // Per instance: centre (3), radius, variant, fade.
+    std::vector<GLfloat> m_instances;
+};
+
+#endif // CLIONPROJECTS_IMPOSTOR_H
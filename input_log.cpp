@@ -0,0 +1,211 @@
+// --- Input recorder and replayer --- \\
+
+#include "input_log.h"
+#include "logger.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+InputLog g_inputLog;
+
+namespace {
+    const char g_logMagic[4] = {'G', 'P', 'I', 'L'};
+    const std::uint8_t g_iLogVersion = 1;
+    const size_t g_iHeaderSize = sizeof(g_logMagic) + 1;
+}
+
+InputLog::InputLog() : m_startTime(std::chrono::steady_clock::now()) {}
+
+InputLog::~InputLog() {
+    Finish();
+}
+
+bool InputLog::StartRecording(const std::string& path) {
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr) {
+        LOG_ERROR("Failed to open input log for writing: {}", path);
+        return false;
+    }
+    std::fwrite(g_logMagic, 1, sizeof(g_logMagic), m_file);
+    std::fputc(g_iLogVersion, m_file);
+
+    m_mode = Mode::RECORD;
+    m_startTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool InputLog::StartReplay(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Failed to open input log: {}", path);
+        return false;
+    }
+    m_replay.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (m_replay.size() < g_iHeaderSize || std::memcmp(m_replay.data(), g_logMagic, sizeof(g_logMagic)) != 0 ||
+        m_replay[sizeof(g_logMagic)] != g_iLogVersion) {
+        LOG_ERROR("Not an input log (or an unsupported version): {}", path);
+        return false;
+    }
+
+    // Check the whole log once so that replay never has to stop half way, and count its frames.
+    m_ixReplay = g_iHeaderSize;
+    m_replayFrameCount = 0;
+    bool bEnded = false;
+    while (m_ixReplay < m_replay.size() && !bEnded) {
+        std::uint64_t value;
+        std::int64_t signedValue;
+        bool bValid = true;
+        switch (m_replay[m_ixReplay++]) {
+            case RECORD_FRAME:
+                bValid = ReadVarint(value);
+                m_replayFrameCount++;
+                break;
+            case RECORD_KEY:
+                bValid = ReadSigned(signedValue) && ReadSigned(signedValue) && ReadVarint(value) && ReadVarint(value);
+                break;
+            case RECORD_FRAMEBUFFER_SIZE:
+                bValid = ReadVarint(value) && ReadVarint(value);
+                break;
+            case RECORD_END:
+                bEnded = true;
+                break;
+            default:
+                bValid = false;
+                break;
+        }
+        if (!bValid) {
+            LOG_ERROR("Corrupt input log at byte {}: {}", m_ixReplay, path);
+            return false;
+        }
+    }
+    // A log cut short by a crash is still worth replaying up to its last complete frame.
+    if (!bEnded)
+        LOG_WARN("Input log has no end record, replaying {} frames: {}", m_replayFrameCount, path);
+
+    m_ixReplay = g_iHeaderSize;
+    m_mode = Mode::REPLAY;
+    m_startTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void InputLog::Attach(GLFWwindow* window) {
+    if (m_mode == Mode::OFF)
+        return;
+    m_programKeyCallback = glfwSetKeyCallback(window, KeyCallback);
+    m_programFramebufferSizeCallback = glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+}
+
+void InputLog::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    InputLog& log = g_inputLog;
+    if (log.m_mode == Mode::REPLAY)
+        return;
+    if (log.m_mode == Mode::RECORD) {
+        std::fputc(RECORD_KEY, log.m_file);
+        log.WriteSigned(key);
+        log.WriteSigned(scancode);
+        log.WriteVarint(static_cast<std::uint64_t>(action));
+        log.WriteVarint(static_cast<std::uint64_t>(mods));
+    }
+    if (log.m_programKeyCallback != nullptr)
+        log.m_programKeyCallback(window, key, scancode, action, mods);
+}
+
+void InputLog::FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    InputLog& log = g_inputLog;
+    if (log.m_mode == Mode::REPLAY)
+        return;
+    if (log.m_mode == Mode::RECORD) {
+        std::fputc(RECORD_FRAMEBUFFER_SIZE, log.m_file);
+        log.WriteVarint(static_cast<std::uint64_t>(width));
+        log.WriteVarint(static_cast<std::uint64_t>(height));
+    }
+    if (log.m_programFramebufferSizeCallback != nullptr)
+        log.m_programFramebufferSizeCallback(window, width, height);
+}
+
+void InputLog::BeginFrame(GLFWwindow* window) {
+    if (m_mode == Mode::RECORD) {
+        m_frameTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_startTime);
+        std::fputc(RECORD_FRAME, m_file);
+        WriteVarint(static_cast<std::uint64_t>((m_frameTime - m_lastRecordedFrameTime).count()));
+        m_lastRecordedFrameTime = m_frameTime;
+    }
+    else if (m_mode == Mode::REPLAY) {
+        // Past the end of the log the clock simply stops.
+        while (m_ixReplay < m_replay.size()) {
+            std::uint8_t type = m_replay[m_ixReplay++];
+            std::uint64_t value0 = 0, value1 = 0;
+            std::int64_t key = 0, scancode = 0;
+            if (type == RECORD_FRAME) {
+                ReadVarint(value0);
+                m_frameTime += std::chrono::microseconds(value0);
+                break;
+            }
+            else if (type == RECORD_KEY) {
+                ReadSigned(key);
+                ReadSigned(scancode);
+                ReadVarint(value0);
+                ReadVarint(value1);
+                if (m_programKeyCallback != nullptr)
+                    m_programKeyCallback(window, static_cast<int>(key), static_cast<int>(scancode),
+                                         static_cast<int>(value0), static_cast<int>(value1));
+            }
+            else if (type == RECORD_FRAMEBUFFER_SIZE) {
+                ReadVarint(value0);
+                ReadVarint(value1);
+                if (m_programFramebufferSizeCallback != nullptr)
+                    m_programFramebufferSizeCallback(window, static_cast<int>(value0), static_cast<int>(value1));
+            }
+            else {
+                m_ixReplay = m_replay.size();
+            }
+        }
+    }
+}
+
+void InputLog::Finish() {
+    if (m_file == nullptr)
+        return;
+    std::fputc(RECORD_END, m_file);
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+std::chrono::steady_clock::time_point InputLog::Now() const {
+    if (m_mode == Mode::OFF)
+        return std::chrono::steady_clock::now();
+    return m_startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_frameTime);
+}
+
+void InputLog::WriteVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+        std::fputc(static_cast<int>((value & 0x7F) | 0x80), m_file);
+        value >>= 7;
+    }
+    std::fputc(static_cast<int>(value), m_file);
+}
+
+void InputLog::WriteSigned(std::int64_t value) {
+    WriteVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+bool InputLog::ReadVarint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_ixReplay >= m_replay.size())
+            return false;
+        std::uint8_t byte = m_replay[m_ixReplay++];
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool InputLog::ReadSigned(std::int64_t& value) {
+    std::uint64_t encoded;
+    if (!ReadVarint(encoded))
+        return false;
+    value = static_cast<std::int64_t>(encoded >> 1) ^ -static_cast<std::int64_t>(encoded & 1);
+    return true;
+}
@@ -0,0 +1,91 @@
+// --- Declares the input recorder and replayer --- \\
+
+#ifndef CLIONPROJECTS_INPUT_LOG_H
+#define CLIONPROJECTS_INPUT_LOG_H
+#include "libraries/glfw-master/include/GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Records a session's key and framebuffer size events, and the time every frame started, into a
+// compact binary log, and plays them back so the same session can be rerun exactly.
+//
+// The log is a header followed by a stream of records. Every rendered frame starts with a FRAME
+// record carrying its start time (in microseconds since the previous frame), and events are
+// written ahead of the FRAME record of the frame they were handled before, so frame indices are
+// implicit. All integers are LEB128 varints (zigzag for signed values), which keeps an idle frame
+// at 60 Hz to three bytes.
+//
+// Now() is the clock for anything that animates (the programs' Timer). While recording or
+// replaying it only advances once per frame, to the frame's recorded start time, so animation
+// sees exactly the same times on replay however fast the frames are drawn.
+class InputLog {
+public:
+    enum class Mode {
+        OFF,
+        RECORD,
+        REPLAY
+    };
+
+    InputLog();
+    ~InputLog();
+
+    InputLog(const InputLog&) = delete;
+    InputLog& operator=(const InputLog&) = delete;
+
+    bool StartRecording(const std::string& path);
+    // Reads the whole log up front.
+    bool StartReplay(const std::string& path);
+    [[nodiscard]] Mode GetMode() const {return m_mode;}
+    [[nodiscard]] int GetReplayFrameCount() const {return m_replayFrameCount;}
+
+    // Call once the program has set its own key and framebuffer size callbacks; they are chained
+    // behind the log's. While replaying, real input is dropped.
+    void Attach(GLFWwindow* window);
+
+    // Call at the start of every rendered frame. Replays the frame's events into the program's
+    // callbacks before advancing the clock.
+    void BeginFrame(GLFWwindow* window);
+
+    // Ends the recording; also done by the destructor.
+    void Finish();
+
+    [[nodiscard]] std::chrono::steady_clock::time_point Now() const;
+
+private:
+    enum RecordType : std::uint8_t {
+        RECORD_FRAME = 1,
+        RECORD_KEY = 2,
+        RECORD_FRAMEBUFFER_SIZE = 3,
+        RECORD_END = 4
+    };
+
+    static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+    void WriteVarint(std::uint64_t value);
+    void WriteSigned(std::int64_t value);
+    bool ReadVarint(std::uint64_t& value);
+    bool ReadSigned(std::int64_t& value);
+
+    Mode m_mode = Mode::OFF;
+    FILE* m_file = nullptr;
+    std::vector<std::uint8_t> m_replay;
+    size_t m_ixReplay = 0;
+    int m_replayFrameCount = 0;
+
+    GLFWkeyfun m_programKeyCallback = nullptr;
+    GLFWframebuffersizefun m_programFramebufferSizeCallback = nullptr;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    // Time since m_startTime of the current frame, and of the previous FRAME record.
+    std::chrono::microseconds m_frameTime{0};
+    std::chrono::microseconds m_lastRecordedFrameTime{0};
+};
+
+// Shared with the callbacks, and with Timer for its clock.
+extern InputLog g_inputLog;
+
+#endif // CLIONPROJECTS_INPUT_LOG_H
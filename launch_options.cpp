@@ -0,0 +1,174 @@
+// --- Command line options shared by the lesson programs --- \\
+
+#include "launch_options.h"
+#include "frame_histogram.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+LaunchOptions parseLaunchOptions(int argc, char* argv[]) {
+    LaunchOptions options;
+    bool bPacingGiven = false;
+    for (int ixArg = 1; ixArg < argc; ixArg++) {
+        const char* arg = argv[ixArg];
+        if (std::strcmp(arg, "--continuous") == 0) {
+            options.bContinuousRendering = true;
+        }
+        else if (std::strcmp(arg, "--vsync") == 0) {
+            options.framePacing = FramePacer::Mode::VSYNC;
+            bPacingGiven = true;
+        }
+        else if (std::strcmp(arg, "--uncapped") == 0) {
+            options.framePacing = FramePacer::Mode::UNCAPPED;
+            bPacingGiven = true;
+        }
+        else if (std::strcmp(arg, "--fps") == 0 && ixArg + 1 < argc) {
+            double fTargetFps = std::strtod(argv[++ixArg], nullptr);
+            if (fTargetFps > 0.0) {
+                options.framePacing = FramePacer::Mode::CAPPED;
+                options.fTargetFps = fTargetFps;
+                bPacingGiven = true;
+            }
+            else {
+                LOG_WARN("Ignoring invalid frame rate: {}", argv[ixArg]);
+            }
+        }
+        else if (std::strcmp(arg, "--headless") == 0) {
+            options.backend = RenderBackend::Type::HEADLESS_EGL;
+        }
+        else if (std::strcmp(arg, "--osmesa") == 0) {
+            options.backend = RenderBackend::Type::HEADLESS_OSMESA;
+        }
+        else if (std::strcmp(arg, "--size") == 0 && ixArg + 1 < argc) {
+            int iWidth = 0, iHeight = 0;
+            if (std::sscanf(argv[++ixArg], "%dx%d", &iWidth, &iHeight) == 2 && iWidth > 0 && iHeight > 0) {
+                options.iFramebufferWidth = iWidth;
+                options.iFramebufferHeight = iHeight;
+            }
+            else {
+                LOG_WARN("Ignoring invalid size: {}", argv[ixArg]);
+            }
+        }
+        else if (std::strcmp(arg, "--frames") == 0 && ixArg + 1 < argc) {
+            options.iFrameLimit = std::max(std::atoi(argv[++ixArg]), 0);
+        }
+        else if (std::strcmp(arg, "--screenshot") == 0 && ixArg + 1 < argc) {
+            options.screenshotPath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--trace") == 0 && ixArg + 1 < argc) {
+            options.tracePath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--gpu-timers") == 0) {
+            options.bGpuTimers = true;
+        }
+        else if (std::strcmp(arg, "--stats") == 0 && ixArg + 1 < argc) {
+            options.statsPath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--write-baseline") == 0 && ixArg + 1 < argc) {
+            options.writeBaselinePath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--baseline") == 0 && ixArg + 1 < argc) {
+            options.baselinePath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--gate-percentile") == 0 && ixArg + 1 < argc) {
+            double fUnused = 0.0;
+            if (FrameTimeHistogram::GetSummaryValue(FrameTimeHistogram::Summary(), argv[++ixArg], fUnused))
+                options.gateMetric = argv[ixArg];
+            else
+                LOG_WARN("Ignoring invalid gate percentile: {}", argv[ixArg]);
+        }
+        else if (std::strcmp(arg, "--gate-threshold") == 0 && ixArg + 1 < argc) {
+            double fThreshold = std::strtod(argv[++ixArg], nullptr);
+            if (fThreshold >= 0.0)
+                options.fGateThresholdPercent = fThreshold;
+            else
+                LOG_WARN("Ignoring invalid gate threshold: {}", argv[ixArg]);
+        }
+        else if (std::strcmp(arg, "--camera-path") == 0 && ixArg + 1 < argc) {
+            options.cameraPathFile = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--timestep") == 0 && ixArg + 1 < argc) {
+            double fTimestep = std::strtod(argv[++ixArg], nullptr);
+            if (fTimestep > 0.0)
+                options.fTimestep = fTimestep;
+            else
+                LOG_WARN("Ignoring invalid timestep: {}", argv[ixArg]);
+        }
+        else if (std::strcmp(arg, "--fixed-step") == 0) {
+            options.bFixedTimestep = true;
+        }
+        else if (std::strcmp(arg, "--time-scale") == 0 && ixArg + 1 < argc) {
+            double fTimeScale = std::strtod(argv[++ixArg], nullptr);
+            if (fTimeScale >= 0.0)
+                options.fTimeScale = fTimeScale;
+            else
+                LOG_WARN("Ignoring invalid time scale: {}", argv[ixArg]);
+        }
+        else if (std::strcmp(arg, "--record-input") == 0 && ixArg + 1 < argc) {
+            options.recordInputPath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--replay-input") == 0 && ixArg + 1 < argc) {
+            options.replayInputPath = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--trees") == 0 && ixArg + 1 < argc) {
+            options.iSceneTreeCount = std::max(std::atoi(argv[++ixArg]), 0);
+        }
+        else if (std::strcmp(arg, "--buildings") == 0 && ixArg + 1 < argc) {
+            options.iSceneBuildingCount = std::max(std::atoi(argv[++ixArg]), 0);
+        }
+        else if (std::strcmp(arg, "--seed") == 0 && ixArg + 1 < argc) {
+            options.sceneSeed = static_cast<std::uint32_t>(std::strtoul(argv[++ixArg], nullptr, 10));
+        }
+        else if (std::strcmp(arg, "--tree-density") == 0 && ixArg + 1 < argc) {
+            float fDensity = std::strtof(argv[++ixArg], nullptr);
+            if (fDensity > 0.0f)
+                options.fTreeDensity = fDensity;
+            else
+                LOG_WARN("Ignoring invalid tree density: {}", argv[ixArg]);
+        }
+        else if (std::strcmp(arg, "--ships") == 0 && ixArg + 1 < argc) {
+            options.iShipCount = std::max(std::atoi(argv[++ixArg]), 1);
+        }
+        else if (std::strcmp(arg, "--animation-threads") == 0 && ixArg + 1 < argc) {
+            options.iAnimationThreads = std::max(std::atoi(argv[++ixArg]), 0);
+        }
+        else if (std::strcmp(arg, "--animation") == 0 && ixArg + 1 < argc) {
+            options.animationClipFile = argv[++ixArg];
+        }
+        else if (std::strcmp(arg, "--gpu-orientations") == 0) {
+            options.bGpuOrientations = true;
+        }
+        else if (std::strcmp(arg, "--gl-count-only") == 0) {
+            options.bRecordGLCommands = false;
+        }
+        else {
+            LOG_WARN("Ignoring unknown option: {}", arg);
+        }
+    }
+
+#ifdef GL_NULL_DISPATCH
+    // Nothing reaches a driver, so there is no context to create, nothing to show and nothing to pace.
+    options.backend = RenderBackend::Type::HEADLESS_NULL;
+    options.framePacing = FramePacer::Mode::UNCAPPED;
+    if (options.iFrameLimit == 0 && options.cameraPathFile.empty() && options.replayInputPath.empty())
+        options.iFrameLimit = 1000;
+#endif
+
+    if (!options.recordInputPath.empty() && !options.replayInputPath.empty()) {
+        LOG_WARN("Ignoring --record-input while replaying input");
+        options.recordInputPath.clear();
+    }
+
+    // A camera path run is a benchmark; the program sets its frame limit from the path.
+    if (!options.cameraPathFile.empty() && !bPacingGiven)
+        options.framePacing = FramePacer::Mode::UNCAPPED;
+    if (!options.cameraPathFile.empty())
+        options.bFixedTimestep = true;
+
+    if (options.backend != RenderBackend::Type::WINDOW || options.iFrameLimit > 0 ||
+        !options.cameraPathFile.empty() || !options.replayInputPath.empty())
+        options.bContinuousRendering = true;
+    return options;
+}
@@ -0,0 +1,79 @@
+// --- Declares the command line options shared by the lesson programs --- \\
+
+#ifndef CLIONPROJECTS_LAUNCH_OPTIONS_H
+#define CLIONPROJECTS_LAUNCH_OPTIONS_H
+#include "frame_pacer.h"
+#include "render_backend.h"
+#include <cstdint>
+#include <string>
+
+struct LaunchOptions {
+    // Redraw every loop iteration instead of only when something changed (for benchmarking).
+    bool bContinuousRendering = false;
+    // --vsync (default), --uncapped, or --fps N to cap the frame rate at N.
+    FramePacer::Mode framePacing = FramePacer::Mode::VSYNC;
+    double fTargetFps = 60.0;
+    // --headless (EGL) or --osmesa to run without a display.
+    RenderBackend::Type backend = RenderBackend::Type::WINDOW;
+    // --size WxH; 0 keeps the program's default window size.
+    int iFramebufferWidth = 0;
+    int iFramebufferHeight = 0;
+    // --frames N closes the program after N frames; 0 runs until the window is closed.
+    int iFrameLimit = 0;
+    // --screenshot PATH writes the last frame of a --frames run to a PPM file.
+    std::string screenshotPath;
+    // --trace PATH writes the profiler trace there at exit (and on F12, which otherwise uses trace.json).
+    std::string tracePath;
+    // --gpu-timers times the render passes on the GPU and reports them at exit.
+    bool bGpuTimers = false;
+    // --stats PATH writes the per-frame render statistics there at exit, as JSON if PATH ends in
+    // .json and as CSV otherwise. F11 prints a snapshot either way.
+    std::string statsPath;
+    // --write-baseline PATH stores this run's frame time percentiles; --baseline PATH compares the
+    // run against stored ones and fails (non-zero exit) when --gate-percentile (p50, p90, p99, max
+    // or mean; p99 by default) is more than --gate-threshold percent (10 by default) slower.
+    std::string writeBaselinePath;
+    std::string baselinePath;
+    std::string gateMetric = "p99";
+    double fGateThresholdPercent = 10.0;
+    // --camera-path FILE replays a keyframed camera fly-through, advancing it by --timestep
+    // seconds (1/60 by default) every frame, so a run renders the same frames on any machine.
+    // Unless --frames is given it runs for exactly the length of the path, and unless a pacing
+    // option is given it runs uncapped.
+    std::string cameraPathFile;
+    double fTimestep = 1.0 / 60.0;
+    // --fixed-step advances the animation clock by --timestep every frame instead of by real time,
+    // as camera path runs always do; --time-scale X runs animation X times as fast.
+    bool bFixedTimestep = false;
+    double fTimeScale = 1.0;
+    // --record-input PATH logs the session's key and resize events and frame times; --replay-input
+    // PATH plays such a log back with the same frame timing, then closes (unless --frames says otherwise).
+    std::string recordInputPath;
+    std::string replayInputPath;
+    // --trees N and --buildings M replace the forest scene's hand-placed trees and Parthenon with
+    // a generated scene (100 trees and 1 Parthenon for whichever is not given), scattered with
+    // --seed S (1 by default) at --tree-density trees per square unit (0.02 by default).
+    int iSceneTreeCount = -1;
+    int iSceneBuildingCount = -1;
+    std::uint32_t sceneSeed = 1;
+    float fTreeDensity = 0.02f;
+    // --ships N draws N ships in a grid instead of one, each turning independently to random
+    // orientations (drawn from --seed); --animation-threads N splits their animation update across
+    // N threads (1 by default; 0 for one per core, up to 4).
+    int iShipCount = 1;
+    int iAnimationThreads = 1;
+    // --animation FILE has the ships play a keyframed clip (see animation_clip.h) instead.
+    std::string animationClipFile;
+    // --gpu-orientations starts with the ships' orientations interpolated in the vertex shader
+    // (see gpu_orientations.h), as G toggles.
+    bool bGpuOrientations = false;
+    // --gl-count-only: GL_NULL_DISPATCH builds count GL calls without logging them.
+    bool bRecordGLCommands = true;
+};
+
+// Unknown options are reported on stderr and otherwise ignored. Headless, frame-limited, camera
+// path and input replay runs always render continuously, since they are unattended and nothing
+// else would request a frame.
+LaunchOptions parseLaunchOptions(int argc, char* argv[]);
+
+#endif // CLIONPROJECTS_LAUNCH_OPTIONS_H
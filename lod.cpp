@@ -0,0 +1,33 @@
+// --- Screen-size driven level of detail selector --- \\
+
+#include "lod.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+LodSelector::LodSelector(std::vector<float> switchSizes, float hysteresis)
+        : m_switchSizes(std::move(switchSizes)), m_hysteresis(hysteresis) {}
+
+float LodSelector::ProjectedSize(const glm::vec3& centre, float radius, const glm::vec3& cameraPosition,
+                                 float fFovYRadians, int iViewportHeight) {
+    float distance = glm::length(centre - cameraPosition);
+    if (distance <= radius)
+        return static_cast<float>(iViewportHeight);
+
+    return (radius * static_cast<float>(iViewportHeight)) / (distance * std::tan(fFovYRadians * 0.5f));
+}
+
+int LodSelector::Select(int currentLevel, float projectedSize) const {
+    const int maxLevel = static_cast<int>(m_switchSizes.size());
+    int level = std::clamp(currentLevel, 0, maxLevel);
+
+    // Only step to a finer level once the object is clearly above the switch size, and only
+    // step to a coarser level once it is clearly below it.
+    while (level > 0 && projectedSize > m_switchSizes[level - 1] * (1.0f + m_hysteresis)) {
+        level--;
+    }
+    while (level < maxLevel && projectedSize < m_switchSizes[level] * (1.0f - m_hysteresis)) {
+        level++;
+    }
+    return level;
+}
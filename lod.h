@@ -0,0 +1,29 @@
+// --- Declares the screen-size driven level of detail selector --- \\
+
+#ifndef CLIONPROJECTS_LOD_H
+#define CLIONPROJECTS_LOD_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include <vector>
+
+// Picks a tessellation level from the projected size of an object's bounding sphere.
+// Level 0 is the finest. switchSizes[i] is the projected diameter (in pixels) below which
+// an object drops from level i to level i + 1, so the list must be in descending order.
+// A band of +/- hysteresis around every switch size keeps objects from popping back and forth
+// while the camera hovers around a threshold.
+class LodSelector {
+public:
+    explicit LodSelector(std::vector<float> switchSizes, float hysteresis = 0.15f);
+
+    // Projected diameter in pixels of a sphere seen through a perspective camera.
+    static float ProjectedSize(const glm::vec3& centre, float radius, const glm::vec3& cameraPosition,
+                               float fFovYRadians, int iViewportHeight);
+
+    [[nodiscard]] int Select(int currentLevel, float projectedSize) const;
+    [[nodiscard]] int GetLevelCount() const {return static_cast<int>(m_switchSizes.size()) + 1;}
+
+private:
+    std::vector<float> m_switchSizes;
+    float m_hysteresis;
+};
+
+#endif // CLIONPROJECTS_LOD_H
@@ -0,0 +1,106 @@
+// --- Asynchronous logger --- \\
+
+#include "logger.h"
+#include <cstdio>
+
+namespace {
+    const char* GetLevelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::TRACE: return "TRACE";
+            case LogLevel::DEBUG: return "DEBUG";
+            case LogLevel::INFO: return "INFO";
+            case LogLevel::WARN: return "WARN";
+            case LogLevel::ERROR: return "ERROR";
+        }
+        return "?";
+    }
+
+    void WriteBuffer(fmt::memory_buffer& out, FILE* file) {
+        if (out.size() == 0)
+            return;
+        std::fwrite(out.data(), 1, out.size(), file);
+        out.clear();
+    }
+}
+
+Logger& Logger::Get() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : m_records(new Record[g_iQueueCapacity]), m_startTime(std::chrono::steady_clock::now()) {
+    for (std::uint64_t ix = 0; ix < g_iQueueCapacity; ix++)
+        m_records[ix].sequence.store(ix, std::memory_order_relaxed);
+    m_writer = std::thread(&Logger::Run, this);
+}
+
+Logger::~Logger() {
+    m_bStopping.store(true, std::memory_order_release);
+    m_writer.join();
+    delete[] m_records;
+}
+
+void Logger::Flush() {
+    const std::uint64_t target = m_enqueuePos.load(std::memory_order_acquire);
+    while (m_writtenPos.load(std::memory_order_acquire) < target)
+        std::this_thread::yield();
+}
+
+void Logger::Run() {
+    fmt::memory_buffer out;
+    for (;;) {
+        // Read before draining, so that everything logged before the destructor ran gets written.
+        const bool bStopping = m_bStopping.load(std::memory_order_acquire);
+        if (Drain(out) == 0) {
+            if (bStopping)
+                break;
+            // Polling keeps producers free of any wake-up call; a millisecond of latency is
+            // invisible on a terminal.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+size_t Logger::Drain(fmt::memory_buffer& out) {
+    std::uint64_t pos = m_writtenPos.load(std::memory_order_relaxed);
+    FILE* file = stdout;
+    size_t count = 0;
+    for (;; pos++, count++) {
+        Record& record = m_records[pos & (g_iQueueCapacity - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != pos + 1)
+            break;
+
+        // Keep the two streams in order with each other.
+        FILE* recordFile = record.level >= LogLevel::WARN ? stderr : stdout;
+        if (recordFile != file) {
+            WriteBuffer(out, file);
+            std::fflush(file);
+            file = recordFile;
+        }
+
+        fmt::format_to(fmt::appender(out), "[{:10.4f}] {:<5} ", static_cast<double>(record.timeNs) * 1e-9,
+                       GetLevelName(record.level));
+        record.pFormat(record, out);
+        out.push_back('\n');
+
+        // Hand the slot back to the producers a lap later.
+        record.sequence.store(pos + g_iQueueCapacity, std::memory_order_release);
+    }
+
+    const std::uint64_t droppedCount = m_droppedCount.load(std::memory_order_relaxed);
+    if (droppedCount != m_reportedDroppedCount) {
+        WriteBuffer(out, file);
+        std::fflush(file);
+        file = stderr;
+        fmt::format_to(fmt::appender(out), "Log queue full, dropped {} messages\n",
+                       droppedCount - m_reportedDroppedCount);
+        m_reportedDroppedCount = droppedCount;
+    }
+
+    WriteBuffer(out, file);
+    if (count > 0 || file == stderr)
+        std::fflush(file);
+    // Only now has Flush() got nothing left to wait for.
+    m_writtenPos.store(pos, std::memory_order_release);
+    return count;
+}
@@ -0,0 +1,244 @@
+// --- Declares the asynchronous logger --- \\
+
+#ifndef CLIONPROJECTS_LOGGER_H
+#define CLIONPROJECTS_LOGGER_H
+#include "libraries/fmt/include/fmt/format.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+
+// Levels below this are compiled out, arguments and all.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+enum class LogLevel {
+    TRACE = LOG_LEVEL_TRACE,
+    DEBUG = LOG_LEVEL_DEBUG,
+    INFO = LOG_LEVEL_INFO,
+    WARN = LOG_LEVEL_WARN,
+    ERROR = LOG_LEVEL_ERROR
+};
+
+// Levelled logging that stays off the calling thread's critical path. A message is not formatted
+// where it is logged: its arguments are copied into a slot of a fixed ring, and a background
+// thread formats the message with fmt and writes it out, WARN and ERROR to stderr and the rest
+// to stdout. Logging costs a clock read, a compare-and-swap and a copy of the arguments, and
+// never blocks; if the writer falls behind by a whole ring, messages are dropped and counted.
+//
+// The ring is the bounded multi-producer queue from Dmitry Vyukov: every slot carries a sequence
+// number saying whose turn it is, so producers only contend on the enqueue position.
+//
+// Log with LOG_TRACE/DEBUG/INFO/WARN/ERROR("format {}", args...); the format is checked at compile
+// time. Arguments are read later on another thread, so they are copied when logged. Strings (char
+// pointers, std::string and std::string_view) are copied into the record's own text, or onto the
+// heap for whatever does not fit in g_iTextBytes, so a c_str() or an exception's what() can be
+// logged and then freed. Anything else must be trivially copyable: numbers, enums and the like,
+// but no other pointer into memory the caller might free.
+class Logger {
+public:
+    static constexpr std::uint64_t g_iQueueCapacity = 1 << 12;
+    static constexpr size_t g_iArgBytes = 64;
+    static constexpr size_t g_iTextBytes = 192;
+
+    static Logger& Get();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    template <typename... Args>
+    void Write(LogLevel level, fmt::format_string<Args...> format, Args&&... args);
+
+    // Waits until everything logged so far has been written.
+    void Flush();
+
+    [[nodiscard]] std::uint64_t GetDroppedCount() const {return m_droppedCount.load(std::memory_order_relaxed);}
+
+private:
+    struct Record;
+    using FormatFunction = void (*)(Record& record, fmt::memory_buffer& out);
+
+    struct Record {
+        std::atomic<std::uint64_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        std::int64_t timeNs = 0;
+        fmt::string_view format;
+        FormatFunction pFormat = nullptr;
+        alignas(std::max_align_t) unsigned char args[g_iArgBytes];
+        char text[g_iTextBytes];
+    };
+
+    // A string argument's copy: at offset in its record's text, or on the heap if it did not fit
+    struct StoredString {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+        std::unique_ptr<char[]> heap;
+    };
+
+    template <typename T>
+    static constexpr bool g_bIsString = std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                                        std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+    // What a record holds for an argument of type T
+    template <typename T>
+    using Stored = std::conditional_t<g_bIsString<std::decay_t<T>>, StoredString, std::decay_t<T>>;
+
+    // Copies an argument into the record, strings into its text after textUsed bytes
+    template <typename T>
+    static Stored<T> Store(Record& record, size_t& textUsed, T&& value);
+    // What a stored argument is formatted as
+    template <typename T>
+    static const T& View(const Record&, const T& value) {return value;}
+    static std::string_view View(const Record& record, const StoredString& value) {
+        return {value.heap ? value.heap.get() : record.text + value.offset, value.size};
+    }
+
+    Logger();
+    ~Logger();
+
+    // Formats the record's stored arguments, then destroys them.
+    template <typename Tuple>
+    static void FormatRecord(Record& record, fmt::memory_buffer& out);
+
+    // Writer thread
+    void Run();
+    // Writes every record that is ready; returns how many there were.
+    size_t Drain(fmt::memory_buffer& out);
+
+    Record* m_records;
+    alignas(64) std::atomic<std::uint64_t> m_enqueuePos{0};
+    alignas(64) std::atomic<std::uint64_t> m_writtenPos{0};
+    std::atomic<std::uint64_t> m_droppedCount{0};
+    std::uint64_t m_reportedDroppedCount = 0;
+    std::atomic<bool> m_bStopping{false};
+    std::chrono::steady_clock::time_point m_startTime;
+    std::thread m_writer;
+};
+
+template <typename T>
+Logger::Stored<T> Logger::Store(Record& record, size_t& textUsed, T&& value) {
+    if constexpr (g_bIsString<std::decay_t<T>>) {
+        std::string_view text;
+        if constexpr (std::is_pointer_v<std::decay_t<T>>)
+            text = value != nullptr ? std::string_view(value) : std::string_view("(null)");
+        else
+            text = value;
+
+        StoredString stored;
+        stored.size = static_cast<std::uint32_t>(text.size());
+        if (text.size() <= g_iTextBytes - textUsed) {
+            stored.offset = static_cast<std::uint32_t>(textUsed);
+            std::memcpy(record.text + textUsed, text.data(), text.size());
+            textUsed += text.size();
+        }
+        else {
+            stored.heap = std::make_unique<char[]>(text.size());
+            std::memcpy(stored.heap.get(), text.data(), text.size());
+        }
+        return stored;
+    }
+    else {
+        return std::forward<T>(value);
+    }
+}
+
+template <typename... Args>
+void Logger::Write(LogLevel level, fmt::format_string<Args...> format, Args&&... args) {
+    using Tuple = std::tuple<Stored<Args>...>;
+    static_assert(((g_bIsString<std::decay_t<Args>> || std::is_trivially_copyable_v<std::decay_t<Args>>) && ...),
+                  "log arguments are formatted on another thread; pass values or strings");
+    static_assert(sizeof(Tuple) <= g_iArgBytes && alignof(Tuple) <= alignof(std::max_align_t),
+                  "too many log arguments for one record");
+
+    const std::int64_t timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_startTime).count();
+
+    std::uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Record* pRecord;
+    for (;;) {
+        pRecord = &m_records[pos & (g_iQueueCapacity - 1)];
+        const std::uint64_t sequence = pRecord->sequence.load(std::memory_order_acquire);
+        const std::int64_t difference = static_cast<std::int64_t>(sequence - pos);
+        if (difference == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0) {
+            // The writer has not freed this slot yet: the ring is full
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    pRecord->level = level;
+    pRecord->timeNs = timeNs;
+    pRecord->format = static_cast<fmt::string_view>(format);
+    pRecord->pFormat = &FormatRecord<Tuple>;
+    // Braces copy the arguments in order, each string after the one before.
+    [[maybe_unused]] size_t textUsed = 0;
+    ::new (static_cast<void*>(pRecord->args)) Tuple{Store(*pRecord, textUsed, std::forward<Args>(args))...};
+    pRecord->sequence.store(pos + 1, std::memory_order_release);
+}
+
+template <typename Tuple>
+void Logger::FormatRecord(Record& record, fmt::memory_buffer& out) {
+    Tuple& args = *std::launder(reinterpret_cast<Tuple*>(record.args));
+    // fmt wants the arguments as lvalues, so the views get a tuple of their own.
+    auto views = std::apply([&](const auto&... values) {return std::make_tuple(View(record, values)...);}, args);
+    std::apply([&](auto&... values) {
+        fmt::vformat_to(fmt::appender(out), record.format, fmt::make_format_args(values...));
+    }, views);
+    args.~Tuple();
+}
+
+#define LOG_AT(level, ...) Logger::Get().Write(level, __VA_ARGS__)
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) LOG_AT(LogLevel::TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#endif // CLIONPROJECTS_LOGGER_H
@@ -1,10 +1,29 @@
 // --- Quaternions: Orientation --- \\
 
 #include "libraries/glew-2.1.0/include/GL/glew.h"
+#include "gl_dispatch.cpp"
+#include "profiler.cpp"
+#include "logger.cpp"
+#include "gpu_timer.cpp"
+#include "render_stats.cpp"
 #include "libraries/glfw-master/include/GLFW/glfw3.h"
 #include "libraries/glm-master/glm/glm.hpp"
 #include "libraries/glm-master/glm/ext.hpp"
 #include "xmlparser.cpp"
+#include "frame_scheduler.cpp"
+#include "frame_pacer.cpp"
+#include "render_backend.cpp"
+#include "frame_histogram.cpp"
+#include "input_log.cpp"
+#include "frame_clock.cpp"
+#include "quat_batch.cpp"
+#include "quat_codec.cpp"
+#include "animation_system.cpp"
+#include "animation_clip.cpp"
+#include "orientation_path.cpp"
+#include "gpu_orientations.cpp"
+#include "camera_path.cpp"
+#include "launch_options.cpp"
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -33,83 +52,16 @@ bool kKeyPressed = false;
 bool lKeyPressed = false;
 bool jKeyPressed = false;
 
-class Timer {
-public:
-    enum TimerType {
-        SINGLE, // Timer runs once
-        REPEATING // Timer repeats
-    };
-
-    Timer(TimerType type, std::chrono::seconds duration) : m_type(type), m_duration(duration) {}
-
-    // Start the timer
-    void Start() {
-        m_running = true;
-        m_startTime = std::chrono::steady_clock::now();
-    }
-
-    // Check if the timer has elapsed
-    bool isElapsed() {
-        auto currentTime = std::chrono::steady_clock::now();
-        if (currentTime < m_endTime) {
-            m_running = true;
-            return false;
-        }
-        else {
-            m_running = false;
-            TimerUpdateTime();
-            return true;
-        }
-    }
-
-    void TimerUpdateTime() {
-        if (m_type == REPEATING) {
-            m_running = true; // Stop if single timer
-            m_startTime = std::chrono::steady_clock::now(); // Restart if repeating timer
-        }
-    }
-
-    // Interpolation function to calculate alpha value
-    float getAlpha() {
-        // Ensure startTime < endTime to avoid division by zero or negative results
-        if (isElapsed()) {
-            return 1.0f; // Return full alpha if startTime equals or exceeds endTime
-        }
+// The orientations for the OrientKeys, packed smallest-three (see quat_codec.h)
+static const PackedQuat48 Orients[] = {
+                encodeQuat48(glm::fquat(0.7071f, 0.7071f, 0.0f, 0.0f)),
+                encodeQuat48(glm::fquat(0.5f, 0.5f, -0.5f, 0.5f)),
+                encodeQuat48(glm::fquat(-0.4895f, -0.7892f, -0.3700f, -0.02514f)),
+                encodeQuat48(glm::fquat(0.4895f, 0.7892f, 0.3700f, 0.02514f)),
 
-        std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
-        std::chrono::steady_clock::time_point endTime = m_startTime + m_duration;
-        // Calculate the normalized time position between startTime and endTime
-        float normalisedTime = static_cast<float>((currentTime - m_startTime) / (endTime - m_startTime));
-        std::cout << "normalisedTime: " << normalisedTime << "\n";
-        // Clamp normalizedTime to the range [0, 1]
-        normalisedTime = std::fminf(std::fmaxf(normalisedTime, 0.0f), 1.0f);
-
-        // Return the alpha value based on the interpolation function
-        return normalisedTime;
-    }
-
-    // Stop the timer
-    void Stop() {
-        m_running = false;
-    }
-
-private:
-    TimerType m_type;
-    std::chrono::seconds m_duration; // Duration of the timer in seconds
-    std::chrono::steady_clock::time_point m_startTime;
-    std::chrono::steady_clock::time_point m_endTime;
-    bool m_running = false;
-};
-
-static glm::fquat Orients[] = {
-                glm::fquat(0.7071f, 0.7071f, 0.0f, 0.0f),
-                glm::fquat(0.5f, 0.5f, -0.5f, 0.5f),
-                glm::fquat(-0.4895f, -0.7892f, -0.3700f, -0.02514f),
-                glm::fquat(0.4895f, 0.7892f, 0.3700f, 0.02514f),
-
-                glm::fquat(0.3840f, -0.1591f, -0.7991f, -0.4344f),
-                glm::fquat(0.5537f, 0.5208f, 0.6483f, 0.0410f),
-                glm::fquat(0.0f, 0.0f, 1.0f, 0.0f)
+                encodeQuat48(glm::fquat(0.3840f, -0.1591f, -0.7991f, -0.4344f)),
+                encodeQuat48(glm::fquat(0.5537f, 0.5208f, 0.6483f, 0.0410f)),
+                encodeQuat48(glm::fquat(0.0f, 0.0f, 1.0f, 0.0f))
 };
 
 static std::vector<int> OrientKeys = {
@@ -122,131 +74,100 @@ static std::vector<int> OrientKeys = {
                 GLFW_KEY_U
 };
 
-static glm::vec4 Vectorize(const glm::fquat theQuat) {
-    glm::vec4 ret;
-
-    ret.x = theQuat.x;
-    ret.y = theQuat.y;
-    ret.z = theQuat.z;
-    ret.w = theQuat.w;
-
-    return ret;
-}
-
-static glm::fquat Lerp(const glm::fquat &v0, const glm::fquat &v1, float alpha) {
-    glm::vec4 start = Vectorize(v0);
-    glm::vec4 end = Vectorize(v1);
-    glm::vec4 interp = glm::mix(start, end, alpha);
-
-    printf("alpha: %f, (%f, %f, %f, %f)\n", alpha, interp.w, interp.x, interp.y, interp.z);
-
-    interp = glm::normalize(interp);
-    return {interp.w, interp.x, interp.y, interp.z};
-}
-
-static glm::fquat Slerp(const glm::fquat &v0, const glm::fquat &v1, float alpha) {
-    std::cout << "Slerp alpha: " << alpha << "\n";
-    float dot = glm::dot(v0, v1);
-
-    const float DOT_THRESHOLD = 0.9995f;
-    if (dot > DOT_THRESHOLD)
-        return Lerp(v0, v1, alpha);
-
-    glm::clamp(dot, -1.0f, 1.0f);
-    float theta_0 = acosf(dot);
-    float theta = theta_0 * alpha;
-
-    glm::fquat v2 = v1 + -(v0 * dot);
-    v2 = glm::normalize(v2);
-
-    return (v0 * glm::cos(theta)) + (v2 * glm::sin(theta));
-}
+// How long a ship takes to turn to the orientation for a key
+static const FrameClock::Duration g_orientDuration = std::chrono::seconds(5);
 
+// A ship's orientation: a handle to its animation in g_animationSystem, which turns every ship at
+// once, and which of the Orients it rests at or is turning to.
 class Orientation {
 public:
-    static bool m_bSlerp;
+    Orientation() : m_handle(g_animationSystem.Add(decodeQuat48(Orients[0]))) {}
 
-    void ToggleSlerp() {
-        m_bSlerp = !m_bSlerp;
-    }
+    [[nodiscard]] glm::fquat OrientationGetOrient() const {return g_animationSystem.GetOrientation(m_handle);}
 
-    [[nodiscard]] glm::fquat OrientationGetOrient() {
-        if(m_bIsAnimating) {
-            std::cout << "Am I ever animating?" << "\n";
-            return m_anim.AnimationGetOrient(Orients[m_ixCurrOrient], m_bSlerp);
-        }
-        else
-            return Orients[m_ixCurrOrient];
-    }
+    [[nodiscard]] bool IsAnimating() const {return g_animationSystem.IsAnimating(m_handle);}
 
-    [[nodiscard]] static bool IsAnimating() {return m_bIsAnimating;}
-
-    void OrientationUpdateTime() {
-        if (m_bIsAnimating) {
-            bool bIsFinished = m_anim.AnimationUpdateTime();
-            if (bIsFinished) {
-                std::cout << "Orientation finished." << "\n";
-                m_bIsAnimating = false;
-                m_ixCurrOrient = m_anim.GetFinalIx();
-            }
-        }
-    }
-
-    void AnimateToOrient(int ixDestination) {
-        std::cout << "Current orient index = " << m_ixCurrOrient << "\n";
-        std::cout << "Destination orient index = " << ixDestination << "\n";
+    void AnimateToOrient(int ixDestination, FrameClock::Duration duration = g_orientDuration) {
+        LOG_DEBUG("Current orient index = {}", m_ixCurrOrient);
+        LOG_DEBUG("Destination orient index = {}", ixDestination);
         if(m_ixCurrOrient == ixDestination)
             return;
-        m_anim.StartAnimation(ixDestination);
-        m_bIsAnimating = true;
+        g_animationSystem.AnimateTo(m_handle, decodeQuat48(Orients[ixDestination]), duration, g_frameClock.Now());
+        m_ixCurrOrient = ixDestination;
     }
 
-private:
-    class Animation {
-    public:
-        //Returns true if the animation is over.
-        bool AnimationUpdateTime() {
-            return m_currTimer.isElapsed();
-        }
-
-        [[nodiscard]] glm::fquat AnimationGetOrient(const glm::fquat &initial, bool bSlerp) {
-            if (bSlerp) {
-                return Slerp(initial, Orients[m_ixFinalOrient], m_currTimer.getAlpha());
-            }
-            else {
-                return Lerp(initial, Orients[m_ixFinalOrient], m_currTimer.getAlpha());
-            }
-        }
+    // Jumps straight to orient, ending any animation
+    void SetOrient(const glm::fquat& orient) {
+        g_animationSystem.AnimateTo(m_handle, orient, FrameClock::Duration::zero(), g_frameClock.Now());
+        m_ixCurrOrient = -1;
+    }
 
-        void StartAnimation(int ixDestination) {
-            m_ixFinalOrient = ixDestination;
-            m_currTimer.Start();
-            std::cout << "Timer started." << "\n";
-        }
+private:
+    AnimationSystem::Handle m_handle;
+    int m_ixCurrOrient{};
+};
 
-        [[nodiscard]] int GetFinalIx() const {return m_ixFinalOrient;}
+// SPACE switches every ship between lerp and slerp, F between exact and fast slerp
+static bool g_bSlerp = false;
+static bool g_bFastSlerp = false;
 
-    private:
-        int m_ixFinalOrient{};
-        Timer m_currTimer{Timer::TimerType::SINGLE, std::chrono::seconds (5)};
-    };
-
-    static bool m_bIsAnimating;
-    static int m_ixCurrOrient;
-    static Animation m_anim;
-};
+static void applyInterpolation() {
+    if (!g_bSlerp)
+        g_animationSystem.SetInterpolation(AnimationSystem::Interpolation::NLERP);
+    else if (g_bFastSlerp)
+        g_animationSystem.SetInterpolation(AnimationSystem::Interpolation::FAST_SLERP);
+    else
+        g_animationSystem.SetInterpolation(AnimationSystem::Interpolation::SLERP);
+}
 
-bool Orientation::m_bSlerp = false;
-bool Orientation::m_bIsAnimating = false;
-int Orientation::m_ixCurrOrient{};
-Orientation::Animation Orientation::m_anim;
+// The ships and where they sit: one at the origin, or a grid of them with --ships N
+static std::vector<Orientation> g_ships;
+static std::vector<glm::vec3> g_shipPositions;
+
+// With --animation FILE every ship plays the clip's first orientation and translation tracks on a
+// loop, each from its own point in the loop and with its own cursors; the translation is added to
+// the ship's position.
+static AnimationClip g_shipClip;
+static int g_ixShipOrientTrack = -1;
+static int g_ixShipTranslationTrack = -1;
+static std::vector<AnimationClip::Cursor> g_shipOrientCursors;
+static std::vector<AnimationClip::Cursor> g_shipTranslationCursors;
+static std::vector<glm::vec3> g_shipTranslations;
+
+// P sets every ship following a looping squad path of its own instead of turning from one orient to
+// the next: from where it is through a tour of the Orients and back, without stopping at any.
+// Ship i's path is path i, and its handle in g_animationSystem is i too.
+static bool g_bShipPaths = false;
+static OrientationPaths g_shipPaths;
+static FrameClock::TimePoint g_shipPathStartTime;
+// Per ship: path parameter per second, and this frame's parameter and orientation
+static std::vector<double> g_shipPathRates;
+static std::vector<float> g_shipPathParameters;
+static QuatArray g_shipPathOrients;
+
+// G (or --gpu-orientations) hands the ships' interpolation to the vertex shader, which turns every
+// ship in one instanced draw from animations uploaded only when they are set (see gpu_orientations.h).
+static bool g_bGpuOrientations = false;
+// The instances' positions need uploading again
+static bool g_bShipPositionsChanged = true;
+
+static void setGpuOrientations(bool bGpuOrientations) {
+    g_bGpuOrientations = bGpuOrientations;
+    g_bShipPositionsChanged = true;
+    g_animationSystem.SetDeferInterpolation(bGpuOrientations);
+}
 
 GLuint g_GlobalMatricesUBO;
 static const int g_iGlobalMatricesBindingIndex = 0;
 
-GLFWwindow* initializeGLFW() {
+// Decides when the render loop redraws
+FrameScheduler g_frameScheduler;
+
+GLFWwindow* initializeGLFW(const RenderBackend& backend) {
+    backend.SetInitHints();
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        LOG_ERROR("Failed to initialize GLFW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 
@@ -256,12 +177,16 @@ GLFWwindow* initializeGLFW() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
+    // Headless backends create an invisible window on GLFW's null platform
+    backend.SetWindowHints();
+
     // Create a windowed mode window and its OpenGL context
-    GLFWwindow* window = glfwCreateWindow(static_cast<int>(WINDOW_WIDTH), static_cast<int>(WINDOW_HEIGHT),
+    GLFWwindow* window = glfwCreateWindow(backend.GetWidth(WINDOW_WIDTH), backend.GetHeight(WINDOW_HEIGHT),
                                           "Getting the hang...", nullptr, nullptr);
 
     if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
+        Logger::Get().Flush();
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
@@ -280,8 +205,11 @@ GLFWwindow* initializeGLFW() {
 void initializeGLEW() {
     glewExperimental = GL_TRUE;
 
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW" << std::endl;
+    // A headless EGL context has no GLX display, but the GL functions are loaded regardless
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY) {
+        LOG_ERROR("Failed to initialize GLEW");
+        Logger::Get().Flush();
         exit(EXIT_FAILURE);
     }
 }
@@ -356,6 +284,11 @@ public:
     std::vector<GLuint> unitPlaneVertexIndicesTri;
     std::vector<std::vector<GLuint>> shipVertexIndicesTri;
     glm::mat4 modelMatrix{};
+    // Per pass GPU timings, when enabled with --gpu-timers
+    GpuTimer gpuTimer;
+    // The ships, drawn instanced with their orientations interpolated on the GPU
+    GpuOrientations gpuOrientations;
+    std::vector<glm::vec3> shipInstancePositions;
 
     static glm::fquat orientation;
     static glm::vec3 cameraTarget;
@@ -428,9 +361,15 @@ public:
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
+
+        // The same mesh, with drawShip()'s scale and turn applied before the orientation
+        gpuOrientations.Create(shipVBO, static_cast<GLsizei>(shipVertexData.size() / 6), g_iGlobalMatricesBindingIndex);
+        MatrixStack meshMatrixStack;
+        meshMatrixStack.Scale(glm::vec3(3.0, 3.0, 3.0));
+        meshMatrixStack.RotateX(-90);
+        gpuOrientations.SetMeshMatrix(meshMatrixStack.Top());
     }
 
-    bool resizeFlag = false;
     void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
         // Update viewport dimensions on window resize
         glUseProgram(data.shaderProgram);
@@ -439,7 +378,6 @@ public:
         glViewport(0, 0, width, height);
         glUniform1i(windowWidthLocation, width);
         glUniform1i(windowHeightLocation, height);
-        resizeFlag = true;
     }
 
     void set_shader_sources() {
@@ -508,7 +446,7 @@ public:
 
             // Output or log the error information
             std::string shader_name = get_shader_label(shader);
-            std::cerr << shader_name << " compilation error; deleting shader...:\n" << infoLog << std::endl;
+            LOG_ERROR("{} compilation error; deleting shader...:\n{}", shader_name, infoLog);
 
             delete[] infoLog;
 
@@ -522,6 +460,7 @@ public:
     }
 
     void compile_and_link_shaders() {
+        PROFILE_FUNCTION();
         GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
         glObjectLabel(GL_SHADER, vertexShader, -1, "Vertex Shader");
         glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
@@ -546,12 +485,13 @@ public:
 
             auto* strInfoLog = new GLchar[infoLogLength + 1];
             glGetProgramInfoLog(data.shaderProgram, infoLogLength, nullptr, strInfoLog);
-            std::cerr << "Linker failure: \n" << strInfoLog;
+            LOG_ERROR("Linker failure: \n{}", strInfoLog);
             delete[] strInfoLog;
         }
     }
 
     void create_and_link_program() {
+        PROFILE_FUNCTION();
         data.shaderProgram = glCreateProgram();
 
         for (GLuint shader : shaders) {
@@ -602,13 +542,16 @@ public:
         return rotMat * transMat;
     }
 
-    void perform_render_sequence(GLFWwindow* window, Orientation& orient) {
-        orient.OrientationUpdateTime();
+    void perform_render_sequence(GLFWwindow* window) {
+        PROFILE_FUNCTION();
+        gpuTimer.BeginFrame();
+        g_animationSystem.Update(g_frameClock.Now());
 
         // Clear the color and depth buffers
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glUseProgram(data.shaderProgram);
+        g_renderStats.CountProgramBind();
 
         MatrixStack modelMatrixStack;
 
@@ -620,7 +563,7 @@ public:
         glm::mat4 projectionMatrix = glm::perspective(glm::radians(45.0f),
                                                       static_cast<GLfloat>(WINDOW_WIDTH) /
                                                       static_cast<GLfloat>(WINDOW_HEIGHT),
-                                                      1.0f, 600.0f);
+                                                      1.0f, std::max(600.0f, sphereCameraRelativePosition.z * 2.0f));
 
         data.modelMatrixLocation = glGetUniformLocation(data.shaderProgram, "modelMatrix");
 
@@ -628,22 +571,52 @@ public:
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(viewMatrix));
         glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(projectionMatrix));
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-        // Draw ship
-        drawShip(modelMatrixStack, orient);
+        g_renderStats.CountStateChange(2);
+        g_renderStats.CountBufferUpload(sizeof(glm::mat4) * 2);
+
+        // Draw ships
+        {
+            GpuPassScope gpuPass(gpuTimer, "Ship");
+            if (g_bGpuOrientations) {
+                drawShipsOnGpu(modelMatrixStack.Top());
+            }
+            else {
+                for (size_t ixShip = 0; ixShip < g_ships.size(); ixShip++)
+                    drawShip(modelMatrixStack, g_ships[ixShip].OrientationGetOrient(),
+                             g_shipPositions[ixShip] + g_shipTranslations[ixShip]);
+            }
+        }
 
         glUseProgram(0);
+        g_renderStats.CountProgramBind();
     }
 
-    void drawShip(MatrixStack modelMatrixStack, Orientation& orient) const {
+    void drawShip(MatrixStack modelMatrixStack, const glm::fquat& orient, const glm::vec3& position) const {
         modelMatrixStack.Push();
-        modelMatrixStack.ApplyMatrix(glm::mat4_cast(orient.OrientationGetOrient()));
+        modelMatrixStack.Translate(position);
+        modelMatrixStack.ApplyMatrix(glm::mat4_cast(orient));
         modelMatrixStack.Scale(glm::vec3(3.0, 3.0, 3.0));
         modelMatrixStack.RotateX(-90);
 
         glUniformMatrix4fv(data.modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(modelMatrixStack.Top()));
         glBindVertexArray(shipVAO);
         glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(shipVertexData.size()));
+        g_renderStats.CountUniformUpload();
+        g_renderStats.CountStateChange();
+        g_renderStats.CountDraw(GL_TRIANGLES, static_cast<GLsizei>(shipVertexData.size()));
+    }
+
+    // Every ship in one draw, uploading only the positions and animations that have changed
+    void drawShipsOnGpu(const glm::mat4& parentMatrix) {
+        if (g_bShipPositionsChanged) {
+            shipInstancePositions.resize(g_ships.size());
+            for (size_t ixShip = 0; ixShip < g_ships.size(); ixShip++)
+                shipInstancePositions[ixShip] = g_shipPositions[ixShip] + g_shipTranslations[ixShip];
+            gpuOrientations.SetPositions(shipInstancePositions);
+            g_bShipPositionsChanged = false;
+        }
+        gpuOrientations.Update(g_animationSystem, g_frameClock.Now());
+        gpuOrientations.Draw(g_frameClock.Now(), g_animationSystem.GetInterpolation(), parentMatrix);
     }
 
 
@@ -658,31 +631,185 @@ glm::vec3 Renderer::cameraTarget{0.0f, 0.0f, 0.0f};
 glm::vec3 Renderer::upVector{0.0f, 1.0f, 0.0f};
 glm::vec3 Renderer::sphereCameraRelativePosition{90.0f, 0.0f, 66.0f};
 
-void ApplyOrientation(int iIndex, Orientation& orient) {
-    std::cout << "Do i get here?,.,.," << "\n";
-    if(!Orientation::IsAnimating()) {
-        std::cout << "IsAnimating = false" << "\n";
-        orient.AnimateToOrient(iIndex);
-        std::cout << "In ApplyOrientation... destination Orient Index is: " << iIndex << "\n";
+// Sends every ship that is not already turning to Orients[iIndex]
+void ApplyOrientation(int iIndex) {
+    for (Orientation& ship : g_ships) {
+        if (!ship.IsAnimating()) {
+            ship.AnimateToOrient(iIndex);
+            LOG_DEBUG("In ApplyOrientation... destination Orient Index is: {}", iIndex);
+        }
+        else
+            LOG_DEBUG("Already animating...");
+    }
+}
+
+// Creates iShipCount ships; more than one are laid out in a square grid facing the camera, which
+// is pulled back far enough to take it in.
+static void createShips(int iShipCount) {
+    const float fSpacing = 16.0f;
+    const int iSide = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(iShipCount))));
+    const float fOffset = static_cast<float>(iSide - 1) * fSpacing * 0.5f;
+
+    g_ships.reserve(iShipCount);
+    g_shipPositions.reserve(iShipCount);
+    g_shipTranslations.assign(iShipCount, glm::vec3(0.0f));
+    g_animationSystem.Reserve(iShipCount);
+    for (int ixShip = 0; ixShip < iShipCount; ixShip++) {
+        g_ships.emplace_back();
+        g_shipPositions.emplace_back(static_cast<float>(ixShip % iSide) * fSpacing - fOffset,
+                                     static_cast<float>(ixShip / iSide) * fSpacing - fOffset, 0.0f);
+    }
+    if (iShipCount > 1)
+        Renderer::sphereCameraRelativePosition.z = std::max(Renderer::sphereCameraRelativePosition.z,
+                                                            static_cast<float>(iSide) * fSpacing * 0.9f);
+}
+
+// Loads the --animation clip for the ships to play; false if it cannot be loaded.
+static bool loadShipClip(const std::string& path) {
+    if (!g_shipClip.Load(path))
+        return false;
+    g_ixShipOrientTrack = g_shipClip.FindTrack(AnimationClip::Channel::ORIENTATION);
+    g_ixShipTranslationTrack = g_shipClip.FindTrack(AnimationClip::Channel::TRANSLATION);
+    g_shipOrientCursors.assign(g_ships.size(), AnimationClip::Cursor());
+    g_shipTranslationCursors.assign(g_ships.size(), AnimationClip::Cursor());
+    LOG_INFO("Animation clip: {} tracks, {} s", g_shipClip.GetTracks().size(), g_shipClip.GetDuration());
+    return true;
+}
+
+static void playShipClip() {
+    PROFILE_FUNCTION();
+    const float fDuration = g_shipClip.GetDuration();
+    const double fNow = std::chrono::duration<double>(g_frameClock.Now().time_since_epoch()).count();
+    for (size_t ixShip = 0; ixShip < g_ships.size(); ixShip++) {
+        const double fPhase = static_cast<double>(fDuration) * static_cast<double>(ixShip) /
+                              static_cast<double>(g_ships.size());
+        const float time = fDuration > 0.0f ? static_cast<float>(std::fmod(fNow + fPhase, fDuration)) : 0.0f;
+        if (g_ixShipOrientTrack >= 0)
+            g_ships[ixShip].SetOrient(g_shipClip.SampleOrientation(g_ixShipOrientTrack, time,
+                                                                   g_shipOrientCursors[ixShip]));
+        if (g_ixShipTranslationTrack >= 0)
+            g_shipTranslations[ixShip] = g_shipClip.SampleTranslation(g_ixShipTranslationTrack, time,
+                                                                      g_shipTranslationCursors[ixShip]);
+    }
+    if (g_ixShipTranslationTrack >= 0)
+        g_bShipPositionsChanged = true;
+}
+
+// With more than one ship, each one at rest sets off on its own for a random orientation, taking
+// 2 to 8 seconds to get there, so the fleet is always turning.
+static void wanderShips(std::mt19937& rng) {
+    PROFILE_FUNCTION();
+    std::uniform_int_distribution<int> orientDistribution(0, static_cast<int>(std::size(Orients)) - 1);
+    std::uniform_int_distribution<int> durationDistribution(2000, 8000);
+    for (Orientation& ship : g_ships) {
+        if (!ship.IsAnimating())
+            ship.AnimateToOrient(orientDistribution(rng), std::chrono::milliseconds(durationDistribution(rng)));
     }
-    else
-        std::cout << "Not animating..." << "\n";
+}
+
+// Sets up the ships' paths: one ship tours every orient in order, a key every g_orientDuration; a
+// fleet takes random tours of up to six, each ship at its own pace of 2 to 8 seconds a key. Keys
+// that are the same rotation as the one before are left out.
+static void createShipPaths(std::mt19937& rng) {
+    std::uniform_int_distribution<int> orientDistribution(0, static_cast<int>(std::size(Orients)) - 1);
+    std::uniform_int_distribution<int> durationDistribution(2000, 8000);
+    auto addKey = [](std::vector<glm::fquat>& keys, const glm::fquat& key) {
+        if (std::fabs(glm::dot(keys.back(), key)) < 0.9999f)
+            keys.push_back(key);
+    };
+
+    g_shipPaths.Clear();
+    g_shipPathRates.clear();
+    for (const Orientation& ship : g_ships) {
+        std::vector<glm::fquat> keys{ship.OrientationGetOrient()};
+        double fSecondsPerKey = std::chrono::duration<double>(g_orientDuration).count();
+        if (g_ships.size() == 1) {
+            for (const PackedQuat48& orient : Orients)
+                addKey(keys, decodeQuat48(orient));
+        }
+        else {
+            for (int iKey = 0; iKey < 6; iKey++)
+                addKey(keys, decodeQuat48(Orients[orientDistribution(rng)]));
+            fSecondsPerKey = static_cast<double>(durationDistribution(rng)) / 1000.0;
+        }
+        // The loop comes back round to the first key
+        if (keys.size() > 1 && std::fabs(glm::dot(keys.back(), keys.front())) >= 0.9999f)
+            keys.pop_back();
+        g_shipPaths.Add(keys, true);
+        g_shipPathRates.push_back(1.0 / fSecondsPerKey);
+    }
+    g_shipPathParameters.resize(g_ships.size());
+    g_shipPathStartTime = g_frameClock.Now();
+}
+
+// Poses every ship on its path for this frame, in one batch
+static void followShipPaths(std::mt19937& rng) {
+    PROFILE_FUNCTION();
+    if (g_shipPaths.IsEmpty())
+        createShipPaths(rng);
+
+    const double fSeconds = std::chrono::duration<double>(g_frameClock.Now() - g_shipPathStartTime).count();
+    for (size_t ixShip = 0; ixShip < g_ships.size(); ixShip++) {
+        // Wrapped into the loop here, in double precision, as the time only grows
+        const auto path = static_cast<OrientationPaths::PathId>(ixShip);
+        const auto fLength = static_cast<double>(g_shipPaths.GetLength(path));
+        const double fLoops = fSeconds * g_shipPathRates[ixShip] / fLength;
+        g_shipPathParameters[ixShip] = static_cast<float>((fLoops - std::floor(fLoops)) * fLength);
+    }
+    g_shipPaths.EvaluateAll(g_shipPathParameters.data(), g_shipPathOrients);
+    g_animationSystem.SetOrientations(g_shipPathOrients);
+}
+
+// Leaves the ships at rest wherever their paths had got to
+static void stopShipPaths() {
+    g_shipPaths.Clear();
+    for (Orientation& ship : g_ships)
+        ship.SetOrient(ship.OrientationGetOrient());
 }
 
 // GLFW key callback function
-static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods, Orientation& orient) {
+static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    g_frameScheduler.MarkDirty();
+
+    // Dump the profiler trace
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+        Profiler::Get().WriteChromeTrace();
+
+    // Print the render statistics
+    if (key == GLFW_KEY_F11 && action == GLFW_PRESS)
+        g_renderStats.PrintSnapshot(std::cout);
+
     if (action == GLFW_PRESS) {
         switch (key) {
             case GLFW_KEY_SPACE: {
-                orient.ToggleSlerp();
-                printf(Orientation::m_bSlerp ? "Slerp\n" : "Lerp\n");
+                g_bSlerp = !g_bSlerp;
+                applyInterpolation();
+                LOG_INFO("{}", g_bSlerp ? "Slerp" : "Lerp");
+                break;
+            }
+            case GLFW_KEY_F: {
+                g_bFastSlerp = !g_bFastSlerp;
+                applyInterpolation();
+                LOG_INFO("{}", g_bFastSlerp ? "Fast slerp" : "Exact slerp");
+                break;
+            }
+            case GLFW_KEY_P: {
+                g_bShipPaths = !g_bShipPaths;
+                if (!g_bShipPaths)
+                    stopShipPaths();
+                LOG_INFO("{}", g_bShipPaths ? "Squad paths" : "Orient to orient");
+                break;
+            }
+            case GLFW_KEY_G: {
+                setGpuOrientations(!g_bGpuOrientations);
+                LOG_INFO("{}", g_bGpuOrientations ? "GPU orientations" : "CPU orientations");
                 break;
             }
         }
 
         for (int iOrient = 0; iOrient < OrientKeys.size(); iOrient++) {
             if (key == OrientKeys[iOrient]) {
-                ApplyOrientation(iOrient, orient);
+                ApplyOrientation(iOrient);
             }
         }
     }
@@ -690,6 +817,8 @@ static void keyCallback(GLFWwindow* window, int key, int scancode, int action, i
 
 // GLFW requires a static or non-member function for the framebuffer size callback
 void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    g_frameScheduler.MarkDirty();
+
     // Retrieve the Renderer instance associated with the window
     auto* renderer = static_cast<Renderer*>(glfwGetWindowUserPointer(window));
 
@@ -699,14 +828,51 @@ void glfw_framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     }
 }
 
-int main() {
-    GLFWwindow* window = initializeGLFW();
+int main(int argc, char* argv[]) {
+    LaunchOptions options = parseLaunchOptions(argc, argv);
+    Profiler::Get().SetThreadName("Main");
+    if (!options.tracePath.empty())
+        Profiler::Get().SetTracePath(options.tracePath);
+
+    // Benchmark runs take the camera from a keyframed path instead of the keyboard
+    CameraPath cameraPath;
+    if (!options.cameraPathFile.empty()) {
+        if (!cameraPath.Load(options.cameraPathFile))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = cameraPath.GetFrameCount(options.fTimestep);
+        LOG_INFO("Camera path: {} s in steps of {} s, {} frames", cameraPath.GetDuration(), options.fTimestep,
+                 options.iFrameLimit);
+    }
+    int ixPathFrame = 0;
+
+    // Animation time, stepped once per frame
+    g_frameClock.SetTimeScale(options.fTimeScale);
+    if (options.bFixedTimestep)
+        g_frameClock.SetFixedStep(std::chrono::duration_cast<FrameClock::Duration>(
+                std::chrono::duration<double>(options.fTimestep)));
+
+    // Record this session's input, or replay a recorded one
+    if (!options.recordInputPath.empty() && !g_inputLog.StartRecording(options.recordInputPath))
+        return 1;
+    if (!options.replayInputPath.empty()) {
+        if (!g_inputLog.StartReplay(options.replayInputPath))
+            return 1;
+        if (options.iFrameLimit == 0)
+            options.iFrameLimit = g_inputLog.GetReplayFrameCount();
+    }
+
+    RenderBackend backend(options);
+    GLFWwindow* window = initializeGLFW(backend);
     initializeGLEW();
+    backend.Create(window);
 
     Renderer renderer = Renderer();
     renderer.set_shader_sources();
     renderer.compile_and_link_shaders();
     renderer.create_and_link_program();
+    if (options.bGpuTimers)
+        renderer.gpuTimer.Create();
 
     // Create and bind globalMatrices buffer object to context
     glGenBuffers(1, &g_GlobalMatricesUBO);
@@ -728,14 +894,20 @@ int main() {
     glUniform1i(windowWidthLocation, WINDOW_WIDTH);
     glUniform1i(windowHeightLocation, WINDOW_HEIGHT);
 
-    // Create Animation and Orientation instance
-    Orientation orient;
+    // Create the ships, whose orientations animate together in batches
+    createShips(options.iShipCount);
+    g_animationSystem.SetThreadCount(options.iAnimationThreads);
+    if (options.bGpuOrientations)
+        setGpuOrientations(true);
+    std::mt19937 shipRng(options.sceneSeed);
+    if (!options.animationClipFile.empty() && !loadShipClip(options.animationClipFile))
+        return 1;
 
     // Create plane and gimbals
-    std::cout << "Creating unit plane..." << "\n";
+    LOG_INFO("Creating unit plane...");
     renderer.createUnitPlane();
 
-    std::cout << "Creating ship..." << "\n";
+    LOG_INFO("Creating ship...");
     renderer.createShip();
 
     // Set initial positions
@@ -745,11 +917,28 @@ int main() {
     glfwSetWindowUserPointer(window, &renderer);
 
     // Set the key callback
-    glfwSetKeyCallback(window, reinterpret_cast<GLFWkeyfun>(keyCallback));
+    glfwSetKeyCallback(window, keyCallback);
 
     // Set the resize callback
     glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
+    // Log or replay input through the callbacks just set
+    g_inputLog.Attach(window);
+
+    // Start from the framebuffer actually created, which need not be the default window size
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    glfw_framebuffer_size_callback(window, framebufferWidth, framebufferHeight);
+
+    // Only redraw when something changed, unless asked to render continuously
+    g_frameScheduler.SetMode(options.bContinuousRendering ? FrameScheduler::Mode::CONTINUOUS
+                                                          : FrameScheduler::Mode::ON_DEMAND);
+    g_frameScheduler.Attach(window);
+
+    // Pace presentation with vsync, a frame-rate cap, or not at all
+    FramePacer framePacer(options.framePacing, options.fTargetFps);
+    framePacer.Apply();
+
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     glFrontFace(GL_CW);
@@ -759,30 +948,68 @@ int main() {
     glDepthFunc(GL_LEQUAL);
     glDepthRange(0.0f, 1.0f);
 
+    // Every frame time of a continuous run, for the percentile report and the baseline gate
+    FrameTimeHistogram frameTimes;
+
     // Render loop
     while (!glfwWindowShouldClose(window)) {
+        g_frameScheduler.SetAnimating(g_animationSystem.GetAnimatingCount() > 0 || g_ships.size() > 1 ||
+                                      !g_shipClip.IsEmpty() || g_bShipPaths);
+        // Process events, sleeping until a frame is needed
+        if (!g_frameScheduler.WaitForFrame())
+            continue;
+        PROFILE_SCOPE("Frame");
+
+        // Feed back recorded input and step the session clock
+        g_inputLog.BeginFrame(window);
+        // Sample this frame's animation time
+        g_frameClock.Tick(g_inputLog.Now());
+        if (!g_shipClip.IsEmpty())
+            playShipClip();
+        else if (g_bShipPaths)
+            followShipPaths(shipRng);
+        else if (g_ships.size() > 1)
+            wanderShips(shipRng);
+
         // Process input
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window, true);
         }
 
-        // Check if re-render is needed
-        if (renderer.resizeFlag) {
-            renderer.perform_render_sequence(window, orient);
-            renderer.resizeFlag = false; // Reset the flag
-        }
+        // The path advances by a fixed timestep per frame, however long the frame took
+        if (!cameraPath.IsEmpty())
+            cameraPath.Evaluate(static_cast<double>(ixPathFrame++) * options.fTimestep, Renderer::cameraTarget,
+                                Renderer::sphereCameraRelativePosition);
 
-        renderer.perform_render_sequence(window, orient);
+        g_renderStats.BeginFrame();
+        backend.BeginFrame();
+        renderer.perform_render_sequence(window);
 
-        // Swap front and back buffers
-        glfwSwapBuffers(window);
+        g_renderStats.EndFrame();
 
-        // Poll for and process events
-        glfwPollEvents();
+        // Swap front and back buffers (or finish the offscreen frame)
+        framePacer.WaitForNextFrame();
+        backend.PresentFrame(window);
+
+        // On-demand frames are spaced by input rather than by rendering, so only time continuous runs
+        if (g_frameScheduler.GetMode() == FrameScheduler::Mode::CONTINUOUS)
+            frameTimes.RecordFrame();
     }
 
+    g_inputLog.Finish();
+    int exitCode = finishFrameTimeReport(frameTimes, options);
+
+    // The GPU timer report goes straight to stdout, after whatever was logged before it
+    Logger::Get().Flush();
+    if (renderer.gpuTimer.IsEnabled())
+        renderer.gpuTimer.PrintReport(std::cout);
+    if (!options.tracePath.empty())
+        Profiler::Get().WriteChromeTrace();
+    if (!options.statsPath.empty())
+        g_renderStats.WriteFile(options.statsPath);
+
     // Terminate GLFW
     glfwTerminate();
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+// --- Software hierarchical-Z occlusion culler --- \\
+
+#include "occlusion.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE 1
+#endif
+
+namespace {
+    // Vertices closer than this (in clip space w) are treated as crossing the near plane.
+    const float kNearW = 1e-3f;
+
+    const std::vector<float> g_unitBoxPositions = {
+            -0.5f, -0.5f, 0.5f,
+            0.5f, -0.5f, 0.5f,
+            0.5f, 0.5f, 0.5f,
+            -0.5f, 0.5f, 0.5f,
+            -0.5f, -0.5f, -0.5f,
+            0.5f, -0.5f, -0.5f,
+            0.5f, 0.5f, -0.5f,
+            -0.5f, 0.5f, -0.5f
+    };
+
+    const std::vector<unsigned int> g_unitBoxIndices = {
+            0, 1, 2, 2, 3, 0, // front
+            4, 6, 5, 6, 4, 7, // back
+            4, 0, 3, 3, 7, 4, // left
+            1, 5, 6, 6, 2, 1, // right
+            3, 2, 6, 6, 7, 3, // top
+            0, 4, 5, 5, 1, 0  // bottom
+    };
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height, int threadCount)
+        : m_width((std::max(width, 4) + 3) & ~3), m_height(std::max(height, 1)) {
+    // Build the mip chain once; every level is half the size of the previous one (rounded up).
+    int mipWidth = m_width;
+    int mipHeight = m_height;
+    while (true) {
+        m_hiZ.push_back({mipWidth, mipHeight, std::vector<float>(static_cast<size_t>(mipWidth * mipHeight), 1.0f)});
+        if (mipWidth == 1 && mipHeight == 1)
+            break;
+        mipWidth = std::max(1, (mipWidth + 1) / 2);
+        mipHeight = std::max(1, (mipHeight + 1) / 2);
+    }
+
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1u, 4u));
+    m_bandCount = std::clamp(threadCount, 1, m_height);
+
+    for (int ixWorker = 1; ixWorker < m_bandCount; ixWorker++) {
+        m_workers.emplace_back(&OcclusionCuller::WorkerLoop, this, ixWorker);
+    }
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bShutdown = true;
+    }
+    m_startCondition.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection) {
+    m_viewProjection = viewProjection;
+    m_triangles.clear();
+    std::fill(m_hiZ[0].depth.begin(), m_hiZ[0].depth.end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluderBox(const glm::mat4& modelMatrix) {
+    AddOccluderMesh(modelMatrix, g_unitBoxPositions, g_unitBoxIndices);
+}
+
+void OcclusionCuller::AddOccluderMesh(const glm::mat4& modelMatrix, const std::vector<float>& positions,
+                                      const std::vector<unsigned int>& triangleIndices) {
+    const glm::mat4 modelViewProjection = m_viewProjection * modelMatrix;
+    const size_t vertexCount = positions.size() / 3;
+
+    // Project every vertex once; vertices crossing the near plane invalidate their triangles,
+    // which only ever makes the occluder smaller and so keeps the test conservative.
+    std::vector<glm::vec3> screen(vertexCount);
+    std::vector<bool> valid(vertexCount);
+    for (size_t ixVertex = 0; ixVertex < vertexCount; ixVertex++) {
+        glm::vec4 clip = modelViewProjection * glm::vec4(positions[ixVertex * 3], positions[ixVertex * 3 + 1],
+                                                         positions[ixVertex * 3 + 2], 1.0f);
+        valid[ixVertex] = clip.w > kNearW;
+        if (!valid[ixVertex])
+            continue;
+        float invW = 1.0f / clip.w;
+        screen[ixVertex] = glm::vec3((clip.x * invW * 0.5f + 0.5f) * static_cast<float>(m_width),
+                                     (clip.y * invW * 0.5f + 0.5f) * static_cast<float>(m_height),
+                                     std::clamp(clip.z * invW * 0.5f + 0.5f, 0.0f, 1.0f));
+    }
+
+    for (size_t ixIndex = 0; ixIndex + 2 < triangleIndices.size(); ixIndex += 3) {
+        unsigned int i0 = triangleIndices[ixIndex];
+        unsigned int i1 = triangleIndices[ixIndex + 1];
+        unsigned int i2 = triangleIndices[ixIndex + 2];
+        if (!valid[i0] || !valid[i1] || !valid[i2])
+            continue;
+
+        ScreenTriangle tri{};
+        const unsigned int corners[3] = {i0, i1, i2};
+        for (int ixCorner = 0; ixCorner < 3; ixCorner++) {
+            tri.x[ixCorner] = screen[corners[ixCorner]].x;
+            tri.y[ixCorner] = screen[corners[ixCorner]].y;
+            tri.z[ixCorner] = screen[corners[ixCorner]].z;
+        }
+        m_triangles.push_back(tri);
+    }
+}
+
+void OcclusionCuller::RasteriseOccluders() {
+    PROFILE_FUNCTION();
+    if (m_bandCount == 1) {
+        RasteriseBand(0, m_height);
+    }
+    else {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingBands = m_bandCount - 1;
+            m_generation++;
+        }
+        m_startCondition.notify_all();
+
+        // The calling thread takes the first band itself.
+        int bandHeight = (m_height + m_bandCount - 1) / m_bandCount;
+        RasteriseBand(0, std::min(bandHeight, m_height));
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] {return m_pendingBands == 0;});
+    }
+    BuildHiZ();
+}
+
+void OcclusionCuller::WorkerLoop(int ixWorker) {
+    Profiler::Get().SetThreadName("Occlusion worker");
+    unsigned long lastGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [&] {return m_bShutdown || m_generation != lastGeneration;});
+            if (m_bShutdown)
+                return;
+            lastGeneration = m_generation;
+        }
+
+        int bandHeight = (m_height + m_bandCount - 1) / m_bandCount;
+        int yBegin = std::min(ixWorker * bandHeight, m_height);
+        RasteriseBand(yBegin, std::min(yBegin + bandHeight, m_height));
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingBands--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+void OcclusionCuller::RasteriseBand(int yBegin, int yEnd) {
+    PROFILE_FUNCTION();
+    for (const ScreenTriangle& tri : m_triangles) {
+        RasteriseTriangle(tri, yBegin, yEnd);
+    }
+}
+
+void OcclusionCuller::RasteriseTriangle(const ScreenTriangle& tri, int yBegin, int yEnd) {
+    float x0 = tri.x[0], y0 = tri.y[0], z0 = tri.z[0];
+    float x1 = tri.x[1], y1 = tri.y[1], z1 = tri.z[1];
+    float x2 = tri.x[2], y2 = tri.y[2], z2 = tri.z[2];
+
+    // Occluders are rasterised double sided, so orient every triangle counter-clockwise.
+    float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (area < 0.0f) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        std::swap(z1, z2);
+        area = -area;
+    }
+    if (area < 1e-6f)
+        return;
+
+    int minX = std::max(0, static_cast<int>(std::floor(std::min({x0, x1, x2}))));
+    int maxX = std::min(m_width - 1, static_cast<int>(std::ceil(std::max({x0, x1, x2}))));
+    int minY = std::max(yBegin, static_cast<int>(std::floor(std::min({y0, y1, y2}))));
+    int maxY = std::min(yEnd - 1, static_cast<int>(std::ceil(std::max({y0, y1, y2}))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // Edge functions E(p) = A * p.x + B * p.y + C, positive inside.
+    const float a0 = y0 - y1, b0 = x1 - x0, c0 = -(a0 * x0 + b0 * y0);
+    const float a1 = y1 - y2, b1 = x2 - x1, c1 = -(a1 * x1 + b1 * y1);
+    const float a2 = y2 - y0, b2 = x0 - x2, c2 = -(a2 * x2 + b2 * y2);
+
+    // Depth plane z(p) = z0 + dzdx * (p.x - x0) + dzdy * (p.y - y0), pushed back by its change
+    // across half a texel so that every texel stores the farthest depth the plane has in it
+    // rather than the depth at its centre.
+    const float dzdx = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area;
+    const float dzdy = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) / area;
+    z0 += 0.5f * (std::fabs(dzdx) + std::fabs(dzdy));
+
+    std::vector<float>& depth = m_hiZ[0].depth;
+    const int xStart = minX & ~3;
+
+#ifdef OCCLUSION_USE_SSE
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 vA0 = _mm_set1_ps(a0), vA1 = _mm_set1_ps(a1), vA2 = _mm_set1_ps(a2);
+    const __m128 vDzdx = _mm_set1_ps(dzdx);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int y = minY; y <= maxY; y++) {
+        const float py = static_cast<float>(y) + 0.5f;
+        const __m128 vRow0 = _mm_set1_ps(b0 * py + c0);
+        const __m128 vRow1 = _mm_set1_ps(b1 * py + c1);
+        const __m128 vRow2 = _mm_set1_ps(b2 * py + c2);
+        const __m128 vRowZ = _mm_set1_ps(z0 + dzdy * (py - y0) - dzdx * x0);
+        float* row = &depth[static_cast<size_t>(y * m_width)];
+
+        for (int x = xStart; x <= maxX; x += 4) {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA0, px), vRow0), zero);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA1, px), vRow1), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vA2, px), vRow2), zero));
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            const __m128 z = _mm_add_ps(vRowZ, _mm_mul_ps(vDzdx, px));
+            const __m128 previous = _mm_loadu_ps(row + x);
+            const __m128 nearest = _mm_min_ps(previous, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; y++) {
+        const float py = static_cast<float>(y) + 0.5f;
+        float* row = &depth[static_cast<size_t>(y * m_width)];
+        for (int x = xStart; x <= maxX; x++) {
+            const float px = static_cast<float>(x) + 0.5f;
+            if (a0 * px + b0 * py + c0 < 0.0f || a1 * px + b1 * py + c1 < 0.0f || a2 * px + b2 * py + c2 < 0.0f)
+                continue;
+            const float z = z0 + dzdx * (px - x0) + dzdy * (py - y0);
+            row[x] = std::min(row[x], z);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::BuildHiZ() {
+    PROFILE_FUNCTION();
+    // Each texel keeps the farthest depth of the texels it covers, so a box whose nearest point
+    // lies behind that depth is hidden everywhere underneath it.
+    for (size_t ixMip = 1; ixMip < m_hiZ.size(); ixMip++) {
+        const MipLevel& source = m_hiZ[ixMip - 1];
+        MipLevel& target = m_hiZ[ixMip];
+        for (int y = 0; y < target.height; y++) {
+            int sy0 = std::min(y * 2, source.height - 1);
+            int sy1 = std::min(y * 2 + 1, source.height - 1);
+            for (int x = 0; x < target.width; x++) {
+                int sx0 = std::min(x * 2, source.width - 1);
+                int sx1 = std::min(x * 2 + 1, source.width - 1);
+                target.depth[y * target.width + x] = std::max(
+                        std::max(source.depth[sy0 * source.width + sx0], source.depth[sy0 * source.width + sx1]),
+                        std::max(source.depth[sy1 * source.width + sx0], source.depth[sy1 * source.width + sx1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const glm::mat4& modelMatrix, const glm::vec3& localMin,
+                                const glm::vec3& localMax) const {
+    const glm::mat4 modelViewProjection = m_viewProjection * modelMatrix;
+
+    float minX = static_cast<float>(m_width), maxX = 0.0f;
+    float minY = static_cast<float>(m_height), maxY = 0.0f;
+    float minDepth = 1.0f;
+    for (int ixCorner = 0; ixCorner < 8; ixCorner++) {
+        glm::vec4 corner((ixCorner & 1) ? localMax.x : localMin.x,
+                         (ixCorner & 2) ? localMax.y : localMin.y,
+                         (ixCorner & 4) ? localMax.z : localMin.z, 1.0f);
+        glm::vec4 clip = modelViewProjection * corner;
+
+        // Boxes that straddle the near plane are always drawn.
+        if (clip.w <= kNearW)
+            return true;
+
+        float invW = 1.0f / clip.w;
+        float sx = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+        float sy = (clip.y * invW * 0.5f + 0.5f) * static_cast<float>(m_height);
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        minDepth = std::min(minDepth, clip.z * invW * 0.5f + 0.5f);
+    }
+
+    // Completely outside the view.
+    if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(m_width) || minY >= static_cast<float>(m_height))
+        return false;
+
+    // Occluders cover the texels whose centres they cover, so a texel on an occluder's edge can be
+    // stored as hidden while part of it shows. Growing the rectangle by a texel on every side takes
+    // in the texel beyond that edge, which the occluder leaves uncovered.
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)) - 1);
+    int x1 = std::min(m_width - 1, static_cast<int>(std::floor(maxX)) + 1);
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)) - 1);
+    int y1 = std::min(m_height - 1, static_cast<int>(std::floor(maxY)) + 1);
+
+    // Walk down the pyramid until the rectangle is covered by at most 2x2 texels.
+    int ixMip = 0;
+    while (ixMip + 1 < static_cast<int>(m_hiZ.size()) &&
+           ((x1 >> ixMip) - (x0 >> ixMip) > 1 || (y1 >> ixMip) - (y0 >> ixMip) > 1)) {
+        ixMip++;
+    }
+
+    const MipLevel& mip = m_hiZ[ixMip];
+    float farthestOccluder = 0.0f;
+    for (int y = y0 >> ixMip; y <= (y1 >> ixMip); y++) {
+        for (int x = x0 >> ixMip; x <= (x1 >> ixMip); x++) {
+            farthestOccluder = std::max(farthestOccluder, mip.depth[y * mip.width + x]);
+        }
+    }
+    return minDepth <= farthestOccluder;
+}
+
+float OcclusionCuller::GetDepth(int mip, int x, int y) const {
+    const MipLevel& level = m_hiZ[static_cast<size_t>(mip)];
+    return level.depth[static_cast<size_t>(y * level.width + x)];
+}
@@ -0,0 +1,81 @@
+// --- Declares the software hierarchical-Z occlusion culler --- \\
+
+#ifndef CLIONPROJECTS_OCCLUSION_H
+#define CLIONPROJECTS_OCCLUSION_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Rasterises a handful of occluders into a low resolution depth buffer on the CPU, builds a
+// max-depth mip pyramid from it and tests bounding boxes against the pyramid before they are
+// submitted to OpenGL. Depth is stored in window space ([0, 1], 1 = far plane). Boxes are tested
+// conservatively, over one more texel on every side than they cover and against the farthest
+// depth each occluder texel reaches, so a box peeking out past an occluder's edge stays visible.
+class OcclusionCuller {
+public:
+    explicit OcclusionCuller(int width = 256, int height = 192, int threadCount = 0);
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // Clears the depth buffer and the occluder list for a new view.
+    void BeginFrame(const glm::mat4& viewProjection);
+
+    // Adds the unit cube (-0.5..0.5 on every axis) transformed by modelMatrix as an occluder.
+    void AddOccluderBox(const glm::mat4& modelMatrix);
+
+    // Adds an indexed triangle list (3 floats per position) transformed by modelMatrix as an occluder.
+    void AddOccluderMesh(const glm::mat4& modelMatrix, const std::vector<float>& positions,
+                         const std::vector<unsigned int>& triangleIndices);
+
+    // Rasterises every queued occluder, split into horizontal bands across the worker threads,
+    // then rebuilds the hierarchical-Z pyramid.
+    void RasteriseOccluders();
+
+    // Returns false only if the box (in model space) is completely hidden behind the occluders
+    // or entirely outside the view.
+    [[nodiscard]] bool IsVisible(const glm::mat4& modelMatrix, const glm::vec3& localMin,
+                                 const glm::vec3& localMax) const;
+
+    [[nodiscard]] int GetWidth() const {return m_width;}
+    [[nodiscard]] int GetHeight() const {return m_height;}
+    [[nodiscard]] int GetMipCount() const {return static_cast<int>(m_hiZ.size());}
+    [[nodiscard]] float GetDepth(int mip, int x, int y) const;
+
+private:
+    struct ScreenTriangle {
+        float x[3], y[3], z[3];
+    };
+
+    struct MipLevel {
+        int width;
+        int height;
+        std::vector<float> depth;
+    };
+
+    void RasteriseBand(int yBegin, int yEnd);
+    void RasteriseTriangle(const ScreenTriangle& tri, int yBegin, int yEnd);
+    void BuildHiZ();
+    void WorkerLoop(int ixWorker);
+
+    int m_width;
+    int m_height;
+    glm::mat4 m_viewProjection{1.0f};
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<MipLevel> m_hiZ;
+
+    // Persistent worker pool; worker 0 is the calling thread.
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    unsigned long m_generation = 0;
+    int m_pendingBands = 0;
+    int m_bandCount = 1;
+    bool m_bShutdown = false;
+};
+
+#endif // CLIONPROJECTS_OCCLUSION_H
@@ -0,0 +1,68 @@
+// --- Occlusion culler check: one occluder, and boxes behind, in front of and beside it --- \\
+
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "logger.cpp"
+#include "profiler.cpp"
+#include "occlusion.cpp"
+#include <iostream>
+
+namespace {
+    // An orthographic view down -z onto the x and y range [-1, 1], so one unit is half the
+    // culler's width in texels and box edges can be put at known fractions of a texel.
+    const int g_iCullerSize = 64;
+    const glm::mat4 g_viewProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 10.0f) *
+                                       glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // The world x at which a texel column boundary (or a fraction past one) lies
+    float texelToX(float fTexel) {
+        return fTexel / (0.5f * static_cast<float>(g_iCullerSize)) - 1.0f;
+    }
+
+    glm::mat4 boxMatrix(const glm::vec3& min, const glm::vec3& max) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), 0.5f * (min + max)), max - min);
+    }
+
+    // Rasterises a thin occluder at z = 0 whose right edge ends 0.7 of the way across a texel,
+    // then tests boxes at z = -2 (behind it) and z = 2 (in front). The box peeking out from
+    // behind that edge by a fifth of a texel must stay visible: its uncovered part lies in a
+    // texel whose centre the occluder covers. Returns whether every box came out as expected.
+    bool checkOcclusion(int threadCount) {
+        OcclusionCuller culler(g_iCullerSize, g_iCullerSize, threadCount);
+        culler.BeginFrame(g_viewProjection);
+        culler.AddOccluderBox(boxMatrix(glm::vec3(-0.8f, -0.8f, -0.1f), glm::vec3(texelToX(47.7f), 0.8f, 0.1f)));
+        culler.RasteriseOccluders();
+
+        struct Case {
+            const char* name;
+            glm::vec3 min;
+            glm::vec3 max;
+            bool bExpectVisible;
+        };
+        const Case cases[] = {
+                {"behind", glm::vec3(-0.2f, -0.2f, -2.2f), glm::vec3(0.2f, 0.2f, -1.8f), false},
+                {"in front", glm::vec3(-0.2f, -0.2f, 1.8f), glm::vec3(0.2f, 0.2f, 2.2f), true},
+                {"beside", glm::vec3(0.6f, -0.2f, -2.2f), glm::vec3(0.7f, 0.2f, -1.8f), true},
+                {"peeking out", glm::vec3(texelToX(40.0f), -0.1f, -2.2f), glm::vec3(texelToX(47.9f), 0.1f, -1.8f), true},
+        };
+
+        bool bPassed = true;
+        for (const Case& test : cases) {
+            const bool bVisible = culler.IsVisible(glm::mat4(1.0f), test.min, test.max);
+            std::cout << "Occlusion (" << threadCount << " thread" << (threadCount == 1 ? "" : "s") << "), box "
+                      << test.name << ": " << (bVisible ? "visible" : "culled")
+                      << (bVisible == test.bExpectVisible ? "" : " (FAIL)") << "\n";
+            bPassed = bPassed && bVisible == test.bExpectVisible;
+        }
+        return bPassed;
+    }
+}
+
+// Usage: occlusion_check. Exits non-zero if the culler hides a box that shows or draws one that
+// is hidden.
+int main() {
+    const bool bSingleThreadPassed = checkOcclusion(1);
+    const bool bBandsPassed = checkOcclusion(3);
+    Logger::Get().Flush();
+    return bSingleThreadPassed && bBandsPassed ? 0 : 1;
+}
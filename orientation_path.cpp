@@ -0,0 +1,89 @@
+// --- Squad orientation paths --- \\
+
+#include "orientation_path.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // m_ixSegment for a path EvaluateAll() has not yet set up
+    constexpr std::uint32_t g_ixNoSegment = std::numeric_limits<std::uint32_t>::max();
+}
+
+OrientationPaths::PathId OrientationPaths::Add(const std::vector<glm::fquat>& keys, bool bLoop) {
+    const Path path{static_cast<std::uint32_t>(m_keys.size()), static_cast<std::uint32_t>(keys.size()), bLoop};
+    const size_t keyCount = keys.size();
+    for (const glm::fquat& key : keys)
+        m_keys.push_back(glm::normalize(key));
+    // The end keys of a path that does not loop stand in for their missing neighbours.
+    for (size_t ixKey = 0; ixKey < keyCount; ixKey++) {
+        const size_t ixPrev = ixKey > 0 ? ixKey - 1 : bLoop ? keyCount - 1 : 0;
+        const size_t ixNext = ixKey + 1 < keyCount ? ixKey + 1 : bLoop ? 0 : keyCount - 1;
+        m_controls.push_back(squadControl(m_keys[path.ixFirstKey + ixPrev], m_keys[path.ixFirstKey + ixKey],
+                                          m_keys[path.ixFirstKey + ixNext]));
+    }
+
+    m_paths.push_back(path);
+    m_ixSegment.push_back(g_ixNoSegment);
+    return static_cast<PathId>(m_paths.size() - 1);
+}
+
+void OrientationPaths::Clear() {
+    m_paths.clear();
+    m_keys.clear();
+    m_controls.clear();
+    m_ixSegment.clear();
+}
+
+std::uint32_t OrientationPaths::Locate(const Path& path, float parameter, float& alpha) {
+    const std::uint32_t segmentCount = SegmentCount(path);
+    const auto fLength = static_cast<float>(segmentCount);
+    // Callers advancing a parameter usually keep it in range themselves, and fmod is slow.
+    if (path.bLoop && (parameter < 0.0f || parameter >= fLength)) {
+        parameter = std::fmod(parameter, fLength);
+        if (parameter < 0.0f)
+            parameter += fLength;
+    }
+    parameter = std::clamp(parameter, 0.0f, fLength);
+    const std::uint32_t ixSegment = std::min(static_cast<std::uint32_t>(parameter), segmentCount - 1);
+    alpha = parameter - static_cast<float>(ixSegment);
+    return ixSegment;
+}
+
+std::uint32_t OrientationPaths::SegmentEnd(const Path& path, std::uint32_t ixSegment) {
+    const std::uint32_t ixEnd = path.bLoop ? (ixSegment + 1) % path.keyCount
+                                           : std::min(ixSegment + 1, path.keyCount - 1);
+    return path.ixFirstKey + ixEnd;
+}
+
+glm::fquat OrientationPaths::Evaluate(PathId pathId, float parameter) const {
+    const Path& path = m_paths[pathId];
+    float alpha;
+    const std::uint32_t ixSegment = Locate(path, parameter, alpha);
+    const std::uint32_t ixStart = path.ixFirstKey + ixSegment;
+    const std::uint32_t ixEnd = SegmentEnd(path, ixSegment);
+    return squad(m_keys[ixStart], m_keys[ixEnd], m_controls[ixStart], m_controls[ixEnd], alpha);
+}
+
+void OrientationPaths::EvaluateAll(const float* parameters, QuatArray& out) {
+    const size_t count = Size();
+    for (QuatArray* quats : {&m_start, &m_end, &m_startControl, &m_endControl})
+        quats->Resize(count);
+    m_alpha.resize(count);
+
+    for (size_t ixPath = 0; ixPath < count; ixPath++) {
+        const Path& path = m_paths[ixPath];
+        const std::uint32_t ixSegment = Locate(path, parameters[ixPath], m_alpha[ixPath]);
+        if (ixSegment == m_ixSegment[ixPath])
+            continue;
+        m_ixSegment[ixPath] = ixSegment;
+        const std::uint32_t ixStart = path.ixFirstKey + ixSegment;
+        const std::uint32_t ixEnd = SegmentEnd(path, ixSegment);
+        m_start.Set(ixPath, m_keys[ixStart]);
+        m_end.Set(ixPath, m_keys[ixEnd]);
+        m_startControl.Set(ixPath, m_controls[ixStart]);
+        m_endControl.Set(ixPath, m_controls[ixEnd]);
+    }
+
+    batchSquad(m_start, m_end, m_startControl, m_endControl, m_alpha.data(), out);
+}
@@ -0,0 +1,70 @@
+// --- Declares the squad orientation paths --- \\
+
+#ifndef CLIONPROJECTS_ORIENTATION_PATH_H
+#define CLIONPROJECTS_ORIENTATION_PATH_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "quat_batch.h"
+#include <cstdint>
+#include <vector>
+
+// Any number of orientation paths, each through its own sequence of keys and interpolated by squad
+// (see batchSquad), so an object following one turns through every key without a jolt, where
+// chained slerps stop dead at each key and set off again. Each key's squad control point is worked
+// out once, when its path is added.
+//
+// A path's parameter is 0 at its first key, 1 at the next and so on; a path that loops runs on
+// from its last key back to its first, and one that does not holds its end keys outside its
+// range. Keys are evenly spaced in parameter, so for an even pace advance it at a constant rate.
+//
+// EvaluateAll() evaluates every path in one call: it keeps each path's current segment in
+// structure-of-arrays form for batchSquad, and looks up keys only for paths that have moved on to
+// another segment since the last call.
+class OrientationPaths {
+public:
+    using PathId = std::uint32_t;
+
+    // Adds a path through keys, which must not be empty.
+    PathId Add(const std::vector<glm::fquat>& keys, bool bLoop);
+    void Clear();
+
+    [[nodiscard]] size_t Size() const {return m_paths.size();}
+    [[nodiscard]] bool IsEmpty() const {return m_paths.empty();}
+    // Parameter range of the path: its key count if it loops, one less if not
+    [[nodiscard]] float GetLength(PathId path) const {return static_cast<float>(SegmentCount(m_paths[path]));}
+
+    [[nodiscard]] glm::fquat Evaluate(PathId path, float parameter) const;
+    // Evaluates path i at parameters[i] for every path, into out (resized to Size()). The same as
+    // calling Evaluate() for each, bit for bit.
+    void EvaluateAll(const float* parameters, QuatArray& out);
+
+private:
+    struct Path {
+        // The path's keys and control points are m_keys[ixFirstKey...] and m_controls[ixFirstKey...]
+        std::uint32_t ixFirstKey;
+        std::uint32_t keyCount;
+        bool bLoop;
+    };
+
+    static std::uint32_t SegmentCount(const Path& path) {
+        return path.bLoop || path.keyCount == 1 ? path.keyCount : path.keyCount - 1;
+    }
+    // The segment containing parameter, and how far through it parameter is
+    static std::uint32_t Locate(const Path& path, float parameter, float& alpha);
+    // Index into m_keys of the key ending the segment
+    static std::uint32_t SegmentEnd(const Path& path, std::uint32_t ixSegment);
+
+    std::vector<Path> m_paths;
+    std::vector<glm::fquat> m_keys;
+    std::vector<glm::fquat> m_controls;
+
+    // EvaluateAll()'s segment for each path, with its keys, control points and parameter
+    std::vector<std::uint32_t> m_ixSegment;
+    QuatArray m_start;
+    QuatArray m_end;
+    QuatArray m_startControl;
+    QuatArray m_endControl;
+    std::vector<float> m_alpha;
+};
+
+#endif // CLIONPROJECTS_ORIENTATION_PATH_H
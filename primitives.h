@@ -0,0 +1,183 @@
+// --- Declares the compile-time unit primitive generators --- \\
+
+#ifndef CLIONPROJECTS_PRIMITIVES_H
+#define CLIONPROJECTS_PRIMITIVES_H
+#include <array>
+#include <cstddef>
+
+// Vertex and index tables for the unit cube, cylinder and cone, generated at compile time.
+// Every generator is constexpr, so a table declared `static constexpr` costs nothing at runtime
+// and any segment count (or LOD level) can be instantiated without pasting float literals.
+namespace primitives {
+    struct Colour {
+        float r, g, b;
+    };
+
+    // Vertex formats. Write() stores one vertex at the start of dst.
+    struct PositionColour {
+        static constexpr std::size_t FloatsPerVertex = 6;
+
+        static constexpr void Write(float* dst, float x, float y, float z, const Colour& colour) {
+            dst[0] = x; dst[1] = y; dst[2] = z;
+            dst[3] = colour.r; dst[4] = colour.g; dst[5] = colour.b;
+        }
+    };
+
+    struct PositionOnly {
+        static constexpr std::size_t FloatsPerVertex = 3;
+
+        static constexpr void Write(float* dst, float x, float y, float z, const Colour&) {
+            dst[0] = x; dst[1] = y; dst[2] = z;
+        }
+    };
+
+    // Attribute stream to pair with a PositionOnly stream.
+    struct ColourOnly {
+        static constexpr std::size_t FloatsPerVertex = 3;
+
+        static constexpr void Write(float* dst, float, float, float, const Colour& colour) {
+            dst[0] = colour.r; dst[1] = colour.g; dst[2] = colour.b;
+        }
+    };
+
+    constexpr double g_dPi = 3.14159265358979323846;
+    constexpr float g_fConeHeight = 0.866f;
+
+    // Taylor series, accurate to double precision once the angle is reduced to [-pi, pi].
+    constexpr double Sin(double x) {
+        while (x > g_dPi)
+            x -= 2.0 * g_dPi;
+        while (x < -g_dPi)
+            x += 2.0 * g_dPi;
+
+        double term = x;
+        double sum = x;
+        for (int i = 1; i < 14; i++) {
+            term *= -x * x / static_cast<double>((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double Cos(double x) {
+        return Sin(x + g_dPi / 2.0);
+    }
+
+    // Point iSegment of a radius 0.5 circle, counter-clockwise from +x towards +z.
+    constexpr float RimX(int iSegment, int iSegments) {
+        return static_cast<float>(0.5 * Cos(2.0 * g_dPi * iSegment / iSegments));
+    }
+
+    constexpr float RimZ(int iSegment, int iSegments) {
+        return static_cast<float>(0.5 * Sin(2.0 * g_dPi * iSegment / iSegments));
+    }
+
+    // Cube: 8 corners, the bottom four use bottomColour and the top four topColour.
+    template <typename Format>
+    constexpr std::array<float, 8 * Format::FloatsPerVertex> UnitCubeVertices(const Colour& bottomColour,
+                                                                              const Colour& topColour) {
+        std::array<float, 8 * Format::FloatsPerVertex> vertices{};
+        constexpr float corners[8][3] = {
+                {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f},
+                {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}
+        };
+        for (std::size_t ixCorner = 0; ixCorner < 8; ixCorner++) {
+            const float* corner = corners[ixCorner];
+            Format::Write(vertices.data() + ixCorner * Format::FloatsPerVertex, corner[0], corner[1], corner[2],
+                          corner[1] < 0.0f ? bottomColour : topColour);
+        }
+        return vertices;
+    }
+
+    constexpr std::array<unsigned int, 36> UnitCubeIndices() {
+        return {
+                0, 1, 2, 2, 3, 0, // front
+                4, 5, 6, 6, 7, 4, // back
+                4, 0, 2, 2, 7, 4, // left
+                1, 5, 6, 6, 2, 1, // right
+                3, 2, 6, 6, 7, 3, // top
+                0, 1, 5, 5, 4, 0  // bottom
+        };
+    }
+
+    // Cylinder: top centre, then a (top, bottom) pair for every rim point, then the bottom centre.
+    template <typename Format, int Segments>
+    constexpr std::array<float, (2 * Segments + 2) * Format::FloatsPerVertex> UnitCylinderVertices(
+            const Colour& colour) {
+        std::array<float, (2 * Segments + 2) * Format::FloatsPerVertex> vertices{};
+        float* dst = vertices.data();
+        Format::Write(dst, 0.0f, 0.5f, 0.0f, colour);
+        for (int iSegment = 0; iSegment < Segments; iSegment++) {
+            float fX = RimX(iSegment, Segments);
+            float fZ = RimZ(iSegment, Segments);
+            Format::Write(dst + (1 + 2 * iSegment) * Format::FloatsPerVertex, fX, 0.5f, fZ, colour);
+            Format::Write(dst + (2 + 2 * iSegment) * Format::FloatsPerVertex, fX, -0.5f, fZ, colour);
+        }
+        Format::Write(dst + (2 * Segments + 1) * Format::FloatsPerVertex, 0.0f, -0.5f, 0.0f, colour);
+        return vertices;
+    }
+
+    template <int Segments>
+    constexpr std::array<unsigned int, Segments + 2> UnitCylinderTriFan1() {
+        std::array<unsigned int, Segments + 2> indices{};
+        indices[0] = 0;
+        for (int iSegment = 0; iSegment < Segments; iSegment++)
+            indices[1 + iSegment] = 1 + 2 * iSegment;
+        indices[Segments + 1] = 1;
+        return indices;
+    }
+
+    template <int Segments>
+    constexpr std::array<unsigned int, Segments + 2> UnitCylinderTriFan2() {
+        std::array<unsigned int, Segments + 2> indices{};
+        indices[0] = 2 * Segments + 1;
+        for (int iSegment = 0; iSegment < Segments; iSegment++)
+            indices[1 + iSegment] = 2 * Segments - 2 * iSegment;
+        indices[Segments + 1] = 2 * Segments;
+        return indices;
+    }
+
+    template <int Segments>
+    constexpr std::array<unsigned int, 2 * Segments + 2> UnitCylinderTriStrip() {
+        std::array<unsigned int, 2 * Segments + 2> indices{};
+        for (int iVertex = 0; iVertex < 2 * Segments; iVertex++)
+            indices[iVertex] = 1 + iVertex;
+        indices[2 * Segments] = 1;
+        indices[2 * Segments + 1] = 2;
+        return indices;
+    }
+
+    // Cone: apex, the rim points, then the base centre.
+    template <typename Format, int Segments>
+    constexpr std::array<float, (Segments + 2) * Format::FloatsPerVertex> UnitConeVertices(const Colour& colour) {
+        std::array<float, (Segments + 2) * Format::FloatsPerVertex> vertices{};
+        float* dst = vertices.data();
+        Format::Write(dst, 0.0f, g_fConeHeight, 0.0f, colour);
+        for (int iSegment = 0; iSegment < Segments; iSegment++)
+            Format::Write(dst + (1 + iSegment) * Format::FloatsPerVertex, RimX(iSegment, Segments), 0.0f,
+                          RimZ(iSegment, Segments), colour);
+        Format::Write(dst + (Segments + 1) * Format::FloatsPerVertex, 0.0f, 0.0f, 0.0f, colour);
+        return vertices;
+    }
+
+    template <int Segments>
+    constexpr std::array<unsigned int, Segments + 2> UnitConeTriFan1() {
+        std::array<unsigned int, Segments + 2> indices{};
+        for (int iVertex = 0; iVertex <= Segments; iVertex++)
+            indices[iVertex] = iVertex;
+        indices[Segments + 1] = 1;
+        return indices;
+    }
+
+    template <int Segments>
+    constexpr std::array<unsigned int, Segments + 2> UnitConeTriFan2() {
+        std::array<unsigned int, Segments + 2> indices{};
+        indices[0] = Segments + 1;
+        for (int iSegment = 0; iSegment < Segments; iSegment++)
+            indices[1 + iSegment] = Segments - iSegment;
+        indices[Segments + 1] = Segments;
+        return indices;
+    }
+}
+
+#endif // CLIONPROJECTS_PRIMITIVES_H
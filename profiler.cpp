@@ -0,0 +1,144 @@
+// --- Scoped CPU profiler with Chrome trace export --- \\
+
+#include "profiler.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+    std::int64_t ReadTicks() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return static_cast<std::int64_t>(__rdtsc());
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Both clocks sampled together when the program starts; pairing them with a second sample
+    // when the trace is written gives the tick rate.
+    const std::chrono::steady_clock::time_point g_epochTime = std::chrono::steady_clock::now();
+    const std::int64_t g_epochTicks = ReadTicks();
+
+    void WriteJsonString(FILE* file, const char* text) {
+        std::fputc('"', file);
+        for (const char* c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\')
+                std::fputc('\\', file);
+            std::fputc(*c, file);
+        }
+        std::fputc('"', file);
+    }
+}
+
+thread_local Profiler::ThreadBuffer* Profiler::t_pThreadBuffer = nullptr;
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+std::int64_t Profiler::Now() {
+    return ReadTicks();
+}
+
+std::int64_t Profiler::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epochTime).count();
+}
+
+Profiler::ThreadBuffer& Profiler::RegisterThread() {
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    m_threads.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer& buffer = *m_threads.back();
+    buffer.threadId = static_cast<int>(m_threads.size());
+    t_pThreadBuffer = &buffer;
+    return buffer;
+}
+
+void Profiler::Record(const char* name, std::int64_t startTicks, std::int64_t endTicks) {
+    ThreadBuffer& buffer = t_pThreadBuffer != nullptr ? *t_pThreadBuffer : RegisterThread();
+
+    // Only this thread writes, so a relaxed read of its own index is enough; the release store
+    // publishes the event to a dump running on another thread.
+    std::uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    buffer.events[index & (g_iRingCapacity - 1)] = {name, startTicks, endTicks};
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::RecordGpu(const char* name, std::int64_t startNs, std::int64_t endNs) {
+    if (m_pGpuBuffer == nullptr) {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threads.push_back(std::make_unique<ThreadBuffer>());
+        m_pGpuBuffer = m_threads.back().get();
+        m_pGpuBuffer->threadId = 0;
+        m_pGpuBuffer->name = "GPU";
+        m_pGpuBuffer->bNanoseconds = true;
+    }
+
+    std::uint64_t index = m_pGpuBuffer->writeIndex.load(std::memory_order_relaxed);
+    m_pGpuBuffer->events[index & (g_iRingCapacity - 1)] = {name, startNs, endNs};
+    m_pGpuBuffer->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name) {
+    ThreadBuffer& buffer = t_pThreadBuffer != nullptr ? *t_pThreadBuffer : RegisterThread();
+
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    buffer.name = name;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Failed to write trace: {}", path);
+        return false;
+    }
+
+    double fElapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_epochTime).count();
+    double fUsPerTick = fElapsedUs / static_cast<double>(std::max<std::int64_t>(ReadTicks() - g_epochTicks, 1));
+
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool bFirst = true;
+    size_t eventCount = 0;
+    for (const auto& pBuffer : m_threads) {
+        const ThreadBuffer& buffer = *pBuffer;
+        if (!buffer.name.empty()) {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                         bFirst ? "" : ",\n", buffer.threadId);
+            WriteJsonString(file, buffer.name.c_str());
+            std::fprintf(file, "}}");
+            bFirst = false;
+        }
+
+        std::uint64_t end = buffer.writeIndex.load(std::memory_order_acquire);
+        std::uint64_t begin = end > g_iRingCapacity ? end - g_iRingCapacity : 0;
+        for (std::uint64_t index = begin; index < end; index++) {
+            const Event& event = buffer.events[index & (g_iRingCapacity - 1)];
+            double fStartUs = buffer.bNanoseconds ? static_cast<double>(event.startTicks) / 1000.0
+                                                  : static_cast<double>(event.startTicks - g_epochTicks) * fUsPerTick;
+            double fDurationUs = static_cast<double>(event.endTicks - event.startTicks) *
+                                 (buffer.bNanoseconds ? 0.001 : fUsPerTick);
+            std::fprintf(file, "%s{\"name\":", bFirst ? "" : ",\n");
+            WriteJsonString(file, event.name);
+            std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer.threadId,
+                         fStartUs, fDurationUs);
+            bFirst = false;
+        }
+        eventCount += end - begin;
+    }
+    std::fprintf(file, "\n]}\n");
+
+    if (std::fclose(file) != 0) {
+        LOG_ERROR("Failed to write trace: {}", path);
+        return false;
+    }
+    LOG_INFO("Wrote {} profiler events to {}", eventCount, path);
+    return true;
+}
@@ -0,0 +1,101 @@
+// --- Declares the scoped CPU profiler --- \\
+
+#ifndef CLIONPROJECTS_PROFILER_H
+#define CLIONPROJECTS_PROFILER_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Records timed scopes into a ring buffer per thread and writes them out as Chrome trace-event
+// JSON (open in chrome://tracing or ui.perfetto.dev). Recording a scope takes two timestamp reads
+// and an uncontended store into the calling thread's buffer; only a thread's first event takes a
+// lock. On x86 the timestamps are raw TSC ticks, converted to time against steady_clock when the
+// trace is written, since a steady_clock read costs several times as much.
+// Each buffer keeps the most recent g_iRingCapacity scopes, older ones are overwritten.
+//
+// Mark scopes with PROFILE_SCOPE("name") or PROFILE_FUNCTION(). Names must outlive the profiler,
+// so use string literals. Defining PROFILER_DISABLED compiles the markers out completely.
+class Profiler {
+public:
+    struct Event {
+        const char* name;
+        // Ticks, or NowNs() nanoseconds on the GPU track
+        std::int64_t startTicks;
+        std::int64_t endTicks;
+    };
+
+    static constexpr std::uint64_t g_iRingCapacity = 1 << 16;
+
+    static Profiler& Get();
+
+    // Timestamp in profiler ticks; only differences and WriteChromeTrace give them meaning.
+    [[nodiscard]] static std::int64_t Now();
+
+    void Record(const char* name, std::int64_t startTicks, std::int64_t endTicks);
+
+    // Nanoseconds since the profiler started, for sources with clocks of their own (GpuTimer).
+    [[nodiscard]] static std::int64_t NowNs();
+    // Adds an event measured on another clock to the GPU track, in NowNs() time. Call it from one
+    // thread only.
+    void RecordGpu(const char* name, std::int64_t startNs, std::int64_t endNs);
+    // Labels the calling thread in the trace.
+    void SetThreadName(const char* name);
+
+    void SetTracePath(std::string path) {m_tracePath = std::move(path);}
+    [[nodiscard]] const std::string& GetTracePath() const {return m_tracePath;}
+
+    // Writes every thread's buffered events. Threads still recording may overwrite their
+    // oldest events while this runs, so dump from a quiet point such as a key press or exit.
+    bool WriteChromeTrace(const std::string& path) const;
+    bool WriteChromeTrace() const {return WriteChromeTrace(m_tracePath);}
+
+private:
+    struct ThreadBuffer {
+        std::vector<Event> events = std::vector<Event>(g_iRingCapacity);
+        std::atomic<std::uint64_t> writeIndex{0};
+        int threadId = 0;
+        std::string name;
+        // Events in nanoseconds rather than ticks
+        bool bNanoseconds = false;
+    };
+
+    Profiler() = default;
+    ThreadBuffer& RegisterThread();
+
+    // Set on a thread's first event so later events skip the registry lock.
+    static thread_local ThreadBuffer* t_pThreadBuffer;
+
+    mutable std::mutex m_threadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+    ThreadBuffer* m_pGpuBuffer = nullptr;
+    std::string m_tracePath = "trace.json";
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : m_name(name), m_startTicks(Profiler::Now()) {}
+    ~ProfileScope() {Profiler::Get().Record(m_name, m_startTicks, Profiler::Now());}
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    std::int64_t m_startTicks;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifndef PROFILER_DISABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // CLIONPROJECTS_PROFILER_H
@@ -0,0 +1,305 @@
+// --- Batched quaternion interpolation kernels --- \\
+
+#include "quat_batch.h"
+#include "simd_lanes.h"
+#include <algorithm>
+#include <cmath>
+
+void QuatArray::Resize(size_t count) {
+    w.resize(count);
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+}
+
+void QuatArray::Set(size_t ix, const glm::fquat& quat) {
+    w[ix] = quat.w;
+    x[ix] = quat.x;
+    y[ix] = quat.y;
+    z[ix] = quat.z;
+}
+
+glm::fquat QuatArray::Get(size_t ix) const {
+    return {w[ix], x[ix], y[ix], z[ix]};
+}
+
+namespace {
+    enum class Interpolation {
+        LERP,
+        NLERP,
+        SLERP,
+        FAST_SLERP
+    };
+
+    // acos(x) for x in [0, 1], from Abramowitz and Stegun 4.4.46 (error below 2e-8).
+    template <typename V>
+    typename V::Type Acos(typename V::Type x) {
+        typename V::Type poly = V::Set(-0.0012624911f);
+        poly = V::MulAdd(poly, x, V::Set(0.0066700901f));
+        poly = V::MulAdd(poly, x, V::Set(-0.0170881256f));
+        poly = V::MulAdd(poly, x, V::Set(0.0308918810f));
+        poly = V::MulAdd(poly, x, V::Set(-0.0501743046f));
+        poly = V::MulAdd(poly, x, V::Set(0.0889789874f));
+        poly = V::MulAdd(poly, x, V::Set(-0.2145988016f));
+        poly = V::MulAdd(poly, x, V::Set(1.5707963050f));
+        return V::Mul(poly, V::Sqrt(V::Sub(V::Set(1.0f), x)));
+    }
+
+    // sin(x) for x in [0, pi/2], Taylor series to x^11 (error below 6e-8 at pi/2).
+    template <typename V>
+    typename V::Type Sin(typename V::Type x) {
+        const typename V::Type x2 = V::Mul(x, x);
+        typename V::Type poly = V::Set(-1.0f / 39916800.0f);
+        poly = V::MulAdd(poly, x2, V::Set(1.0f / 362880.0f));
+        poly = V::MulAdd(poly, x2, V::Set(-1.0f / 5040.0f));
+        poly = V::MulAdd(poly, x2, V::Set(1.0f / 120.0f));
+        poly = V::MulAdd(poly, x2, V::Set(-1.0f / 6.0f));
+        poly = V::MulAdd(poly, x2, V::Set(1.0f));
+        return V::Mul(poly, x);
+    }
+
+    // Eberly's polynomial for the slerp weights sin((1 - t) theta) / sin(theta) and
+    // sin(t theta) / sin(theta), in t and cosThetaMinusOne = cos(theta) - 1 ("A Fast and Accurate
+    // Algorithm for Computing SLERP", 2011). Eight terms of the series, with the last one scaled
+    // by mu to spread its truncation error. Both weights are evaluated together, as in the paper's
+    // SIMD form: each term u[i] t^2 x - v[i] x is one MulAdd on t^2 x, with -v[i] x shared.
+    template <typename V>
+    SIMD_INLINE void FastSlerpWeights(typename V::Type& s0, typename V::Type& s1, typename V::Type cosThetaMinusOne) {
+        constexpr float fMu = 1.85298109240830f;
+        constexpr float u[8] = {1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11),
+                                1.0f / (6 * 13), 1.0f / (7 * 15), fMu / (8 * 17)};
+        constexpr float v[8] = {1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15,
+                                fMu * 8 / 17};
+
+        const typename V::Type one = V::Set(1.0f);
+        const typename V::Type negX = V::Sub(V::Set(0.0f), cosThetaMinusOne);
+        const typename V::Type t2x0 = V::Mul(V::Mul(s0, s0), cosThetaMinusOne);
+        const typename V::Type t2x1 = V::Mul(V::Mul(s1, s1), cosThetaMinusOne);
+        typename V::Type weight0 = one, weight1 = one;
+        for (int i = 7; i >= 0; i--) {
+            const typename V::Type negVX = V::Mul(V::Set(v[i]), negX);
+            weight0 = V::MulAdd(V::MulAdd(V::Set(u[i]), t2x0, negVX), weight0, one);
+            weight1 = V::MulAdd(V::MulAdd(V::Set(u[i]), t2x1, negVX), weight1, one);
+        }
+        s0 = V::Mul(s0, weight0);
+        s1 = V::Mul(s1, weight1);
+    }
+
+    // One quaternion per lane
+    template <typename V>
+    struct QuatLanes {
+        typename V::Type w, x, y, z;
+    };
+
+    template <typename V>
+    SIMD_INLINE QuatLanes<V> LoadQuats(const QuatArray& quats, size_t ix) {
+        return {V::Load(&quats.w[ix]), V::Load(&quats.x[ix]), V::Load(&quats.y[ix]), V::Load(&quats.z[ix])};
+    }
+
+    template <typename V>
+    SIMD_INLINE void StoreQuats(QuatArray& quats, size_t ix, const QuatLanes<V>& quat) {
+        V::Store(&quats.w[ix], quat.w);
+        V::Store(&quats.x[ix], quat.x);
+        V::Store(&quats.y[ix], quat.y);
+        V::Store(&quats.z[ix], quat.z);
+    }
+
+    // Interpolates from q0 towards q1 by t in every lane.
+    template <typename V, Interpolation MODE>
+    SIMD_INLINE QuatLanes<V> InterpolateLanes(const QuatLanes<V>& q0, QuatLanes<V> q1, typename V::Type t) {
+        const typename V::Type one = V::Set(1.0f);
+        typename V::Type dot = V::Mul(q0.w, q1.w);
+        dot = V::MulAdd(q0.x, q1.x, dot);
+        dot = V::MulAdd(q0.y, q1.y, dot);
+        dot = V::MulAdd(q0.z, q1.z, dot);
+
+        // q and -q are the same rotation; negate the destination wherever the dot product is
+        // negative, which also makes the dot product positive.
+        const typename V::Type sign = V::SignBit(dot);
+        q1.w = V::Xor(q1.w, sign);
+        q1.x = V::Xor(q1.x, sign);
+        q1.y = V::Xor(q1.y, sign);
+        q1.z = V::Xor(q1.z, sign);
+        dot = V::Xor(dot, sign);
+
+        typename V::Type s0 = V::Sub(one, t);
+        typename V::Type s1 = t;
+        if constexpr (MODE == Interpolation::SLERP) {
+            // sin((1 - t) theta) / sin(theta) and sin(t theta) / sin(theta); the clamps keep
+            // the lanes that will take the nlerp weights free of NaNs.
+            const typename V::Type cosTheta = V::Min(dot, one);
+            const typename V::Type theta = Acos<V>(cosTheta);
+            const typename V::Type sinTheta = V::Sqrt(V::Max(V::Sub(one, V::Mul(cosTheta, cosTheta)), V::Set(1e-12f)));
+            const typename V::Type slerp0 = V::Div(Sin<V>(V::Mul(s0, theta)), sinTheta);
+            const typename V::Type slerp1 = V::Div(Sin<V>(V::Mul(s1, theta)), sinTheta);
+            const typename V::Mask bNearlyParallel = V::Greater(dot, V::Set(g_fSlerpThreshold));
+            s0 = V::Select(bNearlyParallel, s0, slerp0);
+            s1 = V::Select(bNearlyParallel, s1, slerp1);
+        }
+        else if constexpr (MODE == Interpolation::FAST_SLERP) {
+            const typename V::Type cosThetaMinusOne = V::Sub(V::Min(dot, one), one);
+            FastSlerpWeights<V>(s0, s1, cosThetaMinusOne);
+        }
+
+        QuatLanes<V> quat{V::MulAdd(s0, q0.w, V::Mul(s1, q1.w)), V::MulAdd(s0, q0.x, V::Mul(s1, q1.x)),
+                          V::MulAdd(s0, q0.y, V::Mul(s1, q1.y)), V::MulAdd(s0, q0.z, V::Mul(s1, q1.z))};
+
+        // Slerp's result is already unit length up to the polynomial error, but its nlerp
+        // lanes are not, and normalising every lane costs less than telling them apart.
+        if constexpr (MODE == Interpolation::NLERP || MODE == Interpolation::SLERP) {
+            typename V::Type lengthSquared = V::Mul(quat.w, quat.w);
+            lengthSquared = V::MulAdd(quat.x, quat.x, lengthSquared);
+            lengthSquared = V::MulAdd(quat.y, quat.y, lengthSquared);
+            lengthSquared = V::MulAdd(quat.z, quat.z, lengthSquared);
+            const typename V::Type invLength = V::Div(one, V::Sqrt(lengthSquared));
+            quat.w = V::Mul(quat.w, invLength);
+            quat.x = V::Mul(quat.x, invLength);
+            quat.y = V::Mul(quat.y, invLength);
+            quat.z = V::Mul(quat.z, invLength);
+        }
+        return quat;
+    }
+
+    // Interpolates elements [ix, ixEnd) in steps of V::g_iWidth; returns where it stopped.
+    template <typename V, Interpolation MODE>
+    size_t Interpolate(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                       size_t ix, size_t ixEnd) {
+        for (; ix + V::g_iWidth <= ixEnd; ix += V::g_iWidth) {
+            StoreQuats<V>(out, ix, InterpolateLanes<V, MODE>(LoadQuats<V>(from, ix), LoadQuats<V>(to, ix),
+                                                             V::Load(&alpha[ix])));
+        }
+        return ix;
+    }
+
+    // Squad through the segment in every lane: three fast slerps, the keys' and the control
+    // points' by t and then between the two by 2t(1 - t).
+    template <typename V>
+    SIMD_INLINE QuatLanes<V> SquadLanes(const QuatLanes<V>& q0, const QuatLanes<V>& q1, const QuatLanes<V>& c0,
+                            const QuatLanes<V>& c1, typename V::Type t) {
+        const QuatLanes<V> keys = InterpolateLanes<V, Interpolation::FAST_SLERP>(q0, q1, t);
+        const QuatLanes<V> controls = InterpolateLanes<V, Interpolation::FAST_SLERP>(c0, c1, t);
+        const typename V::Type blend = V::Mul(V::Add(t, t), V::Sub(V::Set(1.0f), t));
+        return InterpolateLanes<V, Interpolation::FAST_SLERP>(keys, controls, blend);
+    }
+
+    template <typename V>
+    size_t Squad(const QuatArray& from, const QuatArray& to, const QuatArray& fromControl,
+                 const QuatArray& toControl, const float* alpha, QuatArray& out, size_t ix, size_t ixEnd) {
+        for (; ix + V::g_iWidth <= ixEnd; ix += V::g_iWidth) {
+            StoreQuats<V>(out, ix, SquadLanes<V>(LoadQuats<V>(from, ix), LoadQuats<V>(to, ix),
+                                                 LoadQuats<V>(fromControl, ix), LoadQuats<V>(toControl, ix),
+                                                 V::Load(&alpha[ix])));
+        }
+        return ix;
+    }
+
+    // Logarithm of a unit quaternion: (0, axis * half angle)
+    glm::fquat logUnit(const glm::fquat& quat) {
+        const float fSinLength = std::sqrt(quat.x * quat.x + quat.y * quat.y + quat.z * quat.z);
+        if (fSinLength < 1e-7f)
+            return {0.0f, 0.0f, 0.0f, 0.0f};
+        const float fScale = std::atan2(fSinLength, quat.w) / fSinLength;
+        return {0.0f, quat.x * fScale, quat.y * fScale, quat.z * fScale};
+    }
+
+    // Exponential of a pure quaternion, the inverse of logUnit
+    glm::fquat expPure(const glm::fquat& quat) {
+        const float fAngle = std::sqrt(quat.x * quat.x + quat.y * quat.y + quat.z * quat.z);
+        if (fAngle < 1e-7f)
+            return {1.0f, quat.x, quat.y, quat.z};
+        const float fScale = std::sin(fAngle) / fAngle;
+        return {std::cos(fAngle), quat.x * fScale, quat.y * fScale, quat.z * fScale};
+    }
+
+    template <Interpolation MODE>
+    void InterpolateRange(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                          size_t ixBegin, size_t ixEnd) {
+        size_t ix = Interpolate<SimdLanes, MODE>(from, to, alpha, out, ixBegin, ixEnd);
+        Interpolate<ScalarLanes, MODE>(from, to, alpha, out, ix, ixEnd);
+    }
+
+    template <Interpolation MODE>
+    void InterpolateAll(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out) {
+        const size_t count = std::min(from.Size(), to.Size());
+        out.Resize(count);
+        InterpolateRange<MODE>(from, to, alpha, out, 0, count);
+    }
+}
+
+void batchLerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out) {
+    InterpolateAll<Interpolation::LERP>(from, to, alpha, out);
+}
+
+void batchLerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+               size_t ixBegin, size_t ixEnd) {
+    InterpolateRange<Interpolation::LERP>(from, to, alpha, out, ixBegin, ixEnd);
+}
+
+void batchNlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out) {
+    InterpolateAll<Interpolation::NLERP>(from, to, alpha, out);
+}
+
+void batchNlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                size_t ixBegin, size_t ixEnd) {
+    InterpolateRange<Interpolation::NLERP>(from, to, alpha, out, ixBegin, ixEnd);
+}
+
+void batchSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out) {
+    InterpolateAll<Interpolation::SLERP>(from, to, alpha, out);
+}
+
+void batchSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                size_t ixBegin, size_t ixEnd) {
+    InterpolateRange<Interpolation::SLERP>(from, to, alpha, out, ixBegin, ixEnd);
+}
+
+void batchFastSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out) {
+    InterpolateAll<Interpolation::FAST_SLERP>(from, to, alpha, out);
+}
+
+void batchFastSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                    size_t ixBegin, size_t ixEnd) {
+    InterpolateRange<Interpolation::FAST_SLERP>(from, to, alpha, out, ixBegin, ixEnd);
+}
+
+glm::fquat fastSlerp(const glm::fquat& from, const glm::fquat& to, float alpha) {
+    float cosTheta = glm::dot(from, to);
+    const float fSign = cosTheta < 0.0f ? -1.0f : 1.0f;
+    cosTheta = std::min(cosTheta * fSign, 1.0f);
+    float fWeight0 = 1.0f - alpha, fWeight1 = alpha;
+    FastSlerpWeights<ScalarLanes>(fWeight0, fWeight1, cosTheta - 1.0f);
+    return from * fWeight0 + to * (fWeight1 * fSign);
+}
+
+void batchSquad(const QuatArray& from, const QuatArray& to, const QuatArray& fromControl,
+                const QuatArray& toControl, const float* alpha, QuatArray& out) {
+    const size_t count = std::min({from.Size(), to.Size(), fromControl.Size(), toControl.Size()});
+    out.Resize(count);
+    batchSquad(from, to, fromControl, toControl, alpha, out, 0, count);
+}
+
+void batchSquad(const QuatArray& from, const QuatArray& to, const QuatArray& fromControl,
+                const QuatArray& toControl, const float* alpha, QuatArray& out, size_t ixBegin, size_t ixEnd) {
+    size_t ix = Squad<SimdLanes>(from, to, fromControl, toControl, alpha, out, ixBegin, ixEnd);
+    Squad<ScalarLanes>(from, to, fromControl, toControl, alpha, out, ix, ixEnd);
+}
+
+glm::fquat squad(const glm::fquat& from, const glm::fquat& to, const glm::fquat& fromControl,
+                 const glm::fquat& toControl, float alpha) {
+    using Lanes = QuatLanes<ScalarLanes>;
+    const Lanes quat = SquadLanes<ScalarLanes>(Lanes{from.w, from.x, from.y, from.z}, Lanes{to.w, to.x, to.y, to.z},
+                                               Lanes{fromControl.w, fromControl.x, fromControl.y, fromControl.z},
+                                               Lanes{toControl.w, toControl.x, toControl.y, toControl.z}, alpha);
+    return {quat.w, quat.x, quat.y, quat.z};
+}
+
+glm::fquat squadControl(const glm::fquat& prev, const glm::fquat& key, const glm::fquat& next) {
+    const glm::fquat inverse = glm::conjugate(key);
+    const glm::fquat logNext = logUnit(inverse * (glm::dot(key, next) < 0.0f ? -next : next));
+    const glm::fquat logPrev = logUnit(inverse * (glm::dot(key, prev) < 0.0f ? -prev : prev));
+    return key * expPure((logNext + logPrev) * -0.25f);
+}
+
+const char* getQuatBatchInstructionSet() {
+    return g_simdInstructionSet;
+}
@@ -0,0 +1,99 @@
+// --- Declares the batched quaternion interpolation kernels --- \\
+
+#ifndef CLIONPROJECTS_QUAT_BATCH_H
+#define CLIONPROJECTS_QUAT_BATCH_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include <cstddef>
+#include <vector>
+
+// Quaternions stored structure-of-arrays: one array per component, so a SIMD register loads the
+// same component of several quaternions at once.
+struct QuatArray {
+    std::vector<float> w;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    QuatArray() = default;
+    explicit QuatArray(size_t count) {Resize(count);}
+
+    void Resize(size_t count);
+    [[nodiscard]] size_t Size() const {return w.size();}
+
+    void Set(size_t ix, const glm::fquat& quat);
+    [[nodiscard]] glm::fquat Get(size_t ix) const;
+};
+
+// Interpolate from[i] towards to[i] by alpha[i] (in [0, 1]) for every i, writing out[i] (out is
+// resized to match, and may be from or to). All three take the shorter arc, flipping to[i] when
+// the pair is more than 180 degrees of rotation apart.
+//
+// The kernels process 8 quaternions per step with AVX2 (4 with SSE) and have no branches: the
+// sign flip is a sign-bit XOR, and slerp computes both its own weights and the nlerp fallback for
+// nearly parallel pairs, selecting per lane with a mask. Slerp evaluates acos and sin with
+// polynomials (about 1e-7 absolute error over the range used) instead of libm calls. Whatever is
+// left over after the last full register goes through the same code one lane wide.
+//
+// The instruction set is chosen at compile time: AVX2 when built with -mavx2 (and FMA with -mfma),
+// otherwise SSE on x86, otherwise plain scalar code.
+
+// Componentwise lerp, not renormalised
+void batchLerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out);
+// Lerp then normalise: cheap, but speeds up through the middle of the arc
+void batchNlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out);
+// Constant angular velocity; falls back to nlerp where the pair is within g_fSlerpThreshold
+void batchSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out);
+// Slerp from Eberly's polynomial: no acos, sin, division or square root, and about 1.1 (SSE) to
+// 1.25 (AVX2) times batchSlerp's throughput
+void batchFastSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out);
+
+// The same over elements [ixBegin, ixEnd) only, so a batch can be split between threads. out is
+// not resized and must already hold ixEnd quaternions; splitting at multiples of 16 keeps every
+// range on whole SIMD registers and the threads off each other's cache lines.
+void batchLerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+               size_t ixBegin, size_t ixEnd);
+void batchNlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                size_t ixBegin, size_t ixEnd);
+void batchSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                size_t ixBegin, size_t ixEnd);
+void batchFastSlerp(const QuatArray& from, const QuatArray& to, const float* alpha, QuatArray& out,
+                    size_t ixBegin, size_t ixEnd);
+
+// The same fast slerp for a single pair, at under half the cost of acos and sin. The weights are a
+// polynomial in alpha and cos(theta) that tracks sin(alpha theta) / sin(theta) to about 2e-5, worst
+// where the pair is 90 degrees of quaternion arc apart. The rotation it gives is then within
+// g_fFastSlerpMaxAngularError radians (0.001 degrees) of an exact slerp's, and as it is not
+// renormalised its length is within g_fFastSlerpMaxLengthError of 1; quat_benchmark --check
+// verifies both over a dense sweep of angles and alphas.
+glm::fquat fastSlerp(const glm::fquat& from, const glm::fquat& to, float alpha);
+constexpr float g_fFastSlerpMaxAngularError = 2.0e-5f;
+constexpr float g_fFastSlerpMaxLengthError = 3.0e-5f;
+
+// Squad, the spherical cubic, from from[i] to to[i] by alpha[i] for every i: a curve through the
+// keys whose angular velocity is continuous from one segment to the next, given the control points
+// squadControl() works out at each key. With those precomputed once per path a step costs three
+// fast slerps and no logarithms or exponentials. Every slerp takes the shorter arc, which is the
+// curve squad means wherever neighbouring keys are under 90 degrees of rotation apart. Each slerp
+// adding its own error, a result is within three times the fast slerp's bounds of an exact squad
+// through the same control points, in angle and in length; quat_benchmark --check verifies both.
+void batchSquad(const QuatArray& from, const QuatArray& to, const QuatArray& fromControl,
+                const QuatArray& toControl, const float* alpha, QuatArray& out);
+void batchSquad(const QuatArray& from, const QuatArray& to, const QuatArray& fromControl,
+                const QuatArray& toControl, const float* alpha, QuatArray& out, size_t ixBegin, size_t ixEnd);
+// The same for a single segment, bit for bit
+glm::fquat squad(const glm::fquat& from, const glm::fquat& to, const glm::fquat& fromControl,
+                 const glm::fquat& toControl, float alpha);
+// Squad's inner control point at key, between its neighbours on the path (the key itself standing
+// in for a missing one): key exp(-(log(key^-1 next) + log(key^-1 prev)) / 4)
+glm::fquat squadControl(const glm::fquat& prev, const glm::fquat& key, const glm::fquat& next);
+constexpr float g_fSquadMaxAngularError = 3.0f * g_fFastSlerpMaxAngularError;
+constexpr float g_fSquadMaxLengthError = 3.0f * g_fFastSlerpMaxLengthError;
+
+// Cosine of the angle between two quaternions above which slerp uses nlerp instead
+constexpr float g_fSlerpThreshold = 0.9995f;
+
+// "AVX2", "SSE" or "scalar"
+const char* getQuatBatchInstructionSet();
+
+#endif // CLIONPROJECTS_QUAT_BATCH_H
@@ -0,0 +1,491 @@
+// --- Quaternion interpolation benchmark: scalar glm against the batched kernels --- \\
+
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "quat_batch.cpp"
+#include "quat_codec.cpp"
+#include "orientation_path.cpp"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    // Random unit quaternions, with every eighth destination nudged off its source so that the
+    // nearly parallel fallback gets exercised too.
+    void makeQuats(size_t count, std::vector<glm::fquat>& from, std::vector<glm::fquat>& to, std::vector<float>& alpha) {
+        std::mt19937 rng(1);
+        std::normal_distribution<float> normal;
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        auto randomQuat = [&]() {
+            return glm::normalize(glm::fquat(normal(rng), normal(rng), normal(rng), normal(rng)));
+        };
+
+        from.resize(count);
+        to.resize(count);
+        alpha.resize(count);
+        for (size_t ix = 0; ix < count; ix++) {
+            from[ix] = randomQuat();
+            to[ix] = ix % 8 == 0 ? glm::normalize(from[ix] + randomQuat() * 0.01f) : randomQuat();
+            alpha[ix] = uniform(rng);
+        }
+    }
+
+    // The scalar path: one glm::fquat at a time, as the lesson programs interpolate.
+    glm::fquat scalarNlerp(const glm::fquat& from, const glm::fquat& to, float alpha) {
+        glm::fquat end = glm::dot(from, to) < 0.0f ? -to : to;
+        return glm::normalize(from * (1.0f - alpha) + end * alpha);
+    }
+
+    glm::fquat scalarSlerp(const glm::fquat& from, const glm::fquat& to, float alpha) {
+        return glm::normalize(glm::slerp(from, to, alpha));
+    }
+
+    // Best time of several repeats, in nanoseconds per quaternion.
+    template <typename Function>
+    double timePerQuat(size_t count, int iRepeats, Function function) {
+        double fBestNs = 1e30;
+        for (int iRepeat = 0; iRepeat < iRepeats; iRepeat++) {
+            auto startTime = std::chrono::steady_clock::now();
+            function();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - startTime;
+            fBestNs = std::min(fBestNs, elapsed.count());
+        }
+        return fBestNs / static_cast<double>(count);
+    }
+
+    // w, x, y, z in double precision, for the --check reference
+    using ExactQuat = std::array<double, 4>;
+
+    ExactQuat toExact(const glm::fquat& quat) {
+        return {quat.w, quat.x, quat.y, quat.z};
+    }
+
+    ExactQuat exactSlerp(ExactQuat start, ExactQuat end, double alpha) {
+        double fStartLength = 0.0, fEndLength = 0.0, cosTheta = 0.0;
+        for (int iComponent = 0; iComponent < 4; iComponent++) {
+            fStartLength += start[iComponent] * start[iComponent];
+            fEndLength += end[iComponent] * end[iComponent];
+            cosTheta += start[iComponent] * end[iComponent];
+        }
+        const double fEndSign = cosTheta < 0.0 ? -1.0 : 1.0;
+        for (int iComponent = 0; iComponent < 4; iComponent++) {
+            start[iComponent] /= std::sqrt(fStartLength);
+            end[iComponent] *= fEndSign / std::sqrt(fEndLength);
+        }
+        // The angle from the chord between the pair and the chord to -end, which unlike acos stays
+        // accurate for nearly parallel pairs
+        double fChord = 0.0, fOppositeChord = 0.0;
+        for (int iComponent = 0; iComponent < 4; iComponent++) {
+            fChord += std::pow(end[iComponent] - start[iComponent], 2.0);
+            fOppositeChord += std::pow(end[iComponent] + start[iComponent], 2.0);
+        }
+        const double theta = 2.0 * std::atan2(std::sqrt(fChord), std::sqrt(fOppositeChord));
+        if (theta < 1e-12)
+            return start;
+
+        ExactQuat result;
+        for (int iComponent = 0; iComponent < 4; iComponent++)
+            result[iComponent] = (start[iComponent] * std::sin((1.0 - alpha) * theta) +
+                                  end[iComponent] * std::sin(alpha * theta)) / std::sin(theta);
+        return result;
+    }
+
+    ExactQuat exactSlerp(const glm::fquat& from, const glm::fquat& to, double alpha) {
+        return exactSlerp(toExact(from), toExact(to), alpha);
+    }
+
+    // Rotation angle, in radians, between a unit reference and a quaternion of any length
+    double angularError(const ExactQuat& expected, const glm::fquat& actual) {
+        const ExactQuat quat{actual.w, actual.x, actual.y, actual.z};
+        const double fLength = std::sqrt(quat[0] * quat[0] + quat[1] * quat[1] + quat[2] * quat[2] + quat[3] * quat[3]);
+        double fChord = 0.0, fChordFlipped = 0.0;
+        for (int iComponent = 0; iComponent < 4; iComponent++) {
+            fChord += std::pow(quat[iComponent] / fLength - expected[iComponent], 2.0);
+            fChordFlipped += std::pow(quat[iComponent] / fLength + expected[iComponent], 2.0);
+        }
+        // The chord between unit quaternions is 2 sin(angle / 4)
+        return 4.0 * std::asin(std::min(std::sqrt(std::min(fChord, fChordFlipped)) / 2.0, 1.0));
+    }
+
+    // Sweeps the angle between the pair over [0, 180] degrees of quaternion arc (so both sides of
+    // the shortest-path flip) and alpha over [0, 1], on random axes, and checks the fast slerp
+    // against its documented bounds. Returns whether they held.
+    bool checkFastSlerp() {
+        const int iAngleSteps = 2048;
+        const int iAlphaSteps = 512;
+        std::mt19937 rng(1);
+        std::normal_distribution<float> normal;
+        auto randomQuat = [&]() {
+            return glm::normalize(glm::fquat(normal(rng), normal(rng), normal(rng), normal(rng)));
+        };
+
+        double fMaxAngularError = 0.0, fMaxLengthError = 0.0, fMaxBatchError = 0.0, fMaxSlerpError = 0.0;
+        QuatArray from(iAlphaSteps + 1), to(iAlphaSteps + 1), fast(iAlphaSteps + 1), slerped(iAlphaSteps + 1);
+        std::vector<float> alpha(iAlphaSteps + 1);
+        for (int iAngle = 0; iAngle <= iAngleSteps; iAngle++) {
+            // to = from rotated about a random axis, theta of quaternion arc away
+            const float fTheta = glm::pi<float>() * static_cast<float>(iAngle) / static_cast<float>(iAngleSteps);
+            const glm::fquat start = randomQuat();
+            const glm::fquat axis = randomQuat();
+            const float fAxisLength = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+            const float fSin = std::sin(fTheta) / fAxisLength;
+            const glm::fquat end = start * glm::fquat(std::cos(fTheta), axis.x * fSin, axis.y * fSin, axis.z * fSin);
+
+            for (int iAlpha = 0; iAlpha <= iAlphaSteps; iAlpha++) {
+                alpha[iAlpha] = static_cast<float>(iAlpha) / static_cast<float>(iAlphaSteps);
+                from.Set(iAlpha, start);
+                to.Set(iAlpha, end);
+            }
+            batchFastSlerp(from, to, alpha.data(), fast);
+            batchSlerp(from, to, alpha.data(), slerped);
+
+            for (int iAlpha = 0; iAlpha <= iAlphaSteps; iAlpha++) {
+                const ExactQuat expected = exactSlerp(start, end, alpha[iAlpha]);
+                const glm::fquat quat = fastSlerp(start, end, alpha[iAlpha]);
+                fMaxAngularError = std::max(fMaxAngularError, angularError(expected, quat));
+                fMaxLengthError = std::max(fMaxLengthError, std::fabs(static_cast<double>(glm::length(quat)) - 1.0));
+                fMaxBatchError = std::max(fMaxBatchError, angularError(expected, fast.Get(iAlpha)));
+                fMaxSlerpError = std::max(fMaxSlerpError, angularError(expected, slerped.Get(iAlpha)));
+            }
+        }
+
+        const bool bPassed = fMaxAngularError <= g_fFastSlerpMaxAngularError &&
+                             fMaxBatchError <= g_fFastSlerpMaxAngularError &&
+                             fMaxLengthError <= g_fFastSlerpMaxLengthError;
+        std::cout << std::scientific << std::setprecision(2)
+                  << "Fast slerp over " << (iAngleSteps + 1) * (iAlphaSteps + 1) << " pairs: max angular error "
+                  << fMaxAngularError << " rad (batch " << fMaxBatchError << ", bound " << g_fFastSlerpMaxAngularError
+                  << "), max length error " << fMaxLengthError << " (bound " << g_fFastSlerpMaxLengthError << ")\n"
+                  << "Batch slerp max angular error " << fMaxSlerpError << " rad\n"
+                  << (bPassed ? "PASS" : "FAIL") << std::endl;
+        return bPassed;
+    }
+
+    // Encodes and decodes a million random quaternions and a set of awkward ones (identity, axis
+    // aligned, two or four components tied for largest, components at the edge of the stored
+    // range), singly and in batches, and checks the codec against its documented bounds. Returns
+    // whether they held.
+    bool checkQuatCodec() {
+        std::vector<glm::fquat> quats;
+        const float fHalfRoot2 = std::sqrt(0.5f);
+        for (float fSign : {1.0f, -1.0f}) {
+            for (int ixComponent = 0; ixComponent < 4; ixComponent++) {
+                glm::fquat axis(0.0f, 0.0f, 0.0f, 0.0f);
+                axis[ixComponent] = fSign;
+                quats.push_back(axis);
+                for (int ixOther = ixComponent + 1; ixOther < 4; ixOther++) {
+                    glm::fquat pair(0.0f, 0.0f, 0.0f, 0.0f);
+                    pair[ixComponent] = fHalfRoot2;
+                    pair[ixOther] = fSign * fHalfRoot2;
+                    quats.push_back(pair);
+                }
+            }
+            quats.emplace_back(0.5f * fSign, 0.5f, -0.5f, 0.5f * fSign);
+            quats.emplace_back(0.5f, 0.5f * fSign, 0.5f * fSign, -0.5f);
+        }
+        std::mt19937 rng(1);
+        std::normal_distribution<float> normal;
+        while (quats.size() < 1000000)
+            quats.push_back(glm::normalize(glm::fquat(normal(rng), normal(rng), normal(rng), normal(rng))));
+
+        std::vector<PackedQuat32> packed32(quats.size());
+        std::vector<PackedQuat48> packed48(quats.size());
+        for (size_t ix = 0; ix < quats.size(); ix++) {
+            packed32[ix] = encodeQuat32(quats[ix]);
+            packed48[ix] = encodeQuat48(quats[ix]);
+        }
+        QuatArray batch32, batch48;
+        batchDecodeQuat32(packed32.data(), packed32.size(), batch32);
+        batchDecodeQuat48(packed48.data(), packed48.size(), batch48);
+
+        double fMaxError32 = 0.0, fMaxError48 = 0.0, fMaxLengthError = 0.0;
+        size_t batchMismatches = 0;
+        for (size_t ix = 0; ix < quats.size(); ix++) {
+            const ExactQuat expected{quats[ix].w, quats[ix].x, quats[ix].y, quats[ix].z};
+            const glm::fquat decoded32 = decodeQuat32(packed32[ix]);
+            const glm::fquat decoded48 = decodeQuat48(packed48[ix]);
+            fMaxError32 = std::max(fMaxError32, angularError(expected, decoded32));
+            fMaxError48 = std::max(fMaxError48, angularError(expected, decoded48));
+            for (const glm::fquat& decoded : {decoded32, decoded48})
+                fMaxLengthError = std::max(fMaxLengthError, std::fabs(static_cast<double>(glm::length(decoded)) - 1.0));
+            const glm::fquat fromBatch32 = batch32.Get(ix), fromBatch48 = batch48.Get(ix);
+            if (std::memcmp(&fromBatch32, &decoded32, sizeof(glm::fquat)) != 0 ||
+                std::memcmp(&fromBatch48, &decoded48, sizeof(glm::fquat)) != 0)
+                batchMismatches++;
+        }
+
+        const bool bPassed = fMaxError32 <= g_fQuat32MaxAngularError && fMaxError48 <= g_fQuat48MaxAngularError &&
+                             fMaxLengthError <= g_fPackedQuatMaxLengthError && batchMismatches == 0;
+        std::cout << std::scientific << std::setprecision(2)
+                  << "Packed quaternions over " << quats.size() << " rotations: max angular error 32-bit "
+                  << fMaxError32 << " rad (bound " << g_fQuat32MaxAngularError << "), 48-bit " << fMaxError48
+                  << " rad (bound " << g_fQuat48MaxAngularError << "), max length error " << fMaxLengthError
+                  << " (bound " << g_fPackedQuatMaxLengthError << "), " << batchMismatches
+                  << " batch decodes differing from single ones\n"
+                  << (bPassed ? "PASS" : "FAIL") << std::endl;
+        return bPassed;
+    }
+
+    ExactQuat exactSquad(const glm::fquat& from, const glm::fquat& to, const glm::fquat& fromControl,
+                         const glm::fquat& toControl, double alpha) {
+        return exactSlerp(exactSlerp(from, to, alpha), exactSlerp(fromControl, toControl, alpha),
+                          2.0 * alpha * (1.0 - alpha));
+    }
+
+    // Angular velocity, in the body's frame, of a rotation going from before to after in time h
+    std::array<double, 3> angularVelocity(const ExactQuat& before, const ExactQuat& after, double h) {
+        // before^-1 after, on the shorter arc
+        const double w = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] + before[3] * after[3];
+        std::array<double, 3> axis{before[0] * after[1] - before[1] * after[0] - before[2] * after[3] + before[3] * after[2],
+                                   before[0] * after[2] + before[1] * after[3] - before[2] * after[0] - before[3] * after[1],
+                                   before[0] * after[3] - before[1] * after[2] + before[2] * after[1] - before[3] * after[0]};
+        const double fSign = w < 0.0 ? -1.0 : 1.0;
+        const double fSinHalfAngle = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        const double fScale = fSinHalfAngle > 0.0 ? 2.0 * std::atan2(fSinHalfAngle, w * fSign) / fSinHalfAngle * fSign / h : 0.0;
+        for (double& component : axis)
+            component *= fScale;
+        return axis;
+    }
+
+    // How much the angular velocity changes across a key, in radians per unit of parameter, between
+    // a curve arriving along left(alpha) and leaving along right(alpha)
+    template <typename Curve>
+    double velocityJump(Curve left, Curve right) {
+        const double h = 1e-5;
+        const std::array<double, 3> arriving = angularVelocity(left(1.0 - h), left(1.0), h);
+        const std::array<double, 3> leaving = angularVelocity(right(0.0), right(h), h);
+        double fJump = 0.0;
+        for (int iComponent = 0; iComponent < 3; iComponent++)
+            fJump += std::pow(leaving[iComponent] - arriving[iComponent], 2.0);
+        return std::sqrt(fJump);
+    }
+
+    // Runs random paths through squad, each key under 90 degrees of rotation from the one before
+    // and some of them negated, sweeping the parameter over every segment. Checks the kernel
+    // against an exact squad through the same control points and EvaluateAll() against
+    // Evaluate(), and measures how much the angular velocity jumps at the inner keys, for squad
+    // and for chained slerps. Returns whether the bounds held.
+    bool checkSquad() {
+        const int iPathCount = 2000;
+        const int iKeyCount = 6;
+        const int iAlphaSteps = 256;
+        std::mt19937 rng(1);
+        std::normal_distribution<float> normal;
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        auto randomQuat = [&]() {
+            return glm::normalize(glm::fquat(normal(rng), normal(rng), normal(rng), normal(rng)));
+        };
+
+        // Odd paths loop; only the others, which have no wrap-around segment, are checked for accuracy.
+        OrientationPaths paths;
+        std::vector<std::vector<glm::fquat>> pathKeys(iPathCount), pathControls(iPathCount);
+        for (int ixPath = 0; ixPath < iPathCount; ixPath++) {
+            std::vector<glm::fquat>& keys = pathKeys[ixPath];
+            keys.push_back(randomQuat());
+            while (keys.size() < iKeyCount) {
+                const glm::fquat axis = randomQuat();
+                const float fAxisLength = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+                const float fHalfAngle = 0.25f * glm::pi<float>() * uniform(rng);
+                const float fSin = std::sin(fHalfAngle) / fAxisLength;
+                const glm::fquat turn(std::cos(fHalfAngle), axis.x * fSin, axis.y * fSin, axis.z * fSin);
+                const glm::fquat key = glm::normalize(keys.back() * turn);
+                keys.push_back(uniform(rng) < 0.25f ? -key : key);
+            }
+            for (int ixKey = 0; ixKey < iKeyCount; ixKey++) {
+                pathControls[ixPath].push_back(squadControl(keys[std::max(ixKey - 1, 0)], keys[ixKey],
+                                                            keys[std::min(ixKey + 1, iKeyCount - 1)]));
+            }
+            paths.Add(keys, ixPath % 2 == 1);
+        }
+
+        double fMaxAngularError = 0.0, fMaxLengthError = 0.0;
+        size_t batchMismatches = 0;
+        std::vector<float> parameters(iPathCount);
+        QuatArray out;
+        for (int iStep = 0; iStep <= iKeyCount * iAlphaSteps; iStep++) {
+            const float fParameter = static_cast<float>(iStep) / static_cast<float>(iAlphaSteps);
+            std::fill(parameters.begin(), parameters.end(), fParameter);
+            paths.EvaluateAll(parameters.data(), out);
+            for (int ixPath = 0; ixPath < iPathCount; ixPath++) {
+                const glm::fquat single = paths.Evaluate(ixPath, fParameter);
+                const glm::fquat fromBatch = out.Get(ixPath);
+                if (std::memcmp(&single, &fromBatch, sizeof(glm::fquat)) != 0)
+                    batchMismatches++;
+                if (ixPath % 2 == 1 || fParameter > static_cast<float>(iKeyCount - 1))
+                    continue;
+
+                const int ixSegment = std::min(static_cast<int>(fParameter), iKeyCount - 2);
+                const std::vector<glm::fquat>& keys = pathKeys[ixPath];
+                const std::vector<glm::fquat>& controls = pathControls[ixPath];
+                const glm::fquat quat = squad(keys[ixSegment], keys[ixSegment + 1], controls[ixSegment],
+                                              controls[ixSegment + 1], fParameter - static_cast<float>(ixSegment));
+                const ExactQuat expected = exactSquad(keys[ixSegment], keys[ixSegment + 1], controls[ixSegment],
+                                                      controls[ixSegment + 1], fParameter - static_cast<float>(ixSegment));
+                fMaxAngularError = std::max({fMaxAngularError, angularError(expected, quat),
+                                             angularError(expected, fromBatch)});
+                fMaxLengthError = std::max(fMaxLengthError, std::fabs(static_cast<double>(glm::length(quat)) - 1.0));
+            }
+        }
+
+        double fMaxSquadJump = 0.0, fMaxSlerpJump = 0.0;
+        for (int ixPath = 0; ixPath < iPathCount; ixPath += 2) {
+            const std::vector<glm::fquat>& keys = pathKeys[ixPath];
+            const std::vector<glm::fquat>& controls = pathControls[ixPath];
+            for (int ixKey = 1; ixKey + 1 < iKeyCount; ixKey++) {
+                auto squadSegment = [&](int ixSegment) {
+                    return [&, ixSegment](double alpha) {
+                        return exactSquad(keys[ixSegment], keys[ixSegment + 1], controls[ixSegment],
+                                          controls[ixSegment + 1], alpha);
+                    };
+                };
+                auto slerpSegment = [&](int ixSegment) {
+                    return [&, ixSegment](double alpha) {return exactSlerp(keys[ixSegment], keys[ixSegment + 1], alpha);};
+                };
+                fMaxSquadJump = std::max(fMaxSquadJump, velocityJump(squadSegment(ixKey - 1), squadSegment(ixKey)));
+                fMaxSlerpJump = std::max(fMaxSlerpJump, velocityJump(slerpSegment(ixKey - 1), slerpSegment(ixKey)));
+            }
+        }
+
+        const bool bPassed = fMaxAngularError <= g_fSquadMaxAngularError &&
+                             fMaxLengthError <= g_fSquadMaxLengthError && fMaxSquadJump <= 1e-3 &&
+                             batchMismatches == 0;
+        std::cout << std::scientific << std::setprecision(2)
+                  << "Squad over " << iPathCount << " paths of " << iKeyCount << " keys: max angular error "
+                  << fMaxAngularError << " rad (bound " << g_fSquadMaxAngularError << "), max length error "
+                  << fMaxLengthError << " (bound " << g_fSquadMaxLengthError << "), " << batchMismatches << " batch evaluations differing from single ones\n"
+                  << "Largest angular velocity jump at a key: squad " << fMaxSquadJump
+                  << " rad per unit parameter (bound 1.00e-03), chained slerps " << fMaxSlerpJump << "\n"
+                  << (bPassed ? "PASS" : "FAIL") << std::endl;
+        return bPassed;
+    }
+
+    // Largest component difference, comparing q and -q as equal.
+    float maxError(const std::vector<glm::fquat>& expected, const QuatArray& actual) {
+        float fMaxError = 0.0f;
+        for (size_t ix = 0; ix < expected.size(); ix++) {
+            glm::fquat quat = actual.Get(ix);
+            if (glm::dot(quat, expected[ix]) < 0.0f)
+                quat = -quat;
+            for (int iComponent = 0; iComponent < 4; iComponent++)
+                fMaxError = std::max(fMaxError, std::fabs(quat[iComponent] - expected[ix][iComponent]));
+        }
+        return fMaxError;
+    }
+}
+
+// Usage: quat_benchmark [count] [repeats], or quat_benchmark --check to test the fast slerp's and
+// the packed quaternions' error bounds (exits non-zero if they do not hold)
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--check") == 0) {
+        const bool bFastSlerpPassed = checkFastSlerp();
+        const bool bCodecPassed = checkQuatCodec();
+        const bool bSquadPassed = checkSquad();
+        return bFastSlerpPassed && bCodecPassed && bSquadPassed ? 0 : 1;
+    }
+
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int iRepeats = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::vector<glm::fquat> fromQuats, toQuats;
+    std::vector<float> alpha;
+    makeQuats(count, fromQuats, toQuats, alpha);
+
+    QuatArray from(count), to(count), out(count);
+    for (size_t ix = 0; ix < count; ix++) {
+        from.Set(ix, fromQuats[ix]);
+        to.Set(ix, toQuats[ix]);
+    }
+
+    std::vector<glm::fquat> nlerpQuats(count), slerpQuats(count), fastSlerpQuats(count);
+    const double fScalarNlerpNs = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            nlerpQuats[ix] = scalarNlerp(fromQuats[ix], toQuats[ix], alpha[ix]);
+    });
+    const double fScalarSlerpNs = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            slerpQuats[ix] = scalarSlerp(fromQuats[ix], toQuats[ix], alpha[ix]);
+    });
+    const double fScalarFastSlerpNs = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            fastSlerpQuats[ix] = fastSlerp(fromQuats[ix], toQuats[ix], alpha[ix]);
+    });
+
+    const double fBatchLerpNs = timePerQuat(count, iRepeats, [&]() {batchLerp(from, to, alpha.data(), out);});
+    const double fBatchNlerpNs = timePerQuat(count, iRepeats, [&]() {batchNlerp(from, to, alpha.data(), out);});
+    const float fNlerpError = maxError(nlerpQuats, out);
+    const double fBatchSlerpNs = timePerQuat(count, iRepeats, [&]() {batchSlerp(from, to, alpha.data(), out);});
+    const float fSlerpError = maxError(slerpQuats, out);
+    const double fBatchFastSlerpNs = timePerQuat(count, iRepeats, [&]() {batchFastSlerp(from, to, alpha.data(), out);});
+
+    // Squad, with each pair's control points as if the pair were a path of its own
+    QuatArray fromControl(count), toControl(count);
+    for (size_t ix = 0; ix < count; ix++) {
+        fromControl.Set(ix, squadControl(fromQuats[ix], fromQuats[ix], toQuats[ix]));
+        toControl.Set(ix, squadControl(fromQuats[ix], toQuats[ix], toQuats[ix]));
+    }
+    const double fScalarSquadNs = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            out.Set(ix, squad(fromQuats[ix], toQuats[ix], fromControl.Get(ix), toControl.Get(ix), alpha[ix]));
+    });
+    const double fBatchSquadNs = timePerQuat(count, iRepeats, [&]() {
+        batchSquad(from, to, fromControl, toControl, alpha.data(), out);
+    });
+
+    // As many six-key paths, all evaluated in one call each frame; the parameters stay inside
+    // their segments, as they do between keys.
+    OrientationPaths paths;
+    for (size_t ix = 0; ix < count; ix++) {
+        paths.Add({fromQuats[ix], toQuats[ix], fromQuats[(ix + 1) % count], toQuats[(ix + 1) % count],
+                   fromQuats[(ix + 2) % count], toQuats[(ix + 2) % count]}, true);
+    }
+    std::vector<float> parameters(count);
+    for (size_t ix = 0; ix < count; ix++)
+        parameters[ix] = static_cast<float>(ix % 6) + alpha[ix];
+    const double fPathsNs = timePerQuat(count, iRepeats, [&]() {paths.EvaluateAll(parameters.data(), out);});
+
+    // Decoding packed quaternions, one at a time and in batches
+    std::vector<PackedQuat32> packed32(count);
+    std::vector<PackedQuat48> packed48(count);
+    for (size_t ix = 0; ix < count; ix++) {
+        packed32[ix] = encodeQuat32(fromQuats[ix]);
+        packed48[ix] = encodeQuat48(fromQuats[ix]);
+    }
+    const double fScalarDecode32Ns = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            out.Set(ix, decodeQuat32(packed32[ix]));
+    });
+    const double fScalarDecode48Ns = timePerQuat(count, iRepeats, [&]() {
+        for (size_t ix = 0; ix < count; ix++)
+            out.Set(ix, decodeQuat48(packed48[ix]));
+    });
+    const double fBatchDecode32Ns = timePerQuat(count, iRepeats, [&]() {batchDecodeQuat32(packed32.data(), count, out);});
+    const double fBatchDecode48Ns = timePerQuat(count, iRepeats, [&]() {batchDecodeQuat48(packed48.data(), count, out);});
+    auto throughput = [](double fNs) {return 1.0 / fNs;};
+
+    std::cout << count << " quaternions, best of " << iRepeats << " runs, batch kernels use "
+              << getQuatBatchInstructionSet() << "\n"
+              << std::fixed << std::setprecision(2)
+              << "  scalar nlerp " << fScalarNlerpNs << " ns  batch nlerp " << fBatchNlerpNs << " ns  ("
+              << fScalarNlerpNs / fBatchNlerpNs << "x)\n"
+              << "  scalar slerp " << fScalarSlerpNs << " ns  batch slerp " << fBatchSlerpNs << " ns  ("
+              << fScalarSlerpNs / fBatchSlerpNs << "x)\n"
+              << "  scalar fast slerp " << fScalarFastSlerpNs << " ns (" << fScalarSlerpNs / fScalarFastSlerpNs
+              << "x scalar slerp)  batch fast slerp " << fBatchFastSlerpNs << " ns (" << fBatchSlerpNs / fBatchFastSlerpNs
+              << "x batch slerp)\n"
+              << "  batch lerp   " << fBatchLerpNs << " ns\n"
+              << "  scalar squad " << fScalarSquadNs << " ns  batch squad " << fBatchSquadNs << " ns  ("
+              << fBatchSquadNs / fBatchSlerpNs << "x batch slerp), evaluating every path " << fPathsNs << " ns\n"
+              << "  decode 32-bit " << fScalarDecode32Ns << " ns  batch " << fBatchDecode32Ns << " ns  ("
+              << throughput(fBatchDecode32Ns) << " G quats/s, " << fScalarDecode32Ns / fBatchDecode32Ns << "x)\n"
+              << "  decode 48-bit " << fScalarDecode48Ns << " ns  batch " << fBatchDecode48Ns << " ns  ("
+              << throughput(fBatchDecode48Ns) << " G quats/s, " << fScalarDecode48Ns / fBatchDecode48Ns << "x)\n"
+              << std::scientific << std::setprecision(1)
+              << "  max error against scalar: nlerp " << fNlerpError << ", slerp " << fSlerpError << "\n";
+    return 0;
+}
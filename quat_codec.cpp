@@ -0,0 +1,168 @@
+// --- Packed quaternion codec --- \\
+
+#include "quat_codec.h"
+#include "simd_lanes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Range of the three stored components
+    constexpr float g_fComponentLimit = 0.70710678f;
+
+    // Quantisation to and from BITS-bit unsigned integers over [-g_fComponentLimit, g_fComponentLimit]
+    template <int BITS>
+    struct Quantiser {
+        static constexpr std::uint32_t g_iMax = (1u << BITS) - 1;
+        static constexpr float g_fStep = 2.0f * g_fComponentLimit / static_cast<float>(g_iMax);
+
+        static std::uint32_t Quantise(float component) {
+            const float fLevel = (component + g_fComponentLimit) / g_fStep;
+            return static_cast<std::uint32_t>(std::clamp(fLevel + 0.5f, 0.0f, static_cast<float>(g_iMax)));
+        }
+    };
+
+    // Which component to drop, and the other three in w, x, y, z order, signed so that the dropped
+    // one is positive.
+    int smallestThree(const glm::fquat& quat, float (&stored)[3]) {
+        const glm::fquat unit = glm::normalize(quat);
+        const float components[4] = {unit.w, unit.x, unit.y, unit.z};
+        int ixLargest = 0;
+        for (int ixComponent = 1; ixComponent < 4; ixComponent++) {
+            if (std::fabs(components[ixComponent]) > std::fabs(components[ixLargest]))
+                ixLargest = ixComponent;
+        }
+        const float fSign = components[ixLargest] < 0.0f ? -1.0f : 1.0f;
+        for (int ixComponent = 0, ixStored = 0; ixComponent < 4; ixComponent++) {
+            if (ixComponent != ixLargest)
+                stored[ixStored++] = components[ixComponent] * fSign;
+        }
+        return ixLargest;
+    }
+
+    // Rebuilds w, x, y, z from the dropped component's index and the three quantised ones.
+    template <typename V, int BITS>
+    void Unpack(typename V::Int index, typename V::Int a, typename V::Int b, typename V::Int c,
+                typename V::Type& w, typename V::Type& x, typename V::Type& y, typename V::Type& z) {
+        const typename V::Type step = V::Set(Quantiser<BITS>::g_fStep);
+        const typename V::Type offset = V::Set(-g_fComponentLimit);
+        const typename V::Type fa = V::MulAdd(V::ToFloat(a), step, offset);
+        const typename V::Type fb = V::MulAdd(V::ToFloat(b), step, offset);
+        const typename V::Type fc = V::MulAdd(V::ToFloat(c), step, offset);
+
+        typename V::Type sumSquares = V::Mul(fa, fa);
+        sumSquares = V::MulAdd(fb, fb, sumSquares);
+        sumSquares = V::MulAdd(fc, fc, sumSquares);
+        const typename V::Type dropped = V::Sqrt(V::Max(V::Sub(V::Set(1.0f), sumSquares), V::Set(0.0f)));
+
+        // The dropped component goes at its index and the stored ones fill the others in order.
+        const typename V::Mask bDropped0 = V::Equal(index, 0);
+        const typename V::Mask bDropped1 = V::Equal(index, 1);
+        const typename V::Mask bDropped2 = V::Equal(index, 2);
+        const typename V::Mask bDropped3 = V::Equal(index, 3);
+        w = V::Select(bDropped0, dropped, fa);
+        x = V::Select(bDropped0, fa, V::Select(bDropped1, dropped, fb));
+        y = V::Select(bDropped2, dropped, V::Select(bDropped3, fc, fb));
+        z = V::Select(bDropped3, dropped, fc);
+    }
+
+    struct Quat32Format {
+        using Packed = PackedQuat32;
+        static constexpr int g_iBits = 10;
+
+        template <typename V>
+        static void Load(const Packed* packed, typename V::Int& index, typename V::Int& a, typename V::Int& b,
+                         typename V::Int& c) {
+            const typename V::Int bits = V::LoadInt(packed);
+            index = V::template ShiftRight<30>(bits);
+            a = V::And(V::template ShiftRight<20>(bits), 0x3FF);
+            b = V::And(V::template ShiftRight<10>(bits), 0x3FF);
+            c = V::And(bits, 0x3FF);
+        }
+    };
+
+    struct Quat48Format {
+        using Packed = PackedQuat48;
+        static constexpr int g_iBits = 15;
+
+        // Two overlapping 32-bit loads per quaternion, words 0 and 1 then words 1 and 2, which
+        // stay inside its 6 bytes; little-endian, as every target of these programs is.
+        template <typename V>
+        static void Load(const Packed* packed, typename V::Int& index, typename V::Int& a, typename V::Int& b,
+                         typename V::Int& c) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(packed);
+            const typename V::Int low = V::GatherInt(bytes, sizeof(Packed));
+            const typename V::Int high = V::GatherInt(bytes + 2, sizeof(Packed));
+            index = V::Or(V::And(V::template ShiftRight<15>(low), 1), V::And(V::template ShiftRight<30>(low), 2));
+            a = V::And(low, 0x7FFF);
+            b = V::And(V::template ShiftRight<16>(low), 0x7FFF);
+            c = V::And(V::template ShiftRight<16>(high), 0x7FFF);
+        }
+    };
+
+    // Decodes elements [ix, ixEnd) in steps of V::g_iWidth; returns where it stopped.
+    template <typename V, typename Format>
+    size_t Decode(const typename Format::Packed* packed, QuatArray& out, size_t ix, size_t ixEnd) {
+        for (; ix + V::g_iWidth <= ixEnd; ix += V::g_iWidth) {
+            typename V::Int index, a, b, c;
+            Format::template Load<V>(packed + ix, index, a, b, c);
+            typename V::Type w, x, y, z;
+            Unpack<V, Format::g_iBits>(index, a, b, c, w, x, y, z);
+            V::Store(&out.w[ix], w);
+            V::Store(&out.x[ix], x);
+            V::Store(&out.y[ix], y);
+            V::Store(&out.z[ix], z);
+        }
+        return ix;
+    }
+
+    template <typename Format>
+    void DecodeAll(const typename Format::Packed* packed, size_t count, QuatArray& out) {
+        out.Resize(count);
+        size_t ix = Decode<SimdLanes, Format>(packed, out, 0, count);
+        Decode<ScalarLanes, Format>(packed, out, ix, count);
+    }
+
+    template <typename Format>
+    glm::fquat DecodeOne(const typename Format::Packed& packed) {
+        ScalarLanes::Int index, a, b, c;
+        Format::template Load<ScalarLanes>(&packed, index, a, b, c);
+        float w, x, y, z;
+        Unpack<ScalarLanes, Format::g_iBits>(index, a, b, c, w, x, y, z);
+        return {w, x, y, z};
+    }
+}
+
+PackedQuat32 encodeQuat32(const glm::fquat& quat) {
+    using Quantiser10 = Quantiser<10>;
+    float stored[3];
+    const int ixDropped = smallestThree(quat, stored);
+    return static_cast<std::uint32_t>(ixDropped) << 30 | Quantiser10::Quantise(stored[0]) << 20 |
+           Quantiser10::Quantise(stored[1]) << 10 | Quantiser10::Quantise(stored[2]);
+}
+
+glm::fquat decodeQuat32(PackedQuat32 packed) {
+    return DecodeOne<Quat32Format>(packed);
+}
+
+PackedQuat48 encodeQuat48(const glm::fquat& quat) {
+    using Quantiser15 = Quantiser<15>;
+    float stored[3];
+    const auto ixDropped = static_cast<std::uint32_t>(smallestThree(quat, stored));
+    PackedQuat48 packed{};
+    packed.words[0] = static_cast<std::uint16_t>(Quantiser15::Quantise(stored[0]) | (ixDropped & 1) << 15);
+    packed.words[1] = static_cast<std::uint16_t>(Quantiser15::Quantise(stored[1]) | (ixDropped >> 1) << 15);
+    packed.words[2] = static_cast<std::uint16_t>(Quantiser15::Quantise(stored[2]));
+    return packed;
+}
+
+glm::fquat decodeQuat48(const PackedQuat48& packed) {
+    return DecodeOne<Quat48Format>(packed);
+}
+
+void batchDecodeQuat32(const PackedQuat32* packed, size_t count, QuatArray& out) {
+    DecodeAll<Quat32Format>(packed, count, out);
+}
+
+void batchDecodeQuat48(const PackedQuat48* packed, size_t count, QuatArray& out) {
+    DecodeAll<Quat48Format>(packed, count, out);
+}
@@ -0,0 +1,48 @@
+// --- Declares the packed quaternion codec --- \\
+
+#ifndef CLIONPROJECTS_QUAT_CODEC_H
+#define CLIONPROJECTS_QUAT_CODEC_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include "libraries/glm-master/glm/ext.hpp"
+#include "quat_batch.h"
+#include <cstddef>
+#include <cstdint>
+
+// Unit quaternions packed "smallest three": the component of largest magnitude is dropped and
+// recomputed on decoding as sqrt(1 - a^2 - b^2 - c^2) from the other three, the quaternion being
+// negated first if need be to make it positive (q and -q are the same rotation). The other three
+// then lie in [-1/sqrt(2), 1/sqrt(2)] and are quantised uniformly over that range. Decoded
+// quaternions are unit length to float rounding, but may be the negation of what was encoded.
+//
+//   PackedQuat32: the dropped component's index (w, x, y, z = 0 to 3) in the top 2 bits, then the
+//                 other three in order in 10 bits each. A quarter of a glm::fquat.
+//   PackedQuat48: three 16-bit words, each holding one of the three in its low 15 bits, with the
+//                 index's low bit in the top bit of the first word and its high bit in the second.
+//
+// Encoding normalises its input first.
+using PackedQuat32 = std::uint32_t;
+
+struct PackedQuat48 {
+    std::uint16_t words[3];
+};
+
+[[nodiscard]] PackedQuat32 encodeQuat32(const glm::fquat& quat);
+[[nodiscard]] glm::fquat decodeQuat32(PackedQuat32 packed);
+[[nodiscard]] PackedQuat48 encodeQuat48(const glm::fquat& quat);
+[[nodiscard]] glm::fquat decodeQuat48(const PackedQuat48& packed);
+
+// Decode count packed quaternions into out, resized to count. Like the quat_batch kernels these
+// run a SIMD register of quaternions at a time, with selects in place of the branch on which
+// component was dropped, and give bit for bit the same results as the single decoders.
+void batchDecodeQuat32(const PackedQuat32* packed, size_t count, QuatArray& out);
+void batchDecodeQuat48(const PackedQuat48* packed, size_t count, QuatArray& out);
+
+// Largest rotation, in radians, between a unit quaternion and its decoded encoding: rounding
+// moves each stored component by up to half a quantisation step e, and so the recomputed one by
+// up to 3e, giving at most 2 sqrt(12) e (0.28 degrees at 32 bits, 0.009 at 48). Also the largest
+// distance from 1 of a decoded quaternion's length. quat_benchmark --check verifies all three.
+constexpr float g_fQuat32MaxAngularError = 4.8e-3f;
+constexpr float g_fQuat48MaxAngularError = 1.5e-4f;
+constexpr float g_fPackedQuatMaxLengthError = 1.0e-6f;
+
+#endif // CLIONPROJECTS_QUAT_CODEC_H
@@ -0,0 +1,133 @@
+// --- Window/headless render backend switch --- \\
+
+#include "render_backend.h"
+#include "launch_options.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+RenderBackend::RenderBackend(const LaunchOptions& options)
+        : m_type(options.backend), m_width(options.iFramebufferWidth), m_height(options.iFramebufferHeight),
+          m_frameLimit(options.iFrameLimit), m_screenshotPath(options.screenshotPath) {
+#ifdef GL_NULL_DISPATCH
+    nullgl::SetRecording(options.bRecordGLCommands);
+#endif
+}
+
+RenderBackend::~RenderBackend() {
+    if (m_framebuffer != 0) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteRenderbuffers(1, &m_colourRenderbuffer);
+        glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+    }
+}
+
+void RenderBackend::SetInitHints() const {
+    if (IsHeadless())
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+}
+
+void RenderBackend::SetWindowHints() const {
+    if (!IsHeadless())
+        return;
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (m_type == Type::HEADLESS_NULL)
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    else
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                       m_type == Type::HEADLESS_EGL ? GLFW_EGL_CONTEXT_API : GLFW_OSMESA_CONTEXT_API);
+}
+
+void RenderBackend::Create(GLFWwindow* window) {
+    if (!IsHeadless())
+        return;
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    glGenRenderbuffers(1, &m_colourRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colourRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colourRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("Offscreen framebuffer is incomplete");
+        Logger::Get().Flush();
+        exit(EXIT_FAILURE);
+    }
+}
+
+void RenderBackend::BeginFrame() {
+#ifdef GL_NULL_DISPATCH
+    // Leave the set-up calls out of the per-frame figures.
+    if (m_frameCount == 0)
+        nullgl::ResetStats();
+    nullgl::BeginFrame();
+    m_frameStartTime = std::chrono::steady_clock::now();
+#endif
+
+    // Bound every frame, since passes such as the impostor bake restore framebuffer 0.
+    if (m_framebuffer != 0)
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+void RenderBackend::PresentFrame(GLFWwindow* window) {
+#ifdef GL_NULL_DISPATCH
+    m_submissionTime += std::chrono::steady_clock::now() - m_frameStartTime;
+#endif
+
+    m_frameCount++;
+    bool bLastFrame = m_frameLimit > 0 && m_frameCount >= m_frameLimit;
+
+    // Read the frame back before the swap leaves the back buffer undefined.
+    if (bLastFrame && !m_screenshotPath.empty()) {
+        if (!WriteScreenshot(window, m_screenshotPath))
+            LOG_ERROR("Failed to write screenshot: {}", m_screenshotPath);
+    }
+
+    if (IsHeadless())
+        glFlush();
+    else
+        glfwSwapBuffers(window);
+
+    if (bLastFrame) {
+#ifdef GL_NULL_DISPATCH
+        // A report asked for, so straight to stdout, after whatever was logged before it
+        Logger::Get().Flush();
+        nullgl::PrintReport(std::cout, m_frameCount, m_submissionTime);
+#endif
+        glfwSetWindowShouldClose(window, true);
+    }
+}
+
+bool RenderBackend::WriteScreenshot(GLFWwindow* window, const std::string& path) const {
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    // OpenGL rows run bottom to top, PPM rows top to bottom.
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int iRow = height - 1; iRow >= 0; iRow--)
+        std::fwrite(pixels.data() + static_cast<size_t>(iRow) * width * 3, 1, static_cast<size_t>(width) * 3, file);
+
+    return std::fclose(file) == 0;
+}
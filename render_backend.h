@@ -0,0 +1,75 @@
+// --- Declares the window/headless render backend switch --- \\
+
+#ifndef CLIONPROJECTS_RENDER_BACKEND_H
+#define CLIONPROJECTS_RENDER_BACKEND_H
+#include "gl_dispatch.h"
+#include "libraries/glfw-master/include/GLFW/glfw3.h"
+#include <chrono>
+#include <string>
+
+struct LaunchOptions;
+
+// Chooses where frames go. WINDOW is the usual visible GLFW window. The headless backends use
+// GLFW's null platform, so the programs keep their window, input and timer code, with the
+// context created through EGL (e.g. surfaceless Mesa llvmpipe) or OSMesa instead of a display
+// server. Headless frames are drawn into an offscreen framebuffer of the requested size.
+//
+// In GL_NULL_DISPATCH builds the time between BeginFrame and PresentFrame is accumulated and
+// reported with the null dispatch's call statistics at the end of a frame-limited run.
+//
+// With a frame limit the window closes itself after that many frames, optionally writing the
+// last one to a binary PPM file first; this works with any backend.
+class RenderBackend {
+public:
+    enum class Type {
+        WINDOW,
+        HEADLESS_EGL,
+        HEADLESS_OSMESA,
+        // No context at all; for builds with GL_NULL_DISPATCH
+        HEADLESS_NULL
+    };
+
+    explicit RenderBackend(const LaunchOptions& options);
+    ~RenderBackend();
+
+    RenderBackend(const RenderBackend&) = delete;
+    RenderBackend& operator=(const RenderBackend&) = delete;
+
+    [[nodiscard]] Type GetType() const {return m_type;}
+    [[nodiscard]] bool IsHeadless() const {return m_type != Type::WINDOW;}
+    // Requested framebuffer size, or the program's default when none was given.
+    [[nodiscard]] int GetWidth(int defaultWidth) const {return m_width > 0 ? m_width : defaultWidth;}
+    [[nodiscard]] int GetHeight(int defaultHeight) const {return m_height > 0 ? m_height : defaultHeight;}
+
+    // Call right before glfwInit and glfwCreateWindow respectively.
+    void SetInitHints() const;
+    void SetWindowHints() const;
+
+    // Creates the offscreen framebuffer when headless; needs the GL functions to be loaded.
+    void Create(GLFWwindow* window);
+
+    // Redirects drawing into the offscreen framebuffer when headless.
+    void BeginFrame();
+    // Stands in for glfwSwapBuffers, and closes the window once the frame limit is reached.
+    void PresentFrame(GLFWwindow* window);
+
+    // Writes what has been drawn to the current frame to a binary PPM file.
+    bool WriteScreenshot(GLFWwindow* window, const std::string& path) const;
+
+private:
+    Type m_type;
+    int m_width;
+    int m_height;
+    int m_frameLimit;
+    int m_frameCount = 0;
+    std::string m_screenshotPath;
+
+    GLuint m_framebuffer = 0;
+    GLuint m_colourRenderbuffer = 0;
+    GLuint m_depthRenderbuffer = 0;
+
+    std::chrono::steady_clock::time_point m_frameStartTime;
+    std::chrono::nanoseconds m_submissionTime{0};
+};
+
+#endif // CLIONPROJECTS_RENDER_BACKEND_H
@@ -0,0 +1,159 @@
+// --- Per-frame rendering statistics --- \\
+
+#include "render_stats.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+RenderStats g_renderStats;
+
+namespace {
+    double MillisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    bool EndsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+RenderStats::RenderStats(int historySize) : m_historySize(static_cast<size_t>(std::max(historySize, 1))) {}
+
+void RenderStats::BeginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    m_current = FrameStats();
+    m_current.frameIndex = m_frameCount;
+    if (m_frameCount > 0)
+        m_current.frameIntervalMs = MillisecondsBetween(m_previousFrameStart, now);
+    m_previousFrameStart = now;
+    m_frameStart = now;
+    m_bInFrame = true;
+}
+
+void RenderStats::EndFrame() {
+    if (!m_bInFrame)
+        return;
+    m_bInFrame = false;
+    m_current.cpuFrameMs = MillisecondsBetween(m_frameStart, std::chrono::steady_clock::now());
+    m_lastFrame = m_current;
+    m_frameCount++;
+
+    if (m_history.size() < m_historySize) {
+        m_history.push_back(m_current);
+    }
+    else {
+        m_history[m_ixNext] = m_current;
+        m_ixNext = (m_ixNext + 1) % m_historySize;
+    }
+}
+
+FrameStats RenderStats::GetAverage() const {
+    FrameStats average;
+    if (m_history.empty())
+        return average;
+
+    double intervalMs = 0.0;
+    size_t intervalCount = 0;
+    for (const FrameStats& frame : m_history) {
+        average.drawCalls += frame.drawCalls;
+        average.triangles += frame.triangles;
+        average.vertices += frame.vertices;
+        average.uniformUploads += frame.uniformUploads;
+        average.bufferBytesUploaded += frame.bufferBytesUploaded;
+        average.stateChanges += frame.stateChanges;
+        average.programBinds += frame.programBinds;
+        average.cpuFrameMs += frame.cpuFrameMs;
+        if (frame.frameIndex > 0) {
+            intervalMs += frame.frameIntervalMs;
+            intervalCount++;
+        }
+    }
+
+    const std::uint64_t frameCount = m_history.size();
+    average.drawCalls /= frameCount;
+    average.triangles /= frameCount;
+    average.vertices /= frameCount;
+    average.uniformUploads /= frameCount;
+    average.bufferBytesUploaded /= frameCount;
+    average.stateChanges /= frameCount;
+    average.programBinds /= frameCount;
+    average.cpuFrameMs /= static_cast<double>(frameCount);
+    average.frameIntervalMs = intervalCount > 0 ? intervalMs / static_cast<double>(intervalCount) : 0.0;
+    return average;
+}
+
+void RenderStats::PrintSnapshot(std::ostream& out) const {
+    if (m_frameCount == 0) {
+        out << "Render stats: no frames rendered yet\n";
+        return;
+    }
+
+    FrameStats average = GetAverage();
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    auto printRow = [&out](const char* label, const FrameStats& frame) {
+        out << std::left << std::setw(14) << label << std::right
+            << std::setw(8) << frame.drawCalls
+            << std::setw(12) << frame.triangles
+            << std::setw(12) << frame.vertices
+            << std::setw(10) << frame.uniformUploads
+            << std::setw(12) << frame.bufferBytesUploaded
+            << std::setw(8) << frame.stateChanges
+            << std::setw(10) << frame.programBinds
+            << std::fixed << std::setprecision(3)
+            << std::setw(10) << frame.cpuFrameMs
+            << std::setw(12) << frame.frameIntervalMs << "\n";
+    };
+
+    out << "Render stats (frame " << m_lastFrame.frameIndex << ", average over " << m_history.size()
+        << " frames)\n";
+    out << std::left << std::setw(14) << "" << std::right
+        << std::setw(8) << "draws" << std::setw(12) << "triangles" << std::setw(12) << "vertices"
+        << std::setw(10) << "uniforms" << std::setw(12) << "buf bytes" << std::setw(8) << "state"
+        << std::setw(10) << "programs" << std::setw(10) << "cpu ms" << std::setw(12) << "interval ms" << "\n";
+    printRow("last frame", m_lastFrame);
+    printRow("average", average);
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool RenderStats::WriteFile(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR("Failed to write render stats: {}", path);
+        return false;
+    }
+
+    const bool bJson = EndsWith(path, ".json");
+    if (bJson)
+        std::fputs("{\"frames\": [\n", file);
+    else
+        std::fputs("frame,draw_calls,triangles,vertices,uniform_uploads,buffer_bytes,state_changes,"
+                   "program_binds,cpu_frame_ms,frame_interval_ms\n", file);
+
+    // The history is a ring once full; write it oldest first.
+    for (size_t ixFrame = 0; ixFrame < m_history.size(); ixFrame++) {
+        const FrameStats& frame = m_history[(m_ixNext + ixFrame) % m_history.size()];
+        const unsigned long long counters[] = {frame.frameIndex, frame.drawCalls, frame.triangles, frame.vertices,
+                                               frame.uniformUploads, frame.bufferBytesUploaded,
+                                               frame.stateChanges, frame.programBinds};
+        if (bJson)
+            std::fprintf(file, "%s{\"frame\": %llu, \"drawCalls\": %llu, \"triangles\": %llu, \"vertices\": %llu, "
+                               "\"uniformUploads\": %llu, \"bufferBytes\": %llu, \"stateChanges\": %llu, "
+                               "\"programBinds\": %llu, \"cpuFrameMs\": %.4f, \"frameIntervalMs\": %.4f}",
+                         ixFrame > 0 ? ",\n" : "", counters[0], counters[1], counters[2], counters[3], counters[4],
+                         counters[5], counters[6], counters[7], frame.cpuFrameMs, frame.frameIntervalMs);
+        else
+            std::fprintf(file, "%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.4f,%.4f\n", counters[0], counters[1],
+                         counters[2], counters[3], counters[4], counters[5], counters[6], counters[7],
+                         frame.cpuFrameMs, frame.frameIntervalMs);
+    }
+
+    if (bJson)
+        std::fputs("\n]}\n", file);
+    std::fclose(file);
+    LOG_INFO("Wrote {} frames of render stats to {}", m_history.size(), path);
+    return true;
+}
@@ -0,0 +1,87 @@
+// --- Declares the per-frame rendering statistics --- \\
+
+#ifndef CLIONPROJECTS_RENDER_STATS_H
+#define CLIONPROJECTS_RENDER_STATS_H
+#include "gl_dispatch.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// What one frame submitted, as reported by the draw helpers, plus how long it took on the CPU.
+struct FrameStats {
+    std::uint64_t frameIndex = 0;
+    std::uint64_t drawCalls = 0;
+    std::uint64_t triangles = 0;
+    std::uint64_t vertices = 0;
+    std::uint64_t uniformUploads = 0;
+    std::uint64_t bufferBytesUploaded = 0;
+    // Fixed-function state, vertex array, buffer and texture binds; program binds are counted apart.
+    std::uint64_t stateChanges = 0;
+    std::uint64_t programBinds = 0;
+    // BeginFrame to EndFrame, and BeginFrame to the previous BeginFrame (0 for the first frame).
+    double cpuFrameMs = 0.0;
+    double frameIntervalMs = 0.0;
+};
+
+// Counters the draw helpers bump as they submit work. Counts made outside BeginFrame/EndFrame
+// (start-up uploads, the impostor bake) are discarded by the next BeginFrame. Finished frames are
+// kept, up to historySize of them, for the console snapshot and the per-run file.
+class RenderStats {
+public:
+    explicit RenderStats(int historySize = 100000);
+
+    void BeginFrame();
+    void EndFrame();
+
+    // instanceCount multiplies the vertices and triangles; points and lines add no triangles.
+    void CountDraw(GLenum mode, GLsizei vertexCount, GLsizei instanceCount = 1) {
+        std::uint64_t vertices = static_cast<std::uint64_t>(vertexCount) * instanceCount;
+        m_current.drawCalls++;
+        m_current.vertices += vertices;
+        m_current.triangles += TrianglesPerInstance(mode, vertexCount) * instanceCount;
+    }
+    void CountUniformUpload(int count = 1) {m_current.uniformUploads += count;}
+    void CountBufferUpload(std::uint64_t bytes) {m_current.bufferBytesUploaded += bytes;}
+    void CountStateChange(int count = 1) {m_current.stateChanges += count;}
+    void CountProgramBind() {m_current.programBinds++;}
+
+    [[nodiscard]] const FrameStats& GetLastFrame() const {return m_lastFrame;}
+
+    // Last frame and the average over the kept history.
+    void PrintSnapshot(std::ostream& out) const;
+    // One row per kept frame: JSON when path ends in ".json", otherwise CSV. Returns false on failure.
+    bool WriteFile(const std::string& path) const;
+
+private:
+    static std::uint64_t TrianglesPerInstance(GLenum mode, GLsizei vertexCount) {
+        switch (mode) {
+            case GL_TRIANGLES:
+                return vertexCount / 3;
+            case GL_TRIANGLE_STRIP:
+            case GL_TRIANGLE_FAN:
+                return vertexCount > 2 ? vertexCount - 2 : 0;
+            default:
+                return 0;
+        }
+    }
+
+    [[nodiscard]] FrameStats GetAverage() const;
+
+    size_t m_historySize;
+    std::vector<FrameStats> m_history;
+    size_t m_ixNext = 0;
+    std::uint64_t m_frameCount = 0;
+
+    FrameStats m_current;
+    FrameStats m_lastFrame;
+    bool m_bInFrame = false;
+    std::chrono::steady_clock::time_point m_frameStart;
+    std::chrono::steady_clock::time_point m_previousFrameStart;
+};
+
+// Shared by the renderer and the helper modules (the impostor atlas) that submit draws of their own.
+extern RenderStats g_renderStats;
+
+#endif // CLIONPROJECTS_RENDER_STATS_H
@@ -0,0 +1,84 @@
+// --- Procedural stress-scene generator --- \\
+
+#include "scene_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    // Clearance between a building's footprint and the edge of its cell; also keeps trees
+    // (radius 1.5) off the footprint without having to look at neighbouring cells.
+    const float g_fBuildingMargin = 2.0f;
+    const float g_fTreeRadius = 1.5f;
+}
+
+float SceneGenerator::Uniform(float fMin, float fMax) {
+    // The top 24 bits fill a float mantissa exactly.
+    float fUnit = static_cast<float>(m_rng() >> 8) * (1.0f / 16777216.0f);
+    return fMin + (fMax - fMin) * fUnit;
+}
+
+int SceneGenerator::UniformInt(int count) {
+    return static_cast<int>((static_cast<std::uint64_t>(m_rng()) * static_cast<std::uint64_t>(count)) >> 32);
+}
+
+SceneGenerator::Scene SceneGenerator::Generate(int treeCount, int buildingCount, float fTreeDensity,
+                                               const glm::vec2& buildingFootprint, float fMinTerrainSize) {
+    Scene scene;
+    treeCount = std::max(treeCount, 0);
+    buildingCount = std::max(buildingCount, 0);
+    fTreeDensity = std::max(fTreeDensity, 1e-6f);
+
+    const int iBuildingColumns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(buildingCount))));
+    const float fMinCellSize = 2.0f * std::max(buildingFootprint.x, buildingFootprint.y) + 2.0f * g_fBuildingMargin;
+    const float fTreeArea = static_cast<float>(treeCount) / fTreeDensity;
+    const float fBuildingArea = static_cast<float>(buildingCount) * buildingFootprint.x * buildingFootprint.y;
+    scene.fTerrainSize = std::max({fMinTerrainSize, std::sqrt(fTreeArea + fBuildingArea),
+                                   static_cast<float>(iBuildingColumns) * fMinCellSize});
+    const float fHalfSize = scene.fTerrainSize / 2.0f;
+
+    // Pick which grid cells get a building, so a non-square count does not leave a bare strip.
+    std::vector<int> cellBuildings;
+    float fCellSize = 0.0f;
+    if (buildingCount > 0) {
+        fCellSize = scene.fTerrainSize / static_cast<float>(iBuildingColumns);
+        std::vector<int> cells(static_cast<size_t>(iBuildingColumns) * iBuildingColumns);
+        std::iota(cells.begin(), cells.end(), 0);
+        for (int ix = 0; ix < buildingCount; ix++)
+            std::swap(cells[ix], cells[ix + UniformInt(static_cast<int>(cells.size()) - ix)]);
+
+        cellBuildings.assign(cells.size(), -1);
+        scene.buildings.reserve(buildingCount);
+        const glm::vec2 halfFootprint(buildingFootprint.x / 2.0f + g_fBuildingMargin,
+                                        buildingFootprint.y / 2.0f + g_fBuildingMargin);
+        for (int ix = 0; ix < buildingCount; ix++) {
+            const int ixCell = cells[ix];
+            const float fCellX = -fHalfSize + static_cast<float>(ixCell % iBuildingColumns) * fCellSize;
+            const float fCellZ = -fHalfSize + static_cast<float>(ixCell / iBuildingColumns) * fCellSize;
+            cellBuildings[ixCell] = ix;
+            scene.buildings.emplace_back(Uniform(fCellX + halfFootprint.x, fCellX + fCellSize - halfFootprint.x), 0.0f,
+                                         Uniform(fCellZ + halfFootprint.y, fCellZ + fCellSize - halfFootprint.y));
+        }
+    }
+
+    // Buildings cover at most a quarter of their cells, so the rejection loop always finishes quickly.
+    scene.trees.reserve(treeCount);
+    const glm::vec2 keepOut(buildingFootprint.x / 2.0f + g_fTreeRadius, buildingFootprint.y / 2.0f + g_fTreeRadius);
+    while (static_cast<int>(scene.trees.size()) < treeCount) {
+        float fX = Uniform(-fHalfSize + g_fTreeRadius, fHalfSize - g_fTreeRadius);
+        float fZ = Uniform(-fHalfSize + g_fTreeRadius, fHalfSize - g_fTreeRadius);
+        float fTrunkHeight = static_cast<float>(1 + UniformInt(3));
+        float fConeHeight = static_cast<float>(2 + UniformInt(4));
+
+        if (buildingCount > 0) {
+            int iColumn = std::min(static_cast<int>((fX + fHalfSize) / fCellSize), iBuildingColumns - 1);
+            int iRow = std::min(static_cast<int>((fZ + fHalfSize) / fCellSize), iBuildingColumns - 1);
+            int ixBuilding = cellBuildings[static_cast<size_t>(iRow) * iBuildingColumns + iColumn];
+            if (ixBuilding >= 0 && std::abs(fX - scene.buildings[ixBuilding].x) < keepOut.x &&
+                std::abs(fZ - scene.buildings[ixBuilding].z) < keepOut.y)
+                continue;
+        }
+        scene.trees.push_back({fX, fZ, fTrunkHeight, fConeHeight});
+    }
+    return scene;
+}
@@ -0,0 +1,49 @@
+// --- Declares the procedural stress-scene generator --- \\
+
+#ifndef CLIONPROJECTS_SCENE_GENERATOR_H
+#define CLIONPROJECTS_SCENE_GENERATOR_H
+#include "libraries/glm-master/glm/glm.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Scatters trees and buildings over a square terrain centred on the origin, for scaling
+// benchmarks of the forest scene. The same seed always gives the same scene, on any platform:
+// numbers are drawn straight from std::mt19937, whose output the standard fixes, rather than
+// through the standard distributions, whose algorithms it leaves to the library.
+//
+// Buildings are spread one per cell of a square grid, jittered within their cell; trees are
+// scattered uniformly at fTreeDensity trees per square unit and kept off the building footprints.
+// The terrain grows with whichever of the two needs more room, and is never smaller than
+// fMinTerrainSize.
+class SceneGenerator {
+public:
+    struct Tree {
+        float fXPos;
+        float fZPos;
+        float fTrunkHeight;
+        float fConeHeight;
+    };
+
+    struct Scene {
+        std::vector<Tree> trees;
+        // Building origins; each has a footprint of buildingFootprint centred on it in X/Z.
+        std::vector<glm::vec3> buildings;
+        float fTerrainSize = 0.0f;
+    };
+
+    explicit SceneGenerator(std::uint32_t seed = 1) : m_rng(seed) {}
+
+    [[nodiscard]] Scene Generate(int treeCount, int buildingCount, float fTreeDensity, const glm::vec2& buildingFootprint,
+                                 float fMinTerrainSize = 100.0f);
+
+private:
+    // Uniform in [min, max).
+    float Uniform(float fMin, float fMax);
+    // Uniform in [0, count).
+    int UniformInt(int count);
+
+    std::mt19937 m_rng;
+};
+
+#endif // CLIONPROJECTS_SCENE_GENERATOR_H
@@ -0,0 +1,165 @@
+// --- Declares the SIMD lane traits shared by the batched quaternion kernels --- \\
+
+#ifndef CLIONPROJECTS_SIMD_LANES_H
+#define CLIONPROJECTS_SIMD_LANES_H
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// A kernel is written once as a template over one of these and runs a register of lanes at a
+// time: SimdLanes is the widest the compiler may use (AVX2 when built with -mavx2, SSE on x86,
+// otherwise plain scalar code), ScalarLanes a single lane. Int holds 32-bit unsigned integers and
+// a Mask is a float-typed all-ones or all-zeros per lane.
+
+// For helpers that several kernels build on: once a helper has more than one caller the compiler
+// may stop inlining it, and a call passes its registers through memory.
+#if defined(_MSC_VER)
+#define SIMD_INLINE __forceinline
+#else
+#define SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+// One lane. Also finishes off the elements after the last full SIMD register, so every element
+// gets exactly the same arithmetic.
+struct ScalarLanes {
+    using Type = float;
+    using Mask = bool;
+    using Int = std::uint32_t;
+    static constexpr size_t g_iWidth = 1;
+
+    static Type Load(const float* p) {return *p;}
+    static void Store(float* p, Type v) {*p = v;}
+    static Type Set(float f) {return f;}
+    static Type Add(Type a, Type b) {return a + b;}
+    static Type Sub(Type a, Type b) {return a - b;}
+    static Type Mul(Type a, Type b) {return a * b;}
+#if defined(__AVX2__) && defined(__FMA__)
+    // Fused, as SimdLanes' is
+    static Type MulAdd(Type a, Type b, Type c) {return std::fma(a, b, c);}
+#else
+    static Type MulAdd(Type a, Type b, Type c) {return a * b + c;}
+#endif
+    static Type Div(Type a, Type b) {return a / b;}
+    static Type Sqrt(Type a) {return std::sqrt(a);}
+    static Type Min(Type a, Type b) {return a < b ? a : b;}
+    static Type Max(Type a, Type b) {return a > b ? a : b;}
+    static Type SignBit(Type a) {return std::bit_cast<float>(std::bit_cast<std::uint32_t>(a) & 0x80000000u);}
+    static Type Xor(Type a, Type b) {
+        return std::bit_cast<float>(std::bit_cast<std::uint32_t>(a) ^ std::bit_cast<std::uint32_t>(b));
+    }
+    static Mask Greater(Type a, Type b) {return a > b;}
+    static Type Select(Mask mask, Type a, Type b) {return mask ? a : b;}
+
+    static Int LoadInt(const std::uint32_t* p) {return *p;}
+    // The 4 bytes at p, p + stride, p + 2 stride, ... one per lane, unaligned
+    static Int GatherInt(const unsigned char* p, size_t) {
+        Int value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    template <int BITS>
+    static Int ShiftRight(Int a) {return a >> BITS;}
+    static Int And(Int a, std::uint32_t mask) {return a & mask;}
+    static Int Or(Int a, Int b) {return a | b;}
+    static Type ToFloat(Int a) {return static_cast<float>(a);}
+    static Mask Equal(Int a, std::uint32_t b) {return a == b;}
+};
+
+#if defined(__AVX2__)
+struct SimdLanes {
+    using Type = __m256;
+    using Mask = __m256;
+    using Int = __m256i;
+    static constexpr size_t g_iWidth = 8;
+
+    static Type Load(const float* p) {return _mm256_loadu_ps(p);}
+    static void Store(float* p, Type v) {_mm256_storeu_ps(p, v);}
+    static Type Set(float f) {return _mm256_set1_ps(f);}
+    static Type Add(Type a, Type b) {return _mm256_add_ps(a, b);}
+    static Type Sub(Type a, Type b) {return _mm256_sub_ps(a, b);}
+    static Type Mul(Type a, Type b) {return _mm256_mul_ps(a, b);}
+#if defined(__FMA__)
+    static Type MulAdd(Type a, Type b, Type c) {return _mm256_fmadd_ps(a, b, c);}
+#else
+    static Type MulAdd(Type a, Type b, Type c) {return _mm256_add_ps(_mm256_mul_ps(a, b), c);}
+#endif
+    static Type Div(Type a, Type b) {return _mm256_div_ps(a, b);}
+    static Type Sqrt(Type a) {return _mm256_sqrt_ps(a);}
+    static Type Min(Type a, Type b) {return _mm256_min_ps(a, b);}
+    static Type Max(Type a, Type b) {return _mm256_max_ps(a, b);}
+    static Type SignBit(Type a) {return _mm256_and_ps(a, _mm256_set1_ps(-0.0f));}
+    static Type Xor(Type a, Type b) {return _mm256_xor_ps(a, b);}
+    static Mask Greater(Type a, Type b) {return _mm256_cmp_ps(a, b, _CMP_GT_OQ);}
+    static Type Select(Mask mask, Type a, Type b) {return _mm256_blendv_ps(b, a, mask);}
+
+    static Int LoadInt(const std::uint32_t* p) {return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));}
+    static Int GatherInt(const unsigned char* p, size_t stride) {
+        const int iStride = static_cast<int>(stride);
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(iStride));
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(p), offsets, 1);
+    }
+    template <int BITS>
+    static Int ShiftRight(Int a) {return _mm256_srli_epi32(a, BITS);}
+    static Int And(Int a, std::uint32_t mask) {return _mm256_and_si256(a, _mm256_set1_epi32(static_cast<int>(mask)));}
+    static Int Or(Int a, Int b) {return _mm256_or_si256(a, b);}
+    // Exact for values below 2^31, which is all the kernels convert
+    static Type ToFloat(Int a) {return _mm256_cvtepi32_ps(a);}
+    static Mask Equal(Int a, std::uint32_t b) {
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(static_cast<int>(b))));
+    }
+};
+inline const char* const g_simdInstructionSet = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdLanes {
+    using Type = __m128;
+    using Mask = __m128;
+    using Int = __m128i;
+    static constexpr size_t g_iWidth = 4;
+
+    static Type Load(const float* p) {return _mm_loadu_ps(p);}
+    static void Store(float* p, Type v) {_mm_storeu_ps(p, v);}
+    static Type Set(float f) {return _mm_set1_ps(f);}
+    static Type Add(Type a, Type b) {return _mm_add_ps(a, b);}
+    static Type Sub(Type a, Type b) {return _mm_sub_ps(a, b);}
+    static Type Mul(Type a, Type b) {return _mm_mul_ps(a, b);}
+    static Type MulAdd(Type a, Type b, Type c) {return _mm_add_ps(_mm_mul_ps(a, b), c);}
+    static Type Div(Type a, Type b) {return _mm_div_ps(a, b);}
+    static Type Sqrt(Type a) {return _mm_sqrt_ps(a);}
+    static Type Min(Type a, Type b) {return _mm_min_ps(a, b);}
+    static Type Max(Type a, Type b) {return _mm_max_ps(a, b);}
+    static Type SignBit(Type a) {return _mm_and_ps(a, _mm_set1_ps(-0.0f));}
+    static Type Xor(Type a, Type b) {return _mm_xor_ps(a, b);}
+    static Mask Greater(Type a, Type b) {return _mm_cmpgt_ps(a, b);}
+    // SSE2 has no blend
+    static Type Select(Mask mask, Type a, Type b) {return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));}
+
+    static Int LoadInt(const std::uint32_t* p) {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));}
+    // SSE2 has no gather either
+    static Int GatherInt(const unsigned char* p, size_t stride) {
+        std::uint32_t values[4];
+        for (size_t ixLane = 0; ixLane < 4; ixLane++)
+            std::memcpy(&values[ixLane], p + ixLane * stride, sizeof(values[ixLane]));
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    }
+    template <int BITS>
+    static Int ShiftRight(Int a) {return _mm_srli_epi32(a, BITS);}
+    static Int And(Int a, std::uint32_t mask) {return _mm_and_si128(a, _mm_set1_epi32(static_cast<int>(mask)));}
+    static Int Or(Int a, Int b) {return _mm_or_si128(a, b);}
+    // Exact for values below 2^31, which is all the kernels convert
+    static Type ToFloat(Int a) {return _mm_cvtepi32_ps(a);}
+    static Mask Equal(Int a, std::uint32_t b) {
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_set1_epi32(static_cast<int>(b))));
+    }
+};
+inline const char* const g_simdInstructionSet = "SSE";
+#else
+using SimdLanes = ScalarLanes;
+inline const char* const g_simdInstructionSet = "scalar";
+#endif
+
+#endif // CLIONPROJECTS_SIMD_LANES_H
@@ -2,33 +2,44 @@
 // Created by jorda on 13/02/2024.
 //
 
-#include <iostream>
 #include <sstream>
 #include "libraries/rapidxml-master/rapidxml.hpp"
 #include "libraries/rapidxml-master/rapidxml_utils.hpp"
 #include "xmlparser.h"
+#include "profiler.h"
+#include "logger.h"
 #include <vector>
 #include <cstring>
 
-std::vector<float> parseMeshXMLVertexData(const char* xmlFilePath) {
-    rapidxml::file<> xmlFile(xmlFilePath);
-    if (!xmlFile.data()) {
-        std::cerr << "Failed to open XML file." << std::endl;
+namespace {
+    // The mesh's vertex attribute node, followed by its colour attribute node, or nullptr (with the
+    // error logged) if the document has no such pair
+    rapidxml::xml_node<>* findVertexAttribute(const rapidxml::xml_document<>& doc, const char* xmlFilePath) {
+        rapidxml::xml_node<>* meshNode = doc.first_node();
+        rapidxml::xml_node<>* vertexAttributeNode = meshNode ? meshNode->first_node("attribute") : nullptr;
+        if (!vertexAttributeNode || !vertexAttributeNode->next_sibling("attribute")) {
+            LOG_ERROR("Attribute node not found: {}", xmlFilePath);
+            return nullptr;
+        }
+        return vertexAttributeNode;
     }
+}
 
-    std::cout << "Parsing XML Mesh Vertex Data..." << "\n";
-    rapidxml::xml_document<> doc;
+// Both parsers log a file that cannot be read or parsed and return no data for it.
+std::vector<float> parseMeshXMLVertexData(const char* xmlFilePath) {
+    PROFILE_FUNCTION();
+    LOG_INFO("Parsing XML Mesh Vertex Data...");
+    std::vector<float> vertexData;
     try {
-        doc.parse<0>(xmlFile.data());;  // Parse the XML data
-    } catch (rapidxml::parse_error &e) {
-        std::cerr << "Parse error: " << e.what() << std::endl;
-    }
+        rapidxml::file<> xmlFile(xmlFilePath);
+        rapidxml::xml_document<> doc;
+        doc.parse<0>(xmlFile.data());  // Parse the XML data
 
-    rapidxml::xml_node<>* vertexAttributeNode = doc.first_node()->first_node("attribute");
-    rapidxml::xml_node<>* colourAttributeNode = vertexAttributeNode->next_sibling("attribute");
-    std::vector<float> vertexData;
+        rapidxml::xml_node<>* vertexAttributeNode = findVertexAttribute(doc, xmlFilePath);
+        if (!vertexAttributeNode)
+            return vertexData;
+        rapidxml::xml_node<>* colourAttributeNode = vertexAttributeNode->next_sibling("attribute");
 
-    if (colourAttributeNode) {
         // Split the content by lines
         std::istringstream iss(vertexAttributeNode->value());
         std::istringstream iss2(colourAttributeNode->value());
@@ -47,8 +58,11 @@ std::vector<float> parseMeshXMLVertexData(const char* xmlFilePath) {
                 vertexData.push_back(floatValue2);
             }
         }
-    } else {
-        std::cerr << "Attribute node not found." << std::endl;
+    } catch (const rapidxml::parse_error& e) {
+        LOG_ERROR("Parse error in {}: {}", xmlFilePath, e.what());
+    } catch (const std::exception& e) {
+        // rapidxml::file throws when the file cannot be read
+        LOG_ERROR("Failed to open XML file {}: {}", xmlFilePath, e.what());
     }
 
     return vertexData;
@@ -57,54 +71,48 @@ std::vector<float> parseMeshXMLVertexData(const char* xmlFilePath) {
 std::tuple<std::vector<std::vector<unsigned int>>,
 std::vector<std::vector<unsigned int>>,
 std::vector<std::vector<unsigned int>>> parseMeshXMLIndexData(const char* xmlFilePath) {
-    rapidxml::file<> xmlFile(xmlFilePath);
-    if (!xmlFile.data()) {
-        std::cerr << "Failed to open XML file." << std::endl;
-    }
-
-    std::cout << "Parsing XML Mesh Index Data..." << "\n";
-    rapidxml::xml_document<> doc;
-    try {
-        doc.parse<0>(xmlFile.data());;  // Parse the XML data
-    } catch (rapidxml::parse_error &e) {
-        std::cerr << "Parse error: " << e.what() << std::endl;
-    }
-
-    rapidxml::xml_node<>* vertexAttributeNode = doc.first_node()->first_node("attribute");
-    rapidxml::xml_node<>* colourAttributeNode = vertexAttributeNode->next_sibling("attribute");
+    PROFILE_FUNCTION();
+    LOG_INFO("Parsing XML Mesh Index Data...");
     std::vector<std::vector<unsigned int>> triStripIndices;
     std::vector<std::vector<unsigned int>> triIndices;
     std::vector<std::vector<unsigned int>> triFanIndices;
-
-    rapidxml::xml_node<>* indicesSibling = colourAttributeNode->next_sibling("indices");
-
-    while (indicesSibling != nullptr) {
-        std::istringstream iss(indicesSibling->value());
-        std::string indicesLine;
-        unsigned int indexValue;
-
-        if (std::strcmp(indicesSibling->first_attribute()->value(), "tri-strip") == 0) {
-            std::vector<unsigned int> triStrip;
-            while (iss >> indexValue) {
-                triStrip.push_back(indexValue);
-            }
-            triStripIndices.push_back(triStrip);
-        }
-        if (std::strcmp(indicesSibling->first_attribute()->value(), "triangles") == 0) {
-            std::vector<unsigned int> triangles;
-            while (iss >> indexValue) {
-                triangles.push_back(indexValue);
+    try {
+        rapidxml::file<> xmlFile(xmlFilePath);
+        rapidxml::xml_document<> doc;
+        doc.parse<0>(xmlFile.data());  // Parse the XML data
+
+        rapidxml::xml_node<>* vertexAttributeNode = findVertexAttribute(doc, xmlFilePath);
+        if (!vertexAttributeNode)
+            return std::make_tuple(triStripIndices, triIndices, triFanIndices);
+        rapidxml::xml_node<>* colourAttributeNode = vertexAttributeNode->next_sibling("attribute");
+
+        for (rapidxml::xml_node<>* indicesSibling = colourAttributeNode->next_sibling("indices");
+             indicesSibling != nullptr; indicesSibling = indicesSibling->next_sibling("indices")) {
+            rapidxml::xml_attribute<>* typeAttribute = indicesSibling->first_attribute();
+            if (!typeAttribute) {
+                LOG_WARN("Skipping indices without a primitive type: {}", xmlFilePath);
+                continue;
             }
-            triIndices.push_back(triangles);
-        }
-        if (std::strcmp(indicesSibling->first_attribute()->value(), "tri-fan") == 0) {
-            std::vector<unsigned int> triFan;
+
+            std::istringstream iss(indicesSibling->value());
+            std::vector<unsigned int> indices;
+            unsigned int indexValue;
             while (iss >> indexValue) {
-                triFan.push_back(indexValue);
+                indices.push_back(indexValue);
             }
-            triFanIndices.push_back(triFan);
+
+            if (std::strcmp(typeAttribute->value(), "tri-strip") == 0)
+                triStripIndices.push_back(indices);
+            else if (std::strcmp(typeAttribute->value(), "triangles") == 0)
+                triIndices.push_back(indices);
+            else if (std::strcmp(typeAttribute->value(), "tri-fan") == 0)
+                triFanIndices.push_back(indices);
         }
-        indicesSibling = indicesSibling->next_sibling("indices");
+    } catch (const rapidxml::parse_error& e) {
+        LOG_ERROR("Parse error in {}: {}", xmlFilePath, e.what());
+    } catch (const std::exception& e) {
+        // rapidxml::file throws when the file cannot be read
+        LOG_ERROR("Failed to open XML file {}: {}", xmlFilePath, e.what());
     }
 
     return std::make_tuple(triStripIndices, triIndices, triFanIndices);
@@ -115,50 +123,25 @@ int main() {
     std::vector<float> vertexData = parseMeshXMLVertexData(R"(C:\Users\jorda\OneDrive - Queen Mary, University of London\Cpp_Projects\OpenGL_Learnings\SmallGimbal.xml)");
     auto indexData = parseMeshXMLIndexData(R"(C:\Users\jorda\OneDrive - Queen Mary, University of London\Cpp_Projects\OpenGL_Learnings\SmallGimbal.xml)");
 
-    std::cout << "VertexData: " << "\n";
-    for (int i{0}; i < vertexData.size(); i++) {
-        if (i % 7 == 0) std::cout << "\n";
-        std::cout << vertexData[i] << " ";
+    LOG_DEBUG("VertexData:");
+    for (size_t i = 0; i < vertexData.size(); i += 7) {
+        std::vector<float> row(vertexData.begin() + i, vertexData.begin() + std::min(i + 7, vertexData.size()));
+        LOG_DEBUG("{}", fmt::format("{}", fmt::join(row, " ")));
     }
 
-    std::cout << "\n\n";
-
     std::vector<std::vector<unsigned int>> triStripIndices;
     std::vector<std::vector<unsigned int>> triIndices;
     std::vector<std::vector<unsigned int>> triFanIndices;
     std::tie(triStripIndices, triIndices, triFanIndices) = indexData;
-    std::cout << "No. of triStripIndices vectors: " << triStripIndices.size() << "\n";
-    std::cout << "No. of triIndices vectors: " << triIndices.size() << "\n";
-    std::cout << "No. of triFanIndices vectors: " << triFanIndices.size() << "\n\n";
-
-    if (!triStripIndices.empty()) {
-        for (std::vector<unsigned int> &vec: triStripIndices) {
-            std::cout << "Tri-strip \n";
-            for (unsigned int val: vec) {
-                std::cout << val << " ";
-            }
-            std::cout << "\n";
-        }
-    }
-
-    if (!triIndices.empty()) {
-        for (std::vector<unsigned int> &vec: triIndices) {
-            std::cout << "Tri \n";
-            for (unsigned int val: vec) {
-                std::cout << val << " ";
-            }
-            std::cout << "\n";
-        }
-    }
-
-    if (!triFanIndices.empty()) {
-        for (std::vector<unsigned int> &vec: triFanIndices) {
-            std::cout << "Tri-fan \n";
-            for (unsigned int val: vec) {
-                std::cout << val << " ";
-            }
-            std::cout << "\n";
-        }
-    }
+    LOG_DEBUG("No. of triStripIndices vectors: {}", triStripIndices.size());
+    LOG_DEBUG("No. of triIndices vectors: {}", triIndices.size());
+    LOG_DEBUG("No. of triFanIndices vectors: {}", triFanIndices.size());
+
+    for (const std::vector<unsigned int>& vec: triStripIndices)
+        LOG_DEBUG("Tri-strip\n{}", fmt::format("{}", fmt::join(vec, " ")));
+    for (const std::vector<unsigned int>& vec: triIndices)
+        LOG_DEBUG("Tri\n{}", fmt::format("{}", fmt::join(vec, " ")));
+    for (const std::vector<unsigned int>& vec: triFanIndices)
+        LOG_DEBUG("Tri-fan\n{}", fmt::format("{}", fmt::join(vec, " ")));
 }
 */
\ No newline at end of file